@@ -154,6 +154,30 @@ module Hokusai
       # value - true to use touch events
       attr_accessor :touch
 
+      # Public: Byte budget for textures cached from drawn images (default 256MB)
+      #         Least recently drawn textures are unloaded once the budget is exceeded
+      #
+      # value - bytes (Integer)
+      attr_accessor :texture_budget
+
+      # Public: Milliseconds per frame spent on GPU uploads (default 4.0)
+      #         Image textures and `Hokusai::Texture`s are uploaded from a queue,
+      #         at least one per frame. Check `ready?` to draw a placeholder meanwhile.
+      #
+      # value - milliseconds (Float)
+      attr_accessor :upload_budget_ms
+
+      # Public: Bytes per frame uploaded to the GPU (default 16MB)
+      #
+      # value - bytes (Integer)
+      attr_accessor :upload_budget_bytes
+
+      # Public: Bytes of released `Hokusai::Texture`s kept for reuse (default 64MB)
+      #         A texture created at the same size as a released one reuses it
+      #
+      # value - bytes (Integer)
+      attr_accessor :render_texture_pool_budget
+
       attr_accessor :window_state_flags,
                   :automation_driver, :background, :after_load_cb,
                   :host, :port, :automated, :on_reload_proc
@@ -176,6 +200,10 @@ module Hokusai
         @on_reload_proc = nil
         @event_waiting = true
         @touch = false
+        @texture_budget = 256 * 1024 * 1024
+        @upload_budget_ms = 4.0
+        @upload_budget_bytes = 16 * 1024 * 1024
+        @render_texture_pool_budget = 64 * 1024 * 1024
         @log = false
       end
 
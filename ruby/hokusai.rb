@@ -9,6 +9,8 @@ require_relative './hokusai/block'
 require_relative './hokusai/commands'
 require_relative './hokusai/registry'
 require_relative './hokusai/event'
+require_relative './hokusai/layer'
+require_relative './hokusai/command_stream'
 require_relative './hokusai/painter'
 require_relative './hokusai/texture_painter'
 require_relative './hokusai/util/selection'
@@ -131,6 +133,13 @@ module Hokusai
     @images ||= ImageRegistry.new
   end
 
+  # Public: Access the shader registry
+  #
+  # Returns a [Hokusai::ShaderRegistry](/api/Hokusai/ShaderRegistry)
+  def self.shaders
+    @shaders ||= ShaderRegistry.new
+  end
+
   # Public: Access the music registry
   # 
   # Returns a [Hokusai::MusicRegistry](/api/Hokusai/MusicRegistry)
@@ -275,9 +284,44 @@ module Hokusai
   # 
   # canvas - a Hokusai::Canvas
   #
+  # While the painter walks the tree, this checks against the scissor it has queued so far,
+  # as the backend only draws the frame once the walk is done.
+  #
   # Returns a boolean
   def self.can_render(canvas)
-    @on_renderable&.call(canvas)
+    return @on_renderable&.call(canvas) unless @walking
+
+    scissor = @walk_scissor
+    return true if scissor.nil?
+
+    canvas.y + canvas.height >= scissor.y && canvas.y <= scissor.y + scissor.height
+  end
+
+  # Internal: Marks the start or end of the painter's walk,
+  # during which Hokusai.can_render follows the scissor commands passed to Hokusai.track_scissor
+  #
+  # walking - boolean
+  #
+  # Returns nothing
+  def self.walking(walking)
+    @walking = walking
+    @walk_scissor = nil
+  end
+
+  # Internal: Follows the scissor regions in (commands), queued in painter's order
+  #
+  # commands - an Array of Commands::Base
+  #
+  # Returns nothing
+  def self.track_scissor(commands)
+    commands.each do |command|
+      case command
+      when Commands::ScissorBegin
+        @walk_scissor = command
+      when Commands::ScissorEnd
+        @walk_scissor = nil
+      end
+    end
   end
 
   # **Backend** Provides set mouse cursor callback
@@ -308,6 +352,71 @@ module Hokusai
     @on_copy&.call(text)
   end
 
+  # **Backend** Provides the texture stats callback
+  def self.on_texture_stats(&block)
+    @on_texture_stats = block
+  end
+
+  # Public: Counters for the GPU texture cache used by image drawing
+  #
+  # Returns a Hash with
+  #   :hits, :misses, :evictions - lookup counters since startup
+  #   :resident_bytes - estimated bytes of texture memory held by the cache
+  #   :budget - the byte budget (see Backend::Config#texture_budget)
+  #   :entries - cached textures
+  #   :atlas_pages - shared atlas pages allocated for small images
+  #   :uploads_queued, :uploads_last_frame - GPU uploads waiting / done last frame
+  #   :upload_bytes_last_frame, :upload_ms_last_frame - what last frame's uploads cost
+  def self.texture_stats
+    @on_texture_stats&.call || {}
+  end
+
+  # **Backend** Provides the shader stats callback
+  def self.on_shader_stats(&block)
+    @on_shader_stats = block
+  end
+
+  # Public: Counters for shader compiles and uniform uploads
+  #
+  # Returns a Hash with
+  #   :compiled, :compile_ms - shaders compiled since startup and the time spent
+  #   :precompiled, :precompile_ms - how many of those were compiled by Hokusai.shaders before they were drawn
+  #   :compiles_last_frame, :compile_ms_last_frame - compiles that happened while drawing last frame
+  #   :uniform_uploads, :uniform_uploads_skipped - uniform values sent / skipped as unchanged
+  def self.shader_stats
+    @on_shader_stats&.call || {}
+  end
+
+  # **Backend** Provides the shader precompile callback
+  def self.on_precompile_shader(&block)
+    @on_precompile_shader = block
+  end
+
+  # Internal: Compiles a shader, used by Hokusai::ShaderRegistry
+  #
+  # Returns true if it compiled
+  def self.precompile_shader(vertex, fragment)
+    @on_precompile_shader&.call(vertex, fragment) || false
+  end
+
+  # **Backend** Provides the layer rendering callback
+  def self.on_render_layer(&block)
+    @on_render_layer = block
+  end
+
+  # Internal: Renders (commands) into (texture) with (x, y) as its origin
+  #           Used by Hokusai::Layer
+  #
+  # texture - a Hokusai::Texture
+  # commands - an Array of Commands::Base
+  # x - x coordinate of the layer (Float)
+  # y - y coordinate of the layer (Float)
+  #
+  # Returns false when nothing was recorded (inside another texture or transform)
+  def self.render_layer(texture, commands, x, y)
+    @on_render_layer.call(texture, commands, x, y)
+  end
+
   # Mobile support
   def self.on_show_keyboard(&block)
     @on_show_keyboard = block
@@ -151,9 +151,56 @@ module Hokusai
       end
     end
 
-    attr_reader :children, :siblings, :classes, :style_list
-    attr_accessor :type, :id, :else_active, :loop, :if, :else_ast, 
-                  :props, :events, :siblingindex
+    attr_writer :type, :id, :loop, :if, :else_ast, :props, :events
+    attr_accessor :else_active, :siblingindex
+
+    # Asts from Ast.parse are backed by the parsed C tree (see `native?`)
+    # and convert each field the first time it is read.
+    # Asts from the NodeBuilder set every field in #initialize.
+
+    def type
+      @type ||= native_type
+    end
+
+    def id
+      @id ||= native_id
+    end
+
+    def children
+      @children ||= native_children
+    end
+
+    def siblings
+      @siblings ||= native_siblings
+    end
+
+    def classes
+      @classes ||= native_classes
+    end
+
+    def style_list
+      @style_list ||= native_style_list
+    end
+
+    def props
+      @props ||= native_props
+    end
+
+    def events
+      @events ||= native_events
+    end
+
+    def loop
+      @loop ||= native_loop
+    end
+
+    def if
+      @if ||= native_if
+    end
+
+    def else_ast
+      @else_ast ||= native_else_ast
+    end
 
     def initialize
       @children = []
@@ -214,6 +214,35 @@ module Hokusai
       @styles || {}
     end
 
+    # Internal: The blocks this block uses, by template name
+    def self.uses_get
+      @uses || {}
+    end
+
+    # Public: Declares a shader this block draws with,
+    #         so it is compiled at startup instead of on the frame the block first appears.
+    #         See [Hokusai::ShaderRegistry](/api/Hokusai/ShaderRegistry)
+    #
+    # kwargs - the shader sources, either may be omitted for raylib's default
+    #             :vertex - vertex shader source (String)
+    #             :fragment - fragment shader source (String)
+    #
+    # Examples
+    #
+    #   shader fragment: HUE_SHADER
+    #
+    # Returns nothing
+    def self.shader(vertex: nil, fragment: nil)
+      pair = [vertex, fragment]
+      # a reloaded class body declares its shaders again
+      shaders << pair unless shaders.include?(pair)
+    end
+
+    # Internal: Shaders declared with Block.shader
+    def self.shaders
+      @shaders ||= []
+    end
+
     # Public: Defines blocks that this block uses in it's template. Must be defined if using a string template.
     #         Keys (Symbol) map to template node names, values map to a [Hokusai::Block](/api/Hokusai/Block).
     #         
@@ -1052,6 +1052,9 @@ class Hokusai::Blocks::ColorPicker < Hokusai::Block
   }
   EOF
 
+  shader fragment: HUE_SHADER
+  shader fragment: PICKER_SHADER
+
   def hue_shader
     HUE_SHADER
   end
@@ -21,7 +21,27 @@ module Hokusai::Blocks
     inject :panel_height
     inject :panel_top
     inject :selection
-  
+
+    SELECTION_SHADER = <<-EOF
+    #version 330
+    in vec4 fragColor;
+    in vec2 fragTexCoord;
+    out vec4 finalColor;
+    uniform sampler2D texture0;
+    uniform vec4 from;
+    uniform vec4 to;
+    uniform float progress;
+
+    void main() {
+      vec4 texelColor = texture(texture0, fragTexCoord) * fragColor;
+
+      finalColor.a = texelColor.a;
+      finalColor.rgb = mix(from, to, progress).rgb;
+    }
+    EOF
+
+    shader fragment: SELECTION_SHADER
+
     attr_accessor :counter, :copying
 
     def initialize(**args)
@@ -63,32 +83,31 @@ module Hokusai::Blocks
       return @cache if counter >= 2 && static
 
       @cache = begin
-        cache = Hokusai::Util::WrapCache.new
-        y = top(canvas)
-
-        stream = Hokusai::Util::WrapStream.new(canvas.width - padding.width, canvas.x, y) do |string, extra|
-          if w = user_font.measure_char(string, size)
-            [w, size]
-          else
-            [user_font.measure(string, size).first, size]
-          end
-        end
+        width = canvas.width - padding.width
+        layout = [user_font, size, width]
 
-        stream.on_text do |wrapped|
-          cache << wrapped
+        if @cache.nil? || @layout != layout || @last_content.nil?
+          cache, y = Hokusai::Util::WrapCache.wrap(user_font, content, size, width, canvas.x, top(canvas))
+          @origin_x = canvas.x
+        else
+          # scrolling moves the text, an edit only rewraps the paragraphs it touched
+          cache = @cache
+          cache.translate(canvas.x - @origin_x, top(canvas) - cache.origin_y)
+          @origin_x = canvas.x
+          y = cache.rewrap(user_font, @last_content, content, size, width, canvas.x)
         end
-        stream.wrap(content, nil)
-        stream.flush
 
-        if (stream.y - canvas.y).zero?
+        @layout = layout
+
+        if (y - canvas.y).zero?
           height = size
         else
-          height = (stream.y - canvas.y - offset + size).ceil
+          height = (y - canvas.y - offset + size).ceil
         end
 
         node.meta.set_prop(:height, height + padding.height)
         emit("height_updated", height + padding.height)
-        @last_content = content
+        @last_content = content.dup
 
         cache
       end
@@ -103,23 +122,7 @@ module Hokusai::Blocks
     end
 
     def fshader
-      <<-EOF
-      #version 330
-      in vec4 fragColor;
-      in vec2 fragTexCoord;
-      out vec4 finalColor;
-      uniform sampler2D texture0;
-      uniform vec4 from;
-      uniform vec4 to;
-      uniform float progress;
-
-      void main() {
-        vec4 texelColor = texture(texture0, fragTexCoord) * fragColor;
-
-        finalColor.a = texelColor.a;
-        finalColor.rgb = mix(from, to, progress).rgb;
-      }
-      EOF
+      SELECTION_SHADER
     end
 
     def render(canvas)
@@ -167,14 +170,12 @@ module Hokusai::Blocks
         end
       end
 
-      tokens.each do |wrapped|
-        # draw text
-        text(wrapped.text, wrapped.x + padding.left, wrapped.y + padding.top - offset || 0.0) do |command|
-          command.color = color
-          command.size = size
-          if font
-            command.font = user_font
-          end
+      # draw every visible line in one command
+      glyph_run(user_font, size) do |run|
+        run.color = color
+
+        tokens.each do |wrapped|
+          run.add(wrapped.text, wrapped.x + padding.left, wrapped.y + padding.top - offset)
         end
       end
 
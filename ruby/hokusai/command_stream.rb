@@ -0,0 +1,199 @@
+module Hokusai
+  # Internal: Tidies a frame's commands before they reach the backend
+  #
+  # Every state command (scissor, blend mode, shader, rotation, scale, translation)
+  # flushes the render batch, and so does every switch between textures.
+  #
+  # * state commands that change nothing are dropped: a begin right before its end,
+  #   or an end right before an identical begin (merging the two regions)
+  # * between state commands, a draw moves back next to an earlier draw on the same
+  #   texture, as long as it doesn't jump over a draw it overlaps
+  class CommandStream
+    # how many batches back a draw may move
+    BATCH_WINDOW = 8
+
+    PAIRS = {
+      Commands::ScissorBegin => Commands::ScissorEnd,
+      Commands::BlendModeBegin => Commands::BlendModeEnd,
+      Commands::ShaderBegin => Commands::ShaderEnd,
+      Commands::RotationBegin => Commands::RotationEnd,
+      Commands::ScaleBegin => Commands::ScaleEnd,
+      Commands::TranslationBegin => Commands::TranslationEnd,
+    }
+
+    ENDS = PAIRS.invert
+
+    # Internal: Optimizes (commands)
+    #
+    # commands - an Array of Commands::Base in painter's order
+    #
+    # Returns a new Array
+    def self.optimize(commands)
+      reorder(eliminate(commands))
+    end
+
+    def self.eliminate(commands)
+      out = []
+      open = []
+      closed = nil
+
+      commands.each do |command|
+        if begin_class = ENDS[command.class]
+          # begin ... end with nothing between
+          if out.last.is_a?(begin_class)
+            out.pop
+            open.pop
+            next
+          end
+
+          closed = open.pop
+          out << command
+        elsif PAIRS[command.class]
+          # end, then the same begin again: keep the first region open
+          if closed && out.last.is_a?(PAIRS[command.class]) && same_state?(closed, command)
+            out.pop
+            open << closed
+            closed = nil
+            next
+          end
+
+          open << command
+          out << command
+        else
+          out << command
+        end
+      end
+
+      out
+    end
+
+    def self.reorder(commands)
+      out = []
+      run = []
+
+      commands.each do |command|
+        if batch_key(command)
+          run << command
+        else
+          reorder_run(run, out)
+          run = []
+          out << command
+        end
+      end
+
+      reorder_run(run, out)
+    end
+
+    def self.reorder_run(run, out)
+      return out.concat(run) if run.size < 3
+
+      # [key, bounds of the whole batch, bounds of each command, commands]
+      batches = []
+
+      run.each do |command|
+        key = batch_key(command)
+        box = bounds(command)
+        target = nil
+
+        if box.nil?
+          target = batches.last if batches.last&.first == key
+        else
+          (batches.size - 1).downto([batches.size - BATCH_WINDOW, 0].max) do |i|
+            batch = batches[i]
+
+            if batch[0] == key
+              target = batch
+              break
+            end
+
+            break if overlap?(box, batch[1]) && batch[2].any? { |other| other.nil? || overlap?(box, other) }
+          end
+        end
+
+        if target.nil?
+          target = [key, box, [], []]
+          batches << target
+        elsif box.nil? || target[1].nil?
+          target[1] = nil
+        else
+          target[1] = union(target[1], box)
+        end
+
+        target[2] << box
+        target[3] << command
+      end
+
+      batches.each { |batch| out.concat(batch[3]) }
+      out
+    end
+
+    # Which texture the backend draws (command) from, nil for state commands
+    def self.batch_key(command)
+      case command
+      when Commands::Rectangle, Commands::Circle
+        :shapes
+      when Commands::Text, Commands::GlyphRun
+        [:text, command.font]
+      when Commands::Image
+        :image
+      when Commands::Texture
+        [:texture, command.texture.object_id]
+      end
+    end
+
+    # Where (command) may draw, as [x, y, width, height], or nil when unknown
+    def self.bounds(command)
+      case command
+      when Commands::Rectangle
+        outline = command.outline
+        grow = [outline.top, outline.right, outline.bottom, outline.left].max.to_f
+        [command.x - grow, command.y - grow, command.width + grow * 2, command.height + grow * 2]
+      when Commands::Circle
+        grow = command.radius + command.outline.to_f
+        [command.x - grow, command.y - grow, grow * 2, grow * 2]
+      when Commands::Text
+        # only the font's own advances bound the text
+        font = command.font || Hokusai.fonts.active
+        return nil unless font.respond_to?(:measure)
+
+        size = command.size.to_f
+        width, height = font.measure(command.content, size.to_i)
+        # measured at the font's spacing but drawn at 1.0 between chars,
+        # with a margin for glyphs that overhang their advance
+        margin = size / 4
+        [command.x - margin, command.y - margin, width + command.content.size + margin * 2, height + margin * 2]
+      when Commands::GlyphRun
+        [command.x, command.y, command.width, command.height]
+      when Commands::Image
+        slice = command.slice
+        return [command.x, command.y, command.width, command.height] if slice.nil?
+
+        # a slice draws at its own size, a placeholder at the image's while it loads
+        [command.x, command.y, [command.width, slice.width.abs].max, [command.height, slice.height.abs].max]
+      when Commands::Texture
+        return nil unless command.rotation.zero?
+
+        [command.x, command.y, command.width, command.height]
+      end
+    end
+
+    def self.overlap?(a, b)
+      return true if b.nil?
+
+      a[0] < b[0] + b[2] && b[0] < a[0] + a[2] && a[1] < b[1] + b[3] && b[1] < a[1] + a[3]
+    end
+
+    def self.union(a, b)
+      x = [a[0], b[0]].min
+      y = [a[1], b[1]].min
+
+      [x, y, [a[0] + a[2], b[0] + b[2]].max - x, [a[1] + a[3], b[1] + b[3]].max - y]
+    end
+
+    def self.same_state?(a, b)
+      return false unless a.class == b.class
+
+      a.instance_variables.all? { |name| a.instance_variable_get(name) == b.instance_variable_get(name) }
+    end
+  end
+end
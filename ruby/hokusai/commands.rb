@@ -4,6 +4,7 @@ require_relative "./commands/image"
 require_relative "./commands/rect"
 require_relative "./commands/scissor"
 require_relative "./commands/text"
+require_relative "./commands/glyph_run"
 require_relative "./commands/shader"
 require_relative "./commands/texture"
 require_relative "./commands/rotation"
@@ -171,6 +172,26 @@ module Hokusai
       queue << command
     end
 
+    # Public: Draws many runs of text in one command.
+    #          Yields a [Commands::GlyphRun](/api/Hokusai/Commands/GlyphRun)
+    #
+    # font - the Hokusai::Backend::Font to draw with
+    # size - font size
+    #
+    # Examples
+    #
+    #   glyph_run(font, 17) do |run|
+    #     run.color = [0, 0, 0]
+    #     run.add("hello", 0.0, 0.0)
+    #     run.add("world", 0.0, 20.0)
+    #   end
+    def glyph_run(font, size)
+      command = Commands::GlyphRun.new(font, size)
+      yield command
+
+      queue << command unless command.empty?
+    end
+
     def execute
       queue.each(&:draw)
     end
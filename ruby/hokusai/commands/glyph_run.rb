@@ -0,0 +1,78 @@
+module Hokusai
+  # Internal: Command to draw many runs of text with one font, size and color
+  #
+  # Each run is placed into one packed buffer of (codepoint, x, y) records
+  # by Font#pack_glyphs, so the backend draws every glyph in a single call
+  # without measuring anything again.
+  class Commands::GlyphRun < Commands::Base
+    attr_reader :font, :size, :color, :glyphs,
+                :x, :y, :width, :height
+
+    # Internal: GlyphRun constructor
+    #
+    # font - the Hokusai::Backend::Font to place and draw with
+    # size - font size
+    def initialize(font, size)
+      @font = font
+      @size = size.to_f
+      @color = Color.new(0, 0, 0, 255)
+      @glyphs = ""
+      @x = nil
+      @y = nil
+      @width = 0.0
+      @height = 0.0
+    end
+
+    def hash
+      [self.class, glyphs, font, size, color.hash].hash
+    end
+
+    # Sets the color of the text
+    # from an array of rgba values
+    def color=(value)
+      case value
+      when Color
+        @color = value
+      when Array
+        @color = Color.new(value[0], value[1], value[2], value[3] || 255)
+      end
+    end
+
+    # Internal: Places (text) at (x, y), the same place a Commands::Text would draw it
+    #
+    # Returns nothing
+    def add(text, x, y)
+      return if text.empty?
+
+      # the right edge of the widest line placed
+      finish = font.pack_glyphs(glyphs, text, x.to_f, y.to_f, size.to_i)
+      lines = text.count("\n") + 1
+      include_bounds(x.to_f, y.to_f, finish, y.to_f + lines * size * 2)
+
+      nil
+    end
+
+    def empty?
+      glyphs.empty?
+    end
+
+    private
+
+    def include_bounds(left, top, right, bottom)
+      if @x.nil?
+        @x = left
+        @y = top
+        @width = right - left
+        @height = bottom - top
+        return
+      end
+
+      right = [right, @x + @width].max
+      bottom = [bottom, @y + @height].max
+      @x = [left, @x].min
+      @y = [top, @y].min
+      @width = right - @x
+      @height = bottom - @y
+    end
+  end
+end
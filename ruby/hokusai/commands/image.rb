@@ -32,7 +32,8 @@ module Hokusai
     end
 
     def hash
-      [self.class, x, y, width, height].hash
+      # the generation changes whenever the image's pixels do, so layers holding it re-record
+      [self.class, image.object_id, image.generation, x, y, width, height, slice && [slice.x, slice.y, slice.width, slice.height]].hash
     end
 
     def cache
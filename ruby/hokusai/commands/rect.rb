@@ -23,7 +23,7 @@ module Hokusai
     end
 
     def hash
-      [self.class, x, y, width, height, rounding, color.hash, outline.hash, outline_color.hash, padding.hash].hash
+      [self.class, x, y, width, height, rounding, color.hash, outline.hash, outline_color.hash, padding.hash, gradient&.map(&:hash)].hash
     end
 
     # Modifies the parameter *Canvas*
@@ -51,7 +51,7 @@ module Hokusai
     end
 
     def hash
-      [self.class, vertex_shader, fragment_shader].hash
+      [self.class, vertex_shader, fragment_shader, uniforms.hash].hash
     end
   end
 
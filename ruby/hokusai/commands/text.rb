@@ -18,7 +18,7 @@ module Hokusai
     end
 
     def hash
-      [self.class, content, color.hash, padding.hash, size, font, wrap].hash
+      [self.class, content, x, y, color.hash, padding.hash, size, font, wrap, line_height].hash
     end
 
     def static=(value)
@@ -2,7 +2,7 @@ module Hokusai
   # Internal: Command to draw a Hokusai::Texture
   class Commands::Texture < Commands::Base
     attr_reader :texture, :x, :y
-    attr_accessor :width, :height, :flip, :repeat, :rotation
+    attr_accessor :width, :height, :flip, :repeat, :rotation, :premultiplied
 
     def initialize(texture, x, y)
       @texture = texture
@@ -13,10 +13,12 @@ module Hokusai
       @repeat = false
       @rotation = 0.0
       @flip = true
+      @premultiplied = false
     end
 
+    # the generation changes whenever the texture is drawn to, so layers holding it re-record
     def hash
-      [self.class, width, height].hash
+      [self.class, texture.object_id, texture.generation, x, y, width, height, flip, repeat, rotation].hash
     end
   end
 end
\ No newline at end of file
@@ -45,7 +45,7 @@ module Hokusai
       # 
       # Returns Object
       def json
-        JSON.parse(all)
+        Hokusai::JSON.parse(all)
       end
 
       # Public: Get response body as a String
@@ -0,0 +1,63 @@
+module Hokusai
+  # Internal: An offscreen cache for a block rendered with the `layer` prop
+  #
+  # The block's subtree still renders every frame (for layout and events),
+  # but its commands are only drawn once into a pooled Hokusai::Texture.
+  # While the commands are unchanged, the layer draws that texture as a single quad.
+  # A subtree that changes is drawn directly until it holds still for a frame.
+  class Layer
+    attr_reader :texture
+
+    def initialize
+      @texture = nil
+      @fingerprint = nil
+      @recorded = nil
+    end
+
+    # Internal: What to draw for a subtree with the bounds (x, y, width, height)
+    #
+    # commands - the subtree's Commands::Base list
+    #
+    # Returns (commands), or a single Commands::Texture when they are cached
+    def composite(commands, x, y, width, height)
+      fingerprint = [x, y, width, height, commands.map(&:hash)].hash
+
+      if fingerprint != @fingerprint || width < 1 || height < 1
+        @fingerprint = fingerprint
+        @recorded = nil
+
+        return commands
+      end
+
+      unless @recorded == fingerprint
+        # the backend can't switch targets right now, draw directly and try again next frame
+        return commands unless record(commands, x, y, width.ceil, height.ceil)
+      end
+
+      command = Commands::Texture.new(texture, x, y)
+      command.premultiplied = true
+      [command]
+    end
+
+    # Internal: Returns the texture to the render texture pool
+    def release
+      @texture&.release
+      @texture = nil
+      @recorded = nil
+    end
+
+    private
+
+    def record(commands, x, y, width, height)
+      if texture.nil? || texture.width != width || texture.height != height
+        release
+        @texture = Hokusai::Texture.init(width, height)
+      end
+
+      return false unless Hokusai.render_layer(texture, CommandStream.optimize(commands), x.to_f, y.to_f)
+
+      @recorded = @fingerprint
+      true
+    end
+  end
+end
@@ -12,6 +12,17 @@ module Hokusai
       @commands ||= Commands.new
     end
 
+    # Internal: the offscreen cache for blocks with the `layer` prop
+    def layer
+      @layer ||= Layer.new
+    end
+
+    # Internal: Releases the layer texture, if any
+    def release_layer
+      @layer&.release
+      @layer = nil
+    end
+
     def initialize
       @focused = false
       @parent = nil
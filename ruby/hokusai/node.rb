@@ -53,7 +53,9 @@ module Hokusai
       ast.event(name)
     end
 
-    def destroy; end
+    def destroy
+      meta.release_layer
+    end
 
     def initialize(ast, portal = nil)
       @ast = ast
@@ -19,6 +19,17 @@ module Hokusai
     end
   end
 
+  # Internal: Commands collected for a block with the `layer` prop and its subtree
+  class LayerEntry
+    attr_reader :entry, :depth, :commands
+
+    def initialize(entry, depth)
+      @entry = entry
+      @depth = depth
+      @commands = []
+    end
+  end
+
   ZTARGET_ROOT = "root"
   ZTARGET_PARENT = "parent"
 
@@ -107,7 +118,17 @@ module Hokusai
       end
 
       hovered = false
+      layer = nil
+      # drawn in one go after the tree is walked, see Hokusai::CommandStream
+      frame = []
+      Hokusai.walking(true)
       while payload = groups.pop
+        # the layer's subtree is done once its siblings are back on top
+        if layer && groups.size <= layer.depth
+          composite_layer(layer, frame)
+          layer = nil
+        end
+
         group_parent, group_children = payload
         
         parent_z = group_parent.block.node.meta.get_prop(:z)&.to_i
@@ -135,6 +156,11 @@ module Hokusai
 
           canvas.reset(entry.x, entry.y, entry.w, entry.h)
 
+          # nested layers are part of the outer layer's texture
+          if layer.nil? && zindex_counter.zero? && z.zero? && group.block.node.meta.get_prop(:layer)
+            layer = LayerEntry.new(entry, groups.size)
+          end
+
           before_render&.call([group.block, group.parent], canvas, input)
 
           if resize
@@ -178,9 +204,20 @@ module Hokusai
             zindexed[zindex_counter] ||= []
             # puts ["push (#{z}) <#{parent_z}>  {#{zindex_counter}} initial #{group.block.class}".colorize(:red), z, group.block.node.portal&.ast&.id]
             zindexed[zindex_counter] << group
+          elsif layer
+            layer.commands.concat group.block.node.meta.commands.queue
+            group.block.node.meta.commands.clear!
+
+            # a layer without children is done right away
+            if layer.entry.block.equal?(group.block) && !breaked
+              composite_layer(layer, frame)
+              layer = nil
+            end
           else
             # puts ["draw (#{z}) <#{parent_z}>  {#{zindex_counter}} #{group.block.class}".colorize(:yellow), z, group.block.node.portal&.ast&.id]
-            group.block.execute_draw
+            Hokusai.track_scissor(group.block.node.meta.commands.queue)
+            frame.concat group.block.node.meta.commands.queue
+            group.block.node.meta.commands.clear!
           end
 
 
@@ -188,14 +225,20 @@ module Hokusai
         end
       end
 
+      composite_layer(layer, frame) if layer
+
       zindexed.sort.each do |z, groups|
         groups.each do |group|
           canvas.reset(group.x, group.y, group.w, group.h)
           capture_events(group.block, canvas)
-          group.block.execute_draw
+          frame.concat group.block.node.meta.commands.queue
+          group.block.node.meta.commands.clear!
         end
       end
 
+      Hokusai.walking(false)
+      CommandStream.optimize(frame).each(&:draw)
+
       if capture
         events[:hover].bubble
         events[:wheel].bubble
@@ -225,6 +268,12 @@ module Hokusai
       after_render&.call
     end
 
+    # Internal: Adds a layer's commands to (frame), or its cached texture when they are unchanged
+    def composite_layer(layer, frame)
+      entry = layer.entry
+      frame.concat entry.block.node.meta.layer.composite(layer.commands, entry.x || 0.0, entry.y || 0.0, entry.w, entry.h)
+    end
+
     def resolve_percent(value, total)
       return nil if value.nil?
       str = value.to_s
@@ -30,6 +30,48 @@ module Hokusai
     end
   end
 
+  # Public: A global registry of compiled shaders
+  #
+  # Shaders otherwise compile on the first frame a ShaderBegin with their source is drawn.
+  # Blocks declare theirs with Hokusai::Block.shader,
+  # and the backend precompiles every shader declared by the app's blocks before the first frame.
+  class ShaderRegistry
+    def initialize
+      @compiled = {}
+    end
+
+    # Public: Compiles a shader ahead of its first draw
+    #
+    # vertex - vertex shader source (String or nil for the default)
+    # fragment - fragment shader source (String or nil for the default)
+    #
+    # Returns true if the shader compiled, false if it fell back to the default shader
+    def precompile(vertex, fragment)
+      key = [vertex, fragment]
+      return @compiled[key] if @compiled.key?(key)
+
+      @compiled[key] = Hokusai.precompile_shader(vertex, fragment)
+    end
+
+    # Public: Whether a shader was precompiled
+    def compiled?(vertex, fragment)
+      @compiled.key?([vertex, fragment])
+    end
+
+    # Internal: Precompiles the shaders declared by (klass) and by every block it uses
+    #
+    # klass - a Hokusai::Block class
+    #
+    # Returns nothing
+    def warm(klass, seen = {})
+      return if seen[klass]
+
+      seen[klass] = true
+      klass.shaders.each { |vertex, fragment| precompile(vertex, fragment) }
+      klass.uses_get.each_value { |child| warm(child, seen) }
+    end
+  end
+
   # Public: A global registry for storing Hokusai::Texture
   class TextureRegistry
     attr_reader :textures
@@ -77,6 +119,17 @@ module Hokusai
     def delete(name)
       @textures.delete(name)
     end
+
+    # Public: Delete a texture from the registry
+    #         and return its render texture to the pool
+    #         so the next texture of the same size can reuse it
+    #
+    # name - key for texture (String)
+    #
+    # Returns nothing
+    def release(name)
+      @textures.delete(name)&.release
+    end
   end
 
   # Public: A global registry for storing Hokusai::Image
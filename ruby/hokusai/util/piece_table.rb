@@ -1,106 +1,45 @@
 module Hokusai::Util
+  # A piece table for editable text, implemented natively (src/piece_table.c)
+  #
+  # The pieces live in a balanced tree keyed by character offset,
+  # so #insert, #delete, #slice and the line lookups cost O(log pieces)
+  # and typing at the end of the last insert extends that piece in place.
+  #
+  # Offsets and counts are in characters.
+  #
+  # Native methods:
+  #   initialize(buffer = "")
+  #   insert(text, offset = buffer.size - 1)
+  #   delete(offset, count)
+  #   slice(offset, count) - the text of (count) characters at (offset)
+  #   to_s
+  #   size - the length of the text in characters
+  #   line_count
+  #   line_at(offset) - the 0 based line (offset) sits on
+  #   line_offset(line) - the offset of the first character of (line), or nil
+  #   pieces - [[:original | :add, start, size], ...] in document order
+  #   buffer, buffer_add - the original and append only buffers, read only
+  #
+  # The pure Ruby table's buffer=, buffer_add=, last_piece_index and last_piece_index=
+  # are gone: the tree owns its buffers and extends the last insert itself.
+  #
+  # Errors raise Hokusai::Error
   class PieceTable
-    attr_accessor :buffer, :buffer_add, :last_piece_index
-    attr_reader :pieces
+    # Public: The text of (line), without its newline
+    #
+    # Returns a String or nil if there is no such line
+    def line(line)
+      start = line_offset(line)
+      return if start.nil?
 
-    def initialize(buffer = "")
-      @pieces = [[:original, 0, buffer.size]]
-      @buffer_add = ""
-      @buffer = buffer
-      @last_piece_index = nil
-    end
-
-    def to_s
-      io = ""
-      pieces.each do |(which, start, size)|
-        case which
-        when :original
-          io << buffer[start, size]
-        else
-          if buffer_add[start, size].nil?
-            raise Hokusai::Error.new("#{which} Bad: #{start} #{size}")
-          end
+      finish = line_offset(line + 1)
+      finish = finish.nil? ? size : finish - 1
 
-          io << buffer_add[start, size]
-        end
-      end
-
-      io
+      slice(start, finish - start)
     end
 
-    def insert(text, offset = buffer.size - 1)
-      return nil if text.size.zero?
-
-      piece_at_buffer_offset(offset) do |(piece, index, remainder)|
-        which, start, size = piece
-        length = remainder - start
-        
-        new_pieces = []
-        new_pieces << [which, start, length] if length > 0
-        new_pieces << [:add, buffer_add.size, text.size]
-        new_pieces << [which, length + start, size - length] if size - length > 0
-  
-        self.last_piece_index = index + 1
-        self.pieces[index..index] = new_pieces
-        self.buffer_add += text
-      end
-    end
-
-    def delete(offset, count)
-      piece_at_buffer_offset(offset) do |(piece_left, index_left, remainder_left)|
-        piece_at_buffer_offset(offset + count) do |(piece_right, index_right, remainder_right)|
-          if index_left == index_right
-            if remainder_left == piece_left[1]
-              pieces[index_left] = [piece_left[0], piece_left[1] + count, piece_left[2] - count]
-
-              return
-            elsif remainder_right == piece_left[1] + piece_left[2]
-              pieces[index_left] = [piece_left[0], piece_left[1], piece_left[2] - count]
-              
-              return
-            end
-          end
-  
-          new_pieces = []
-          left = [piece_left[0], piece_left[1], remainder_left - piece_left[1]]
-          left_condition = (remainder_left - piece_left[1] > 0)
-          right = [piece_right[0], remainder_right, piece_right[2] - (remainder_right - piece_right[1])]
-          right_condition =  (piece_right[2] - (remainder_right - piece_right[1]) > 0)
-
-          if !left_condition && !right_condition
-            new_pieces << left
-          end
-          
-          if left_condition
-            new_pieces << left
-          end
-
-          if right_condition
-            new_pieces << right
-          end
-
-          self.pieces[index_left..index_right] = new_pieces
-          self.last_piece_index = nil
-        end
-      end
-    end
-
-    private def piece_at_buffer_offset(offset)
-      raise Hokusai::Error.new("Piece table offset is negative") if offset.negative?
-  
-      remainder = offset
-  
-      pieces.each_with_index do |piece, index|
-        if remainder <= piece[2]
-          yield([piece, index, remainder + piece[1]])
-          
-          return
-        end
-  
-        remainder -= piece[2]
-      end      
-
-      raise Hokusai::Error.new("Piece table offset is greater than the buffer! #{offset}\n#{pieces}")
+    def empty?
+      size.zero?
     end
   end
-end
\ No newline at end of file
+end
@@ -35,7 +35,7 @@ module Hokusai::Util
   #         Utiltiy methods are provided to quickly fetch a subset of tokens
   #         Based on a given window's coordinates (canvas)
   class WrapCache
-    attr_accessor :tokens
+    attr_accessor :tokens, :y, :origin_y
 
     # Public: returns range denoting the index of the changed lines
     #         from 2 different strings.
@@ -77,6 +77,82 @@ module Hokusai::Util
       a..b
     end
 
+    # Public: Wraps (text) with the font's native line breaker
+    #         (same rules as WrapStream, see Hokusai::Backend::Font#wrap)
+    #
+    # font - a Hokusai::Backend::Font
+    # text - the String to wrap
+    # size - the font size (Integer)
+    # width - the width lines break at (Float)
+    # origin_x - where lines start (default: 0.0)
+    # origin_y - where the first line starts (default: 0.0)
+    # extra - an opaque payload for every token (default: nil)
+    # boundaries - sorted character offsets that start a new token on the same line (default: nil)
+    #
+    # Returns [WrapCache, y] where y is where the last line starts, like WrapStream#y
+    def self.wrap(font, text, size, width, origin_x = 0.0, origin_y = 0.0, extra = nil, boundaries: nil)
+      cache = new
+      cache.origin_y = origin_y
+      cache.y = wrap_into(cache.tokens, font, text, size, width, origin_x, origin_y, extra, 0, boundaries)
+
+      [cache, cache.y]
+    end
+
+    # Internal: Appends the wrapped tokens of (text) to (tokens),
+    #           with their positions starting at (position)
+    #
+    # Returns where the last line starts
+    def self.wrap_into(tokens, font, text, size, width, origin_x, origin_y, extra, position, boundaries = nil)
+      packed, widths, breaks = font.wrap(text, size, width.to_f, boundaries)
+
+      i = 0
+      while i < packed.size
+        content, start, length, x, token_width, line = packed[i, 6]
+        rect = Hokusai::Rect.new(origin_x + x, origin_y + line * size, token_width, size)
+        tokens << Wrapped.new(content, rect, extra, widths: widths[start, length], positions: ((position + start)...(position + start + length)).to_a)
+
+        i += 6
+      end
+
+      origin_y + breaks * size
+    end
+
+    # Internal: Length of the longest common prefix of 2 strings, in characters
+    def self.common_prefix(first, second)
+      low = 0
+      high = [first.size, second.size].min
+
+      while low < high
+        mid = (low + high + 1) / 2
+
+        if first[0, mid] == second[0, mid]
+          low = mid
+        else
+          high = mid - 1
+        end
+      end
+
+      low
+    end
+
+    # Internal: Length of the longest common suffix of 2 strings, at most (limit) characters
+    def self.common_suffix(first, second, limit)
+      low = 0
+      high = limit
+
+      while low < high
+        mid = (low + high + 1) / 2
+
+        if first[first.size - mid, mid] == second[second.size - mid, mid]
+          low = mid
+        else
+          high = mid - 1
+        end
+      end
+
+      low
+    end
+
     def initialize
       @tokens = []
     end
@@ -90,6 +166,92 @@ module Hokusai::Util
       @tokens << element
     end
 
+    # Public: Moves every token by (dx, dy)
+    #
+    # Returns nothing
+    def translate(dx, dy)
+      return if dx.zero? && dy.zero?
+
+      tokens.each do |token|
+        token.x += dx
+        token.y += dy
+      end
+
+      self.origin_y += dy
+      self.y += dy
+    end
+
+    # Public: Updates a cache built by WrapCache.wrap from (last_content) to (new_content)
+    #         Lines only ever break inside a paragraph, so only the paragraphs touched by the edit
+    #         are wrapped again. The tokens before them are reused as is,
+    #         the tokens after them are moved by the change in lines and characters.
+    #
+    # font, size, width, origin_x, extra - the same arguments WrapCache.wrap was given
+    # last_content - the text this cache holds
+    # new_content - the text to hold
+    #
+    # Returns where the last line starts, like WrapCache.wrap
+    def rewrap(font, last_content, new_content, size, width, origin_x = 0.0, extra = nil)
+      return y if last_content == new_content
+
+      if tokens.empty?
+        self.y = WrapCache.wrap_into(tokens, font, new_content, size, width, origin_x, origin_y, extra, 0)
+        return y
+      end
+
+      old_size = last_content.size
+      prefix = WrapCache.common_prefix(last_content, new_content)
+      suffix = WrapCache.common_suffix(last_content, new_content, [old_size, new_content.size].min - prefix)
+      delta = new_content.size - old_size
+
+      # the paragraphs holding the change, inclusive of their newlines
+      start = prefix.zero? ? 0 : (last_content.rindex("\n", prefix - 1) || -1) + 1
+      old_end = last_content.index("\n", old_size - suffix) || old_size - 1
+      new_end = old_end == old_size - 1 ? new_content.size - 1 : old_end + delta
+
+      first = token_index(start)
+      last = token_index(old_end + 1)
+      origin_y = first < tokens.size ? tokens[first].y : y
+
+      records = []
+      region_y = WrapCache.wrap_into(records, font, new_content[start..new_end] || "", size, width, origin_x, origin_y, extra, start)
+
+      if last < tokens.size
+        # the next paragraph started where the change's trailing newline left off
+        dy = region_y - tokens[last].y
+
+        tokens[last..-1].each do |token|
+          token.y += dy
+          token.positions.map! { |pos| pos + delta }
+        end
+
+        self.y += dy
+      else
+        self.y = region_y
+      end
+
+      tokens[first...last] = records
+      y
+    end
+
+    # Internal: Index of the first token at or after character (position)
+    def token_index(position)
+      low = 0
+      high = tokens.size
+
+      while low < high
+        mid = (low + high) / 2
+
+        if tokens[mid].positions.first < position
+          low = mid + 1
+        else
+          high = mid
+        end
+      end
+
+      low
+    end
+
     def splice(stream, last_content, new_content, selection: nil)
       change_line_indicies = WrapCache.diff(last_content, new_content)
       new_changed_line_indicies = WrapCache.diff(new_content, last_content)
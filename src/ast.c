@@ -7,7 +7,7 @@
 hoku_ast* hp_create_ast(mrb_state* mrb, char* type, char* template)
 {
   hoku_ast* ast;
-  if (hoku_ast_from_template(&ast, type, template) != 0)
+  if (hp_template_cache_ast(&ast, type, template) != 0)
   {
     struct RClass* hokusai_class = mrb_class_get(mrb, "Hokusai");
     struct RClass* exp = mrb_class_get_under(mrb, hokusai_class, "Error");
@@ -23,170 +23,333 @@ hoku_ast* hp_create_ast(mrb_state* mrb, char* type, char* template)
     struct RClass* hokusai_class = mrb_module_get(mrb, "Hokusai");
     struct RClass* exp = mrb_class_get_under(mrb, hokusai_class, "Error");
     mrb_value errstr = mrb_str_new_cstr(mrb, errored->error);
+    hoku_ast_free(ast);
     mrb_raisef(mrb, exp, "Failed to parse template for %S", errstr);
   }
 
   return ast;
 }
 
-/* returns head */
-mrb_value hp_ast_walk(hoku_ast* ast, mrb_state* mrb)
+/*
+  A parsed tree stays in C and Hokusai::Ast objects point into it,
+  their fields are converted the first time ruby reads them (see ruby/hokusai/ast.rb).
+  Every wrapper holds a reference on the tree, the last one to go frees it.
+*/
+typedef struct HpAstTree
 {
-  struct RClass* module = mrb_module_get(mrb, "Hokusai");
-  struct RClass* ast_klass = mrb_class_get_under(mrb, module, "Ast");
-  struct RClass* func_klass = mrb_class_get_under(mrb, ast_klass, "Func");
-  struct RClass* loop_klass = mrb_class_get_under(mrb, ast_klass, "Loop");
-  struct RClass* prop_klass = mrb_class_get_under(mrb, ast_klass, "Prop");
-  struct RClass* event_klass = mrb_class_get_under(mrb, ast_klass, "Event");
+  hoku_ast* root;
+  mrb_int refs;
+} hp_ast_tree;
+
+typedef struct HpAstRef
+{
+  hp_ast_tree* tree;
+  hoku_ast* node;
+} hp_ast_ref;
+
+/*
+  While retaining (hot reload), the last tree parsed for every template type is kept
+  and handed out again as long as the type's template is unchanged.
+  The C tree is never written to after the walk, so any number of wrappers can share it.
+*/
+typedef struct HpAstShared
+{
+  char* type;
+  uint64_t key;
+  size_t bytes;
+  hp_ast_tree* tree;
+} hp_ast_shared;
+
+static _Thread_local struct hashmap* hp_ast_shared_trees = NULL;
+static _Thread_local uint64_t hp_ast_shared_hits = 0;
+static _Thread_local bool hp_ast_retaining = false;
+
+static void hp_ast_tree_release(hp_ast_tree* tree)
+{
+  if (--tree->refs > 0) return;
+
+  hoku_ast_free(tree->root);
+  free(tree);
+}
+
+static void hp_ast_type_free(mrb_state* mrb, void* payload)
+{
+  hp_ast_ref* ref = (hp_ast_ref*) payload;
+  hp_ast_tree_release(ref->tree);
+  free(ref);
+}
+
+static int hp_ast_shared_compare(const void* a, const void* b, void* udata)
+{
+  return strcmp(((hp_ast_shared*) a)->type, ((hp_ast_shared*) b)->type);
+}
+
+static uint64_t hp_ast_shared_hash(const void* item, uint64_t seed0, uint64_t seed1)
+{
+  const char* type = ((hp_ast_shared*) item)->type;
+  return hashmap_sip(type, strlen(type), seed0, seed1);
+}
+
+static void hp_ast_shared_free(void* item)
+{
+  hp_ast_shared* shared = (hp_ast_shared*) item;
+  free(shared->type);
+  hp_ast_tree_release(shared->tree);
+}
+
+/* type's last tree if it was parsed from template, NULL otherwise */
+static hp_ast_tree* hp_ast_shared_get(char* type, char* template)
+{
+  if (hp_ast_shared_trees == NULL) return NULL;
 
-  mrb_value rast = mrb_obj_new(mrb, ast_klass, 0, NULL);
+  const hp_ast_shared* shared = hashmap_get(hp_ast_shared_trees, &(hp_ast_shared){ .type = type });
+  if (shared == NULL) return NULL;
 
-  /* get id */
-  if (ast->id) mrb_funcall(mrb, rast, "id=", 1, mrb_str_new(mrb, ast->id, strlen(ast->id)));
+  size_t bytes = strlen(template);
+  if (shared->bytes != bytes || shared->key != hoku_blob_key(type, template, bytes)) return NULL;
 
-  /* get ast type */
-  if (ast->type != NULL) mrb_funcall(mrb, rast, "type=", 1, mrb_str_new(mrb, ast->type, strlen(ast->type)));
+  hp_ast_shared_hits++;
+  return shared->tree;
+}
 
-  /* get class list */
-  mrb_value class_array = mrb_funcall(mrb, rast, "classes", 0, NULL);
-  hoku_ast_class_list* class_list = ast->class_list;
-  while (class_list != NULL)
+/* keeps a reference on tree as type's last tree */
+static void hp_ast_shared_set(char* type, char* template, hp_ast_tree* tree)
+{
+  if (hp_ast_shared_trees == NULL)
   {
-    mrb_ary_unshift(mrb, class_array, mrb_str_new_cstr(mrb, class_list->name));
-    class_list = class_list->next;
+    hp_ast_shared_trees = hashmap_new(sizeof(hp_ast_shared), 0, 0, 0, hp_ast_shared_hash, hp_ast_shared_compare, hp_ast_shared_free, NULL);
+    if (hp_ast_shared_trees == NULL) return;
   }
 
-  /* get style list */
-  mrb_value style_array = mrb_funcall(mrb, rast, "style_list", 0, NULL);
-  hoku_ast_class_list* style_list = ast->style_list;
-  while (style_list != NULL)
+  size_t bytes = strlen(template);
+  hp_ast_shared shared = { .type = strdup(type), .key = hoku_blob_key(type, template, bytes), .bytes = bytes, .tree = tree };
+  if (shared.type == NULL) return;
+
+  tree->refs++;
+  const hp_ast_shared* replaced = hashmap_set(hp_ast_shared_trees, &shared);
+  if (replaced != NULL)
   {
-    mrb_ary_unshift(mrb, style_array, mrb_str_new_cstr(mrb, style_list->name));
-    style_list = style_list->next;
+    hp_ast_shared old = *replaced;
+    hp_ast_shared_free(&old);
   }
-
-  /* get if function */
-  if (ast->cond)
+  else if (hashmap_oom(hp_ast_shared_trees))
   {
-    mrb_value if_func_method = mrb_str_new_cstr(mrb, ast->cond->call->function);
-    mrb_value if_func_args = mrb_ary_new(mrb);
+    hp_ast_shared_free(&shared);
+  }
+}
+
+void hp_ast_retain(bool retain)
+{
+  hp_ast_retaining = retain;
+  hoku_parser_retain(retain);
+  if (retain || hp_ast_shared_trees == NULL) return;
 
-    for (int i=0; i<ast->cond->call->args_len; i++)
-    {
-      mrb_ary_push(mrb, if_func_args, mrb_str_new_cstr(mrb, ast->cond->call->strargs[i]));
-    }
+  hashmap_free(hp_ast_shared_trees);
+  hp_ast_shared_trees = NULL;
+}
+
+static struct mrb_data_type hp_ast_type = { "Ast", hp_ast_type_free };
+
+/* the C node behind self, NULL for asts made with the NodeBuilder */
+static hoku_ast* hp_ast_get(mrb_state* mrb, mrb_value self)
+{
+  hp_ast_ref* ref = DATA_GET_PTR(mrb, self, &hp_ast_type, hp_ast_ref);
+  return ref == NULL ? NULL : ref->node;
+}
+
+static mrb_value hp_ast_wrap(mrb_state* mrb, hp_ast_tree* tree, hoku_ast* node)
+{
+  struct RClass* module = mrb_module_get(mrb, "Hokusai");
+  struct RClass* ast_klass = mrb_class_get_under(mrb, module, "Ast");
+
+  hp_ast_ref* ref = malloc(sizeof(hp_ast_ref));
+  if (ref == NULL) mrb_raise(mrb, E_RUNTIME_ERROR, "Cannot allocate ast");
+
+  ref->tree = tree;
+  ref->node = node;
+  mrb_value rast = mrb_obj_value(mrb_data_object_alloc(mrb, ast_klass, ref, &hp_ast_type));
+  tree->refs++;
+
+  // the fields ruby sets itself, initialize isn't run
+  mrb_iv_set(mrb, rast, mrb_intern_lit(mrb, "@else_active"), mrb_false_value());
+  mrb_iv_set(mrb, rast, mrb_intern_lit(mrb, "@siblingindex"), mrb_int_value(mrb, 0));
+  return rast;
+}
+
+static mrb_value hp_ast_wrap_ref(mrb_state* mrb, mrb_value self, hoku_ast* node)
+{
+  hp_ast_ref* ref = DATA_GET_PTR(mrb, self, &hp_ast_type, hp_ast_ref);
+  return hp_ast_wrap(mrb, ref->tree, node);
+}
+
+static mrb_value hp_ast_func(mrb_state* mrb, hoku_ast_func_call* call)
+{
+  if (call == NULL) return mrb_nil_value();
+
+  struct RClass* module = mrb_module_get(mrb, "Hokusai");
+  struct RClass* ast_klass = mrb_class_get_under(mrb, module, "Ast");
+  struct RClass* func_klass = mrb_class_get_under(mrb, ast_klass, "Func");
 
-    mrb_value ifargs [2] = {if_func_method, if_func_args};
-    mrb_value iffunc = mrb_obj_new(mrb, func_klass, 2, ifargs);
-    mrb_funcall(mrb, rast, "if=", 1, iffunc);
+  mrb_value func_method = mrb_str_new_cstr(mrb, call->function);
+  mrb_value func_args = mrb_ary_new_capa(mrb, call->args_len);
+
+  for (int i=0; i<call->args_len; i++)
+  {
+    mrb_ary_push(mrb, func_args, mrb_str_new_cstr(mrb, call->strargs[i]));
   }
 
-  /* get loop function */
-  if (ast->loop != NULL)
+  mrb_value fargs [2] = {func_method, func_args};
+  return mrb_obj_new(mrb, func_klass, 2, fargs);
+}
+
+static mrb_value hp_ast_names(mrb_state* mrb, hoku_ast_names* names)
+{
+  mrb_value array = mrb_ary_new_capa(mrb, names == NULL ? 0 : names->len);
+  if (names == NULL) return array;
+
+  for (uint16_t i = 0; i < names->len; i++)
   {
-    mrb_value loopargs[2] = {
-      mrb_str_new_cstr(mrb, ast->loop->name),
-      mrb_str_new_cstr(mrb, ast->loop->list_name)
-    };
-    mrb_value loopobj = mrb_obj_new(mrb, loop_klass, 2, loopargs);
-    mrb_funcall(mrb, rast, "loop=", 1, loopobj);
+    mrb_ary_push(mrb, array, mrb_str_new_cstr(mrb, names->names[i]));
   }
 
-  /* get props */
-  mrb_value prop_hash = mrb_funcall(mrb, rast, "props", 0, NULL);
-  size_t prop_iter = 0;
-  void* prop_item;
-  while (hashmap_iter(ast->props, &prop_iter, &prop_item))
+  return array;
+}
+
+/* wraps node and every sibling after it */
+static mrb_value hp_ast_chain(mrb_state* mrb, mrb_value self, hoku_ast* node)
+{
+  mrb_value array = mrb_ary_new(mrb);
+
+  while (node != NULL)
   {
-    mrb_value call = mrb_nil_value();
-    hoku_ast_prop* prop = (hoku_ast_prop*)prop_item;
-    if (prop->call != NULL)
-    {
-      mrb_value func_method = mrb_str_new_cstr(mrb, prop->call->function);
-      mrb_value func_args = mrb_ary_new(mrb);
-
-      for (int i=0; i<prop->call->args_len; i++)
-      {
-        mrb_ary_push(mrb, func_args, mrb_str_new_cstr(mrb, prop->call->strargs[i]));
-      }
-
-      mrb_value fargs [2] = {func_method, func_args };
-      call = mrb_obj_new(mrb, func_klass, 2, fargs);
-    }
-    else
-    {
-      call = mrb_nil_value();
-    }
+    mrb_ary_push(mrb, array, hp_ast_wrap_ref(mrb, self, node));
+    node = node->relations->next_sibling;
+  }
+
+  return array;
+}
 
+mrb_value hp_ast_native_type(mrb_state* mrb, mrb_value self)
+{
+  hoku_ast* ast = hp_ast_get(mrb, self);
+  if (ast == NULL || ast->type == NULL) return mrb_nil_value();
+
+  return mrb_str_new_cstr(mrb, ast->type);
+}
+
+mrb_value hp_ast_native_id(mrb_state* mrb, mrb_value self)
+{
+  hoku_ast* ast = hp_ast_get(mrb, self);
+  if (ast == NULL || ast->id == NULL) return mrb_nil_value();
+
+  return mrb_str_new_cstr(mrb, ast->id);
+}
+
+mrb_value hp_ast_native_classes(mrb_state* mrb, mrb_value self)
+{
+  hoku_ast* ast = hp_ast_get(mrb, self);
+  return hp_ast_names(mrb, ast == NULL ? NULL : &ast->class_list);
+}
+
+mrb_value hp_ast_native_style_list(mrb_state* mrb, mrb_value self)
+{
+  hoku_ast* ast = hp_ast_get(mrb, self);
+  return hp_ast_names(mrb, ast == NULL ? NULL : &ast->style_list);
+}
+
+mrb_value hp_ast_native_if(mrb_state* mrb, mrb_value self)
+{
+  hoku_ast* ast = hp_ast_get(mrb, self);
+  if (ast == NULL || ast->cond == NULL) return mrb_nil_value();
+
+  return hp_ast_func(mrb, ast->cond->call);
+}
+
+mrb_value hp_ast_native_loop(mrb_state* mrb, mrb_value self)
+{
+  hoku_ast* ast = hp_ast_get(mrb, self);
+  if (ast == NULL || ast->loop == NULL) return mrb_nil_value();
+
+  struct RClass* module = mrb_module_get(mrb, "Hokusai");
+  struct RClass* ast_klass = mrb_class_get_under(mrb, module, "Ast");
+  struct RClass* loop_klass = mrb_class_get_under(mrb, ast_klass, "Loop");
+
+  mrb_value loopargs[2] = {
+    mrb_str_new_cstr(mrb, ast->loop->name),
+    mrb_str_new_cstr(mrb, ast->loop->list_name)
+  };
+  return mrb_obj_new(mrb, loop_klass, 2, loopargs);
+}
+
+mrb_value hp_ast_native_props(mrb_state* mrb, mrb_value self)
+{
+  hoku_ast* ast = hp_ast_get(mrb, self);
+  mrb_value prop_hash = mrb_hash_new_capa(mrb, ast == NULL ? 0 : ast->props_len);
+  if (ast == NULL) return prop_hash;
+
+  struct RClass* module = mrb_module_get(mrb, "Hokusai");
+  struct RClass* ast_klass = mrb_class_get_under(mrb, module, "Ast");
+  struct RClass* prop_klass = mrb_class_get_under(mrb, ast_klass, "Prop");
+
+  for (hoku_ast_prop* prop = ast->props; prop < ast->props + ast->props_len; prop++)
+  {
     mrb_value pname =  mrb_str_new_cstr(mrb, prop->name);
-    mrb_value args[3] = {mrb_bool_value(prop->computed), pname, call};
+    mrb_value args[3] = {mrb_bool_value(prop->computed), pname, hp_ast_func(mrb, prop->call)};
     mrb_value hpprop = mrb_obj_new(mrb, prop_klass, 3, args);
     mrb_hash_set(mrb, prop_hash, pname, hpprop);
   }
 
-  /* get events */
-  mrb_value event_hash = mrb_funcall(mrb, rast, "events", 0, NULL);
-  size_t event_iter = 0;
-  void* event_item;
-  while (hashmap_iter(ast->events, &event_iter, &event_item))
-  {
-    mrb_value call = mrb_nil_value();
-    hoku_ast_event* event = (hoku_ast_event*)event_item;
-    if (event->call != NULL)
-    {
-      mrb_value func_method = mrb_str_new_cstr(mrb, event->call->function);
-      mrb_value func_args = mrb_ary_new(mrb);
-
-      for (int i=0; i<event->call->args_len; i++)
-      {
-        mrb_ary_push(mrb, func_args, mrb_str_new_cstr(mrb, event->call->strargs[i]));
-      }
-
-      mrb_value fargs [2] = {func_method, func_args };
-      call = mrb_obj_new(mrb, func_klass, 2, fargs);
-    }
-    else
-    {
-      call = mrb_nil_value();
-    }
+  return prop_hash;
+}
+
+mrb_value hp_ast_native_events(mrb_state* mrb, mrb_value self)
+{
+  hoku_ast* ast = hp_ast_get(mrb, self);
+  mrb_value event_hash = mrb_hash_new_capa(mrb, ast == NULL ? 0 : ast->events_len);
+  if (ast == NULL) return event_hash;
+
+  struct RClass* module = mrb_module_get(mrb, "Hokusai");
+  struct RClass* ast_klass = mrb_class_get_under(mrb, module, "Ast");
+  struct RClass* event_klass = mrb_class_get_under(mrb, ast_klass, "Event");
 
+  for (hoku_ast_event* event = ast->events; event < ast->events + ast->events_len; event++)
+  {
     mrb_value pname =  mrb_str_new_cstr(mrb, event->name);
-    mrb_value args[2] = {pname, call};
+    mrb_value args[2] = {pname, hp_ast_func(mrb, event->call)};
     mrb_value hpevent = mrb_obj_new(mrb, event_klass, 2, args);
     mrb_hash_set(mrb, event_hash, pname, hpevent);
   }
 
-  /* get siblings */
-  mrb_value siblings = mrb_funcall(mrb, rast, "siblings", 0, NULL);
-  hoku_ast* sibling_head = ast->relations->next_sibling;
-  while (sibling_head != NULL)
-  {
-    mrb_value rsibling = hp_ast_walk(sibling_head, mrb);
-    mrb_ary_push(mrb, siblings, rsibling);
+  return event_hash;
+}
 
-    sibling_head = sibling_head->relations->next_sibling;
-  }
+mrb_value hp_ast_native_children(mrb_state* mrb, mrb_value self)
+{
+  hoku_ast* ast = hp_ast_get(mrb, self);
+  if (ast == NULL) return mrb_ary_new(mrb);
 
-  /* get children */
-  mrb_value children = mrb_funcall(mrb, rast, "children", 0, NULL);
-  hoku_ast* child_head = ast->relations->next_child;
-  while (child_head != NULL)
-  {
-    mrb_value rchild = hp_ast_walk(child_head, mrb);
-    mrb_ary_push(mrb, children, rchild);
+  return hp_ast_chain(mrb, self, ast->relations->next_child);
+}
 
-    child_head = child_head->relations->next_sibling;
-  }
+mrb_value hp_ast_native_siblings(mrb_state* mrb, mrb_value self)
+{
+  hoku_ast* ast = hp_ast_get(mrb, self);
+  if (ast == NULL) return mrb_ary_new(mrb);
 
-  /* get else ast */
-  if (ast->else_relations)
-  {
-    mrb_value relse = hp_ast_walk(ast->else_relations->next_child, mrb);
-    mrb_funcall(mrb, rast, "else_ast=", 1, relse);
+  return hp_ast_chain(mrb, self, ast->relations->next_sibling);
+}
 
-  }
+mrb_value hp_ast_native_else_ast(mrb_state* mrb, mrb_value self)
+{
+  hoku_ast* ast = hp_ast_get(mrb, self);
+  if (ast == NULL || ast->else_relations == NULL || ast->else_relations->next_child == NULL) return mrb_nil_value();
 
-  return rast;
+  return hp_ast_wrap_ref(mrb, self, ast->else_relations->next_child);
+}
+
+mrb_value hp_ast_native_p(mrb_state* mrb, mrb_value self)
+{
+  return mrb_bool_value(hp_ast_get(mrb, self) != NULL);
 }
 
 /* mega parse */
@@ -199,15 +362,72 @@ mrb_value hp_ast_megaparse(mrb_state* mrb, mrb_value self)
 
   char* template = mrb_str_to_cstr(mrb, templ);
   char* type = mrb_str_to_cstr(mrb, templtype);
+
+  hp_ast_tree* shared = hp_ast_shared_get(type, template);
+  if (shared != NULL) return hp_ast_wrap(mrb, shared, shared->root);
+
   hoku_ast* ast = hp_create_ast(mrb, type, template);
-  return hp_ast_walk(ast, mrb);
+
+  hp_ast_tree* tree = malloc(sizeof(hp_ast_tree));
+  if (tree == NULL)
+  {
+    hoku_ast_free(ast);
+    mrb_raise(mrb, E_RUNTIME_ERROR, "Cannot allocate ast");
+  }
+
+  tree->root = ast;
+  tree->refs = 0;
+  mrb_value root = hp_ast_wrap(mrb, tree, ast);
+  if (hp_ast_retaining) hp_ast_shared_set(type, template, tree);
+
+  return root;
+}
+
+mrb_value hp_ast_set_retain(mrb_state* mrb, mrb_value self)
+{
+  mrb_bool retain;
+  mrb_get_args(mrb, "b", &retain);
+
+  hp_ast_retain(retain);
+  return mrb_bool_value(retain);
+}
+
+mrb_value hp_ast_stats(mrb_state* mrb, mrb_value self)
+{
+  hoku_parse_stats stats = hoku_parse_stats_get();
+  mrb_value hash = mrb_hash_new(mrb);
+
+  mrb_hash_set(mrb, hash, mrb_symbol_value(mrb_intern_lit(mrb, "parses")), mrb_int_value(mrb, (mrb_int) stats.parses));
+  mrb_hash_set(mrb, hash, mrb_symbol_value(mrb_intern_lit(mrb, "incremental")), mrb_int_value(mrb, (mrb_int) stats.incremental));
+  mrb_hash_set(mrb, hash, mrb_symbol_value(mrb_intern_lit(mrb, "shared")), mrb_int_value(mrb, (mrb_int) hp_ast_shared_hits));
+  mrb_hash_set(mrb, hash, mrb_symbol_value(mrb_intern_lit(mrb, "bytes")), mrb_int_value(mrb, (mrb_int) stats.bytes));
+  mrb_hash_set(mrb, hash, mrb_symbol_value(mrb_intern_lit(mrb, "parse_ms")), mrb_float_value(mrb, stats.parse_ms));
+  mrb_hash_set(mrb, hash, mrb_symbol_value(mrb_intern_lit(mrb, "arena_chunks")), mrb_int_value(mrb, (mrb_int) stats.arena_chunks));
+  mrb_hash_set(mrb, hash, mrb_symbol_value(mrb_intern_lit(mrb, "arena_bytes")), mrb_int_value(mrb, (mrb_int) stats.arena_bytes));
+
+  return hash;
 }
 
 void mrb_define_hokusai_ast_class(mrb_state* mrb)
 {
   struct RClass* module = mrb_module_get(mrb, "Hokusai");
   struct RClass* ast_class = mrb_define_class_under(mrb, module, "Ast", mrb->object_class);
+  MRB_SET_INSTANCE_TT(ast_class, MRB_TT_DATA);
   mrb_define_class_method(mrb, ast_class, "parse", hp_ast_megaparse, MRB_ARGS_REQ(2));
+  mrb_define_class_method(mrb, ast_class, "stats", hp_ast_stats, MRB_ARGS_NONE());
+  mrb_define_class_method(mrb, ast_class, "retain=", hp_ast_set_retain, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, ast_class, "native?", hp_ast_native_p, MRB_ARGS_NONE());
+  mrb_define_method(mrb, ast_class, "native_type", hp_ast_native_type, MRB_ARGS_NONE());
+  mrb_define_method(mrb, ast_class, "native_id", hp_ast_native_id, MRB_ARGS_NONE());
+  mrb_define_method(mrb, ast_class, "native_classes", hp_ast_native_classes, MRB_ARGS_NONE());
+  mrb_define_method(mrb, ast_class, "native_style_list", hp_ast_native_style_list, MRB_ARGS_NONE());
+  mrb_define_method(mrb, ast_class, "native_if", hp_ast_native_if, MRB_ARGS_NONE());
+  mrb_define_method(mrb, ast_class, "native_loop", hp_ast_native_loop, MRB_ARGS_NONE());
+  mrb_define_method(mrb, ast_class, "native_props", hp_ast_native_props, MRB_ARGS_NONE());
+  mrb_define_method(mrb, ast_class, "native_events", hp_ast_native_events, MRB_ARGS_NONE());
+  mrb_define_method(mrb, ast_class, "native_children", hp_ast_native_children, MRB_ARGS_NONE());
+  mrb_define_method(mrb, ast_class, "native_siblings", hp_ast_native_siblings, MRB_ARGS_NONE());
+  mrb_define_method(mrb, ast_class, "native_else_ast", hp_ast_native_else_ast, MRB_ARGS_NONE());
   /* remove all this crap */
 }
 
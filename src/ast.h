@@ -9,9 +9,18 @@
 #include <mruby/variable.h>
 #include <mruby/string.h>
 #include <mruby/array.h>
+#include <mruby/error.h>
 #include "core-hml.h"
+#include "template_cache.h"
 #include "hashmap.h"
 
+/**
+  While on, the calling thread keeps every template type's last tree:
+  an unchanged template reuses it and a changed one is re-parsed incrementally (see hoku_parser_retain).
+  Hot reload turns it on.
+*/
+void hp_ast_retain(bool retain);
+
 /**
   defines Hokusai::Ast and related methods
   @param mrb the mrb vm
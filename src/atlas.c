@@ -0,0 +1,140 @@
+#ifndef HOKUSAI_POCKET_ATLAS
+#define HOKUSAI_POCKET_ATLAS
+
+#include "atlas.h"
+
+int hp_atlas_init(hp_atlas** atlas)
+{
+  hp_atlas* init = malloc(sizeof(hp_atlas));
+  if (init == NULL) return -1;
+
+  init->pages = NULL;
+  init->page_len = 0;
+  init->page_cap = 0;
+  init->loaded = 0;
+  init->resident_bytes = 0;
+  *atlas = init;
+
+  return 0;
+}
+
+bool hp_atlas_accepts(int width, int height)
+{
+  return width > 0 && height > 0 && width <= HP_ATLAS_MAX_ENTRY && height <= HP_ATLAS_MAX_ENTRY;
+}
+
+static void hp_atlas_load_page(hp_atlas* atlas, hp_atlas_page* page)
+{
+  Image blank = GenImageColor(HP_ATLAS_PAGE_SIZE, HP_ATLAS_PAGE_SIZE, BLANK);
+  page->texture = LoadTextureFromImage(blank);
+  page->loaded = true;
+  page->live = 0;
+  UnloadImage(blank);
+
+  atlas->loaded++;
+  atlas->resident_bytes += HP_ATLAS_PAGE_BYTES;
+}
+
+static void hp_atlas_unload_page(hp_atlas* atlas, hp_atlas_page* page)
+{
+  UnloadTexture(page->texture);
+  hoku_atlas_reset(page->packer);
+  page->loaded = false;
+  page->live = 0;
+
+  atlas->loaded--;
+  atlas->resident_bytes -= HP_ATLAS_PAGE_BYTES;
+}
+
+/* a slot with a loaded, empty page: an unloaded slot if there is one, otherwise a new one */
+static int hp_atlas_add_page(hp_atlas* atlas)
+{
+  for (int i=0; i<atlas->page_len; i++)
+  {
+    if (!atlas->pages[i].loaded)
+    {
+      hp_atlas_load_page(atlas, &atlas->pages[i]);
+      return i;
+    }
+  }
+
+  if (atlas->page_len == atlas->page_cap)
+  {
+    int cap = atlas->page_cap == 0 ? 4 : atlas->page_cap * 2;
+    hp_atlas_page* pages = realloc(atlas->pages, sizeof(hp_atlas_page) * cap);
+    if (pages == NULL) return -1;
+
+    atlas->pages = pages;
+    atlas->page_cap = cap;
+  }
+
+  hp_atlas_page* page = &atlas->pages[atlas->page_len];
+  if (hoku_atlas_init(&page->packer, HP_ATLAS_PAGE_SIZE, HP_ATLAS_PAGE_SIZE, HP_ATLAS_PADDING) != 0) return -1;
+
+  hp_atlas_load_page(atlas, page);
+  return atlas->page_len++;
+}
+
+int hp_atlas_insert(hp_atlas* atlas, Image* image, hp_atlas_region* region)
+{
+  if (!hp_atlas_accepts(image->width, image->height)) return -1;
+
+  int x;
+  int y;
+  int page = -1;
+
+  for (int i=0; i<atlas->page_len; i++)
+  {
+    if (atlas->pages[i].loaded && hoku_atlas_pack(atlas->pages[i].packer, image->width, image->height, &x, &y) == 0)
+    {
+      page = i;
+      break;
+    }
+  }
+
+  if (page == -1)
+  {
+    page = hp_atlas_add_page(atlas);
+    if (page == -1) return -1;
+    if (hoku_atlas_pack(atlas->pages[page].packer, image->width, image->height, &x, &y) != 0)
+    {
+      hp_atlas_unload_page(atlas, &atlas->pages[page]);
+      return -1;
+    }
+  }
+
+  Rectangle source = { (float)x, (float)y, (float)image->width, (float)image->height };
+  ImageFormat(image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+  UpdateTextureRec(atlas->pages[page].texture, source, image->data);
+
+  atlas->pages[page].live++;
+  region->page = page;
+  region->source = source;
+
+  return 0;
+}
+
+Texture hp_atlas_texture(hp_atlas* atlas, int page)
+{
+  return atlas->pages[page].texture;
+}
+
+void hp_atlas_release(hp_atlas* atlas, int page)
+{
+  hp_atlas_page* entry = &atlas->pages[page];
+  if (--entry->live <= 0) hp_atlas_unload_page(atlas, entry);
+}
+
+void hp_atlas_free(hp_atlas* atlas)
+{
+  for (int i=0; i<atlas->page_len; i++)
+  {
+    if (atlas->pages[i].loaded) UnloadTexture(atlas->pages[i].texture);
+    hoku_atlas_free(atlas->pages[i].packer);
+  }
+
+  free(atlas->pages);
+  free(atlas);
+}
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef HOKUSAI_POCKET_ATLAS_H
+#define HOKUSAI_POCKET_ATLAS_H
+
+#include <raylib.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include "core-atlas.h"
+
+#define HP_ATLAS_PAGE_SIZE 1024
+#define HP_ATLAS_MAX_ENTRY 128
+#define HP_ATLAS_PADDING 1
+
+// RGBA
+#define HP_ATLAS_PAGE_BYTES ((size_t)HP_ATLAS_PAGE_SIZE * HP_ATLAS_PAGE_SIZE * 4)
+
+/**
+  A page slot, its texture is only loaded while it holds regions
+*/
+typedef struct HpAtlasPage
+{
+  hoku_atlas* packer;
+  Texture texture;
+  bool loaded;
+  int live;
+} hp_atlas_page;
+
+/**
+  Shared GPU pages that small images are packed into,
+  so consecutive draws of them stay on one texture (and one batch).
+  `resident_bytes` is what the loaded pages hold on the GPU, however full they are.
+*/
+typedef struct HpAtlas
+{
+  hp_atlas_page* pages;
+  int page_len;
+  int page_cap;
+  int loaded;
+  size_t resident_bytes;
+} hp_atlas;
+
+typedef struct HpAtlasRegion
+{
+  int page;
+  Rectangle source;
+} hp_atlas_region;
+
+int hp_atlas_init(hp_atlas** atlas);
+
+/**
+  Whether an image of this size should be packed
+  instead of getting a texture of its own
+*/
+bool hp_atlas_accepts(int width, int height);
+
+/**
+  Uploads an image into the first loaded page with room,
+  loading a page (into an empty slot if there is one) when none has any.
+  The image is converted to R8G8B8A8 in place.
+  @param atlas the atlas
+  @param image the (already resized) image
+  @param region out param for the page and source rect
+  @return 0 on success, -1 on failure
+*/
+int hp_atlas_insert(hp_atlas* atlas, Image* image, hp_atlas_region* region);
+Texture hp_atlas_texture(hp_atlas* atlas, int page);
+
+/**
+  Drops one region from a page.
+  Once a page holds no regions its texture is unloaded and the slot reused by a later insert
+*/
+void hp_atlas_release(hp_atlas* atlas, int page);
+void hp_atlas_free(hp_atlas* atlas);
+
+#endif
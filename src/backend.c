@@ -2,7 +2,7 @@
 #define HOKUSAI_POCKET_BACKEND
 
 #include "backend.h"
-// #include "monotonic_timer.h"
+#include "monotonic_timer.h"
 
 // SHADER_UNIFORM_FLOAT = 0      # Shader uniform type: float
 // SHADER_UNIFORM_VEC2 = 1       # Shader uniform type: vec2 (2 float)
@@ -50,28 +50,10 @@ uint64_t font_hash(const void* item, uint64_t seed0, uint64_t seed1)
 	return hashmap_sip(font->key, strlen(font->key), seed0, seed1);
 }
 
-void texture_free(void* payload)
-{
-  texture_cache* texture = (texture_cache*)payload;
-  free(texture->key);
-}
-
-int texture_compare(const void* a, const void* b, void* udata)
-{
-	const texture_cache* prop_a = (texture_cache*) a;
-	const texture_cache* prop_b = (texture_cache*) b;
-	return strcmp(prop_a->key, prop_b->key);
-}
-
-uint64_t texture_hash(const void* item, uint64_t seed0, uint64_t seed1)
-{
-	texture_cache* texture = (texture_cache*) item;
-	return hashmap_sip(texture->key, strlen(texture->key), seed0, seed1);
-}
-
 void shader_free(void* payload)
 {
   shader_cache* shader = (shader_cache*)payload;
+  hp_shader_program_free(shader->program);
   UnloadShader(shader->payload);
   free(shader->key);
 }
@@ -111,6 +93,14 @@ Color raylib_color(mrb_state* mrb, mrb_value command, char* type)
 }
 
 static int hp_current_scissor[5] = {0, 0, 0, 0, 0};
+// mirrored into the render pool, which suspends the scissor test to clear a reused texture
+static void hp_scissor_active(bool active)
+{
+  hp_render_pool* pool = hp_render_pool_get();
+  if (pool) pool->scissor = active;
+}
+// origin of the layer being rendered, scissor rects are relative to it
+static int hp_scissor_offset[2] = {0, 0};
 
 bool inside_scissor(float x, float y, float h)
 {
@@ -144,7 +134,7 @@ mrb_value on_draw_circle(mrb_state* mrb, mrb_value self)
   if (!inside_scissor(x, y, radius)) return mrb_nil_value();
   
   Color rcolor = raylib_color(mrb, command, "color");
-  DrawCircle(x, y, radius, rcolor);
+  hp_draw_circle((Vector2){x, y}, radius, rcolor);
   return mrb_nil_value();
 }
 
@@ -180,14 +170,14 @@ mrb_value on_draw_rect(mrb_state* mrb, mrb_value self)
   if (!inside_scissori(x, y, h)) return mrb_nil_value();
 
   Color rcolor = raylib_color(mrb, command, "color");  
+  Rectangle rect = {x, y, w, h};
   if (rounding > 0.0)
   {
-    Rectangle rect = {x, y, w, h};
-    DrawRectangleRounded(rect, rounding, 50, rcolor);
+    hp_draw_rect_rounded(rect, rounding, rcolor);
   }
   else
   {
-    DrawRectangle(x, y, w, h, rcolor);
+    hp_draw_rect(rect, rcolor);
   }
 
   if (has_outline)
@@ -195,18 +185,17 @@ mrb_value on_draw_rect(mrb_state* mrb, mrb_value self)
     bool outline_uniform = mrb_bool(mrb_funcall_argv(mrb, command, mrb_intern_lit(mrb, "outline_uniform?"), 0, NULL));
     mrb_value outline = mrb_funcall_argv(mrb, command, mrb_intern_lit(mrb, "outline"), 0, NULL);
     Color outline_color = raylib_color(mrb, command, "outline_color");
-    Rectangle rect = {x, y, w, h};
 
     if (outline_uniform && outline_color.a > 0)
     {
       float top = mrb_float(mrb_funcall_argv(mrb, outline, mrb_intern_lit(mrb, "top"), 0, NULL));
       if (rounding > 0.0)
       {
-        DrawRectangleRoundedLinesEx(rect, rounding, 50, top, outline_color);
+        hp_draw_rect_rounded_outline(rect, rounding, top, outline_color);
       }
       else
       {
-        DrawRectangleLinesEx(rect, top, outline_color);
+        hp_draw_rect_outline(rect, top, outline_color);
       }
     }
     else if (outline_color.a > 0)
@@ -216,31 +205,64 @@ mrb_value on_draw_rect(mrb_state* mrb, mrb_value self)
       float bottom = mrb_float(mrb_funcall_argv(mrb, outline, mrb_intern_lit(mrb, "bottom"), 0, NULL));
       float left = mrb_float(mrb_funcall_argv(mrb, outline, mrb_intern_lit(mrb, "left"), 0, NULL));
 
-      if (top > 0)
-      {
-        DrawLineEx((Vector2){x, y}, (Vector2){x + w, y}, top, outline_color);
-      }
-      
-      if (left > 0)
-      {
-        DrawLineEx((Vector2){x, y}, (Vector2){x, y + h}, left, outline_color);
-      }
-
-      if (right > 0)
-      {
-        DrawLineEx((Vector2){x + w, y}, (Vector2){x + w, y + h}, right, outline_color);
-      }
-
-      if (bottom > 0)
-      {
-        DrawLineEx((Vector2){x, y + h}, (Vector2){x + w, y + h}, bottom, outline_color);
-      }
+      hp_draw_rect_sides(rect, top, right, bottom, left, outline_color);
     }
   }
 
   return mrb_nil_value();
 }
 
+static const char* hp_sdf_fragment_330 =
+  "#version 330\n"
+  "in vec2 fragTexCoord;\n"
+  "in vec4 fragColor;\n"
+  "uniform sampler2D texture0;\n"
+  "out vec4 finalColor;\n"
+  "void main()\n"
+  "{\n"
+  "  float distance = texture(texture0, fragTexCoord).a - 0.5;\n"
+  "  float change = length(vec2(dFdx(distance), dFdy(distance)));\n"
+  "  finalColor = vec4(fragColor.rgb, fragColor.a * smoothstep(-change, change, distance));\n"
+  "}\n";
+
+static const char* hp_sdf_fragment_100 =
+  "#version 100\n"
+  "#extension GL_OES_standard_derivatives : enable\n"
+  "precision mediump float;\n"
+  "varying vec2 fragTexCoord;\n"
+  "varying vec4 fragColor;\n"
+  "uniform sampler2D texture0;\n"
+  "void main()\n"
+  "{\n"
+  "  float distance = texture2D(texture0, fragTexCoord).a - 0.5;\n"
+  "  float change = length(vec2(dFdx(distance), dFdy(distance)));\n"
+  "  gl_FragColor = vec4(fragColor.rgb, fragColor.a * smoothstep(-change, change, distance));\n"
+  "}\n";
+
+/**
+  Switches to the SDF shader for an SDF font,
+  unless the app has a shader of its own open
+  @return whether hp_sdf_end needs to be called
+*/
+static bool hp_sdf_begin(hp_font_wrapper* wrapper)
+{
+  if (!hp_font_sdf(wrapper) || shader_depth > 0) return false;
+
+  if (sdf_shader.id == 0)
+  {
+    bool es = rlGetVersion() == RL_OPENGL_ES_20 || rlGetVersion() == RL_OPENGL_ES_30;
+    sdf_shader = LoadShaderFromMemory(NULL, es ? hp_sdf_fragment_100 : hp_sdf_fragment_330);
+  }
+
+  BeginShaderMode(sdf_shader);
+  return true;
+}
+
+static void hp_sdf_end(bool begun)
+{
+  if (begun) EndShaderMode();
+}
+
 mrb_value on_draw_text(mrb_state* mrb, mrb_value self)
 {
   mrb_value command;
@@ -282,7 +304,37 @@ mrb_value on_draw_text(mrb_state* mrb, mrb_value self)
   Color rcolor = raylib_color(mrb, command, "color");
   Vector2 vec2 = {x, y};
 
+  hp_font_prepare(wrapper, str, strlen(str));
+  bool sdf = hp_sdf_begin(wrapper);
   DrawTextEx(wrapper->font, str, vec2, size, 1.0, rcolor);
+  hp_sdf_end(sdf);
+  return mrb_nil_value();
+}
+
+mrb_value on_draw_glyph_run(mrb_state* mrb, mrb_value self)
+{
+  mrb_value command;
+  mrb_get_args(mrb, "o", &command);
+
+  hp_font_wrapper* wrapper = hp_font_get(mrb, mrb_funcall_argv(mrb, command, mrb_intern_lit(mrb, "font"), 0, NULL));
+  mrb_value glyphs = mrb_funcall_argv(mrb, command, mrb_intern_lit(mrb, "glyphs"), 0, NULL);
+  int size = mrb_int(mrb, mrb_float_to_integer(mrb, mrb_funcall_argv(mrb, command, mrb_intern_lit(mrb, "size"), 0, NULL)));
+  hp_handle_error(mrb);
+
+  Color rcolor = raylib_color(mrb, command, "color");
+  hp_font_glyph* glyph = (hp_font_glyph*) RSTRING_PTR(glyphs);
+  mrb_int len = RSTRING_LEN(glyphs) / sizeof(hp_font_glyph);
+  bool sdf = hp_sdf_begin(wrapper);
+
+  for (mrb_int i=0; i<len; i++, glyph++)
+  {
+    if (!inside_scissori((int) glyph->x, (int) glyph->y, size)) continue;
+
+    DrawTextCodepoint(wrapper->font, glyph->codepoint, (Vector2){ glyph->x, glyph->y }, size, rcolor);
+  }
+
+  hp_sdf_end(sdf);
+
   return mrb_nil_value();
 }
 
@@ -303,13 +355,14 @@ mrb_value on_draw_scissor_begin(mrb_state* mrb, mrb_value self)
   int height = mrb_int(mrb, mrb_float_to_integer(mrb, mrb_funcall_argv(mrb, command, mrb_intern_lit(mrb, "height"), 0, NULL)));
   hp_handle_error(mrb);
 
-  BeginScissorMode(x, y, width, height);
+  BeginScissorMode(x - hp_scissor_offset[0], y - hp_scissor_offset[1], width, height);
 
   hp_current_scissor[0] = x;
   hp_current_scissor[1] = y;
   hp_current_scissor[2] = width;
   hp_current_scissor[3] = height;
   hp_current_scissor[4] = 1;
+  hp_scissor_active(true);
 
   return mrb_nil_value();
 }
@@ -323,6 +376,7 @@ mrb_value on_draw_scissor_end(mrb_state* mrb, mrb_value self)
   hp_current_scissor[2] = 0;
   hp_current_scissor[3] = 0;
   hp_current_scissor[4] = 0;
+  hp_scissor_active(false);
 
   return mrb_nil_value();
 }
@@ -332,8 +386,6 @@ mrb_value on_draw_image(mrb_state* mrb, mrb_value self)
   mrb_value command;
   mrb_get_args(mrb, "o", &command);
   
-  Texture tex;
-  
   mrb_value image = mrb_funcall(mrb, command, "image", 0, NULL);
   // hp_image_wrapper* wrapper = hp_image_get(mrb, image);
 
@@ -360,30 +412,46 @@ mrb_value on_draw_image(mrb_state* mrb, mrb_value self)
 
   int len = strlen(oid) + 100;
   char hash[len];
-  sprintf(hash, "%s-%d-%d", oid, width, height);
-  const texture_cache* result = hashmap_get(textures, &(texture_cache){ .key=hash });
-  if (result == NULL)
+  // sliced images keep their source size, so they never share an entry with a resized one
+  sprintf(hash, "%s-%d-%d%s", oid, width, height, mrb_nil_p(slice) ? "" : "-s");
+  hp_texture_cache_entry* entry = hp_image_loader_pending(image_loader, hash) ? NULL : hp_texture_cache_get(textures, hash);
+  if (entry == NULL)
   {
-    mrb_value copy = mrb_funcall(mrb, image, "copy", 0, NULL);
-    hp_image_wrapper* iwrapper = hp_image_get(mrb, copy);
-    if (mrb_nil_p(slice))
+    hp_image_wrapper* iwrapper = hp_image_get(mrb, image);
+
+    // resize off the render thread, the upload happens in a later frame
+    if (!hp_image_loader_pending(image_loader, hash))
     {
-      ImageResize(&(iwrapper->image), width, height);
+      Image copy = ImageCopy(iwrapper->image);
+      if (hp_image_loader_queue(image_loader, hash, oid, copy, width, height, mrb_nil_p(slice)) != 0)
+      {
+        if (mrb_nil_p(slice)) ImageResize(&copy, width, height);
+        // small images share atlas pages so runs of them draw from one texture
+        entry = hp_texture_cache_put(textures, hash, &copy, mrb_nil_p(slice));
+        UnloadImage(copy);
+      }
     }
-    Texture texture = LoadTextureFromImage(iwrapper->image);
-    GenTextureMipmaps(&texture);
-    hashmap_set(textures, &(texture_cache){.key=strdup(hash), .payload=texture });
 
-    tex = texture;
-  }
-  else
-  {
-    tex = result->payload;
+    if (entry == NULL)
+    {
+      // meanwhile stretch the last size we had of this image, or hold its place
+      hp_texture_cache_entry* previous = hp_image_loader_fallback(image_loader, oid);
+      if (previous && mrb_nil_p(slice))
+      {
+        DrawTexturePro(previous->texture, previous->source, (Rectangle){x, y, width, height}, (Vector2){0, 0}, 0.0f, WHITE);
+      }
+      else
+      {
+        DrawRectangle(x, y, width, height, HP_IMAGE_PLACEHOLDER);
+      }
+
+      return mrb_nil_value();
+    }
   }
 
   if (mrb_nil_p(slice))
   {
-    DrawTexture(tex, x, y, WHITE);
+    DrawTextureRec(entry->texture, entry->source, (Vector2){x, y}, WHITE);
   }
   else
   {
@@ -392,7 +460,7 @@ mrb_value on_draw_image(mrb_state* mrb, mrb_value self)
     int sw = mrb_int(mrb, mrb_float_to_integer(mrb, mrb_funcall(mrb, slice, "width", 0, NULL)));
     int sh = mrb_int(mrb, mrb_float_to_integer(mrb, mrb_funcall(mrb, slice, "height", 0, NULL)));
 
-    DrawTextureRec(tex, (Rectangle){sx, sy, sw, sh}, (Vector2){x, y}, WHITE);
+    DrawTextureRec(entry->texture, (Rectangle){sx, sy, sw, sh}, (Vector2){x, y}, WHITE);
 
   }
   return mrb_nil_value();
@@ -400,98 +468,68 @@ mrb_value on_draw_image(mrb_state* mrb, mrb_value self)
 
 int on_shader_texture_foreach(mrb_state* mrb, mrb_value key, mrb_value value, void* data)
 {
-  Shader shad = *((Shader*)data);
+  hp_shader_program* program = (hp_shader_program*)data;
   const char* ckey = mrb_string_cstr(mrb, key);
   hp_texture_wrapper* wrapper = hp_texture_get(mrb, value);
 
-  int location = GetShaderLocation(shad, ckey);
-  SetShaderValueTexture(shad, location, wrapper->texture.texture);
+  int location = hp_shader_program_location(program, ckey);
+  SetShaderValueTexture(program->shader, location, wrapper->texture.texture);
   return 0;
 }
 
 int on_shader_uniform_foreach(mrb_state* mrb, mrb_value key, mrb_value value, void* data)
 {
-  Shader shad = *((Shader*)data);
+  hp_shader_program* program = (hp_shader_program*)data;
   int type = mrb_int(mrb, mrb_ary_entry(value, 1));
   const char* ckey = mrb_string_cstr(mrb, key);
-  int location = GetShaderLocation(shad, ckey);
   mrb_value vec = mrb_ary_entry(value, 0);
   hp_handle_error(mrb);
 
-  if (type == 0)
-  {
-    // value 0 is a float
-    float values = mrb_float(vec);
-    SetShaderValue(shad, location, &values, type);
-    return 0;
-  }
-  else if (type == 4)
-  {
-    // value 0 is an int
-    int values = mrb_int(mrb, vec);
-    SetShaderValue(shad, location, &values, type);
-    return 0;
-  }
-  else if (type == 8)
+  int components = hp_shader_uniform_components(type);
+  if (components == 0)
   {
+    // uints
     mrb_raise(mrb, E_ARGUMENT_ERROR, "Sorry, cannot do uint at this time for shader.");
     return 1;
   }
-  else
+
+  // value 0 is a single number, or an array for vectors
+  mrb_int len = 1;
+  const mrb_value* entries = &vec;
+  if (mrb_array_p(vec))
   {
-    // value 0 is an array...
-    int len = mrb_int(mrb, mrb_funcall_argv(mrb, vec, mrb_intern_lit(mrb, "size"), 0, NULL));
+    len = RARRAY_LEN(vec);
+    entries = RARRAY_PTR(vec);
+  }
 
-    if (type < 4)
-    {
-      // floats
-      float values[len];
-      for (int i=0; i<len; i++)
-      {
-        values[i] = mrb_float(mrb_ary_entry(vec, i));
-      }
+  union
+  {
+    float f[HP_SHADER_UNIFORM_MAX_COMPONENTS];
+    int i[HP_SHADER_UNIFORM_MAX_COMPONENTS];
+  } values = {0};
 
-      SetShaderValue(shad, location, values, type);
-    }
-    else if (type < 8)
+  for (int i=0; i<components && i<len; i++)
+  {
+    if (type < SHADER_UNIFORM_INT)
     {
-      // ints
-      int values[len];
-      for (int i=0; i<len; i++)
-      {
-        values[i] = mrb_int(mrb, mrb_ary_entry(vec, i));
-      }
-      
-      SetShaderValue(shad, location, values, type);
+      values.f[i] = mrb_float(entries[i]);
     }
     else
     {
-      // uints
-      mrb_raise(mrb, E_ARGUMENT_ERROR, "Sorry, cannot do uint at this time for shader.");
-      return 1;
+      values.i[i] = mrb_int(mrb, entries[i]);
     }
-
-    return 0;
   }
+
+  hp_shader_program_set(program, ckey, type, &values);
+  return 0;
 }
 
-mrb_value on_draw_shader_begin(mrb_state* mrb, mrb_value self)
+/**
+  The cached program for these sources, compiled on first use.
+  Either source may be nil for raylib's default.
+*/
+hp_shader_program* hp_backend_shader(mrb_state* mrb, mrb_value vertex_shader, mrb_value fragment_shader, bool precompile)
 {
-  mrb_value command;
-  mrb_get_args(mrb, "o", &command);
-
-  mrb_value fragment_shader = mrb_funcall_argv(mrb, command, mrb_intern_lit(mrb, "fragment_shader"), 0, NULL);
-  // hp_handle_error(mrb);
-
-  mrb_value vertex_shader = mrb_funcall_argv(mrb, command, mrb_intern_lit(mrb, "vertex_shader"), 0, NULL);
-  // hp_handle_error(mrb);
-
-  mrb_value uniforms = mrb_funcall_argv(mrb, command, mrb_intern_lit(mrb, "uniforms"), 0, NULL);
-
-  mrb_value textures = mrb_funcall(mrb, command, "textures", 0, NULL);
-  hp_handle_error(mrb);
-
-  Shader shad;
   int len = 0;
   char* fs = "";
   char* vs = "";
@@ -514,29 +552,110 @@ mrb_value on_draw_shader_begin(mrb_state* mrb, mrb_value self)
 
   char hash[len + 20];
   sprintf(hash, "%s-%s", fs, vs);
-  
+
   const shader_cache* result = hashmap_get(shaders, &(shader_cache){ .key=hash });
-  if (result == NULL)
+  if (result != NULL) return result->program;
+
+  double start = monotonic_seconds();
+  Shader shader = LoadShaderFromMemory(v, f);
+  double ms = (monotonic_seconds() - start) * 1000.0;
+
+  shader_stats.compiled++;
+  shader_stats.compile_ms += ms;
+  if (precompile)
   {
-    Shader shader = LoadShaderFromMemory(v, f);
-    hashmap_set(shaders, &(shader_cache){ .key=strdup(hash), .payload=shader});
-    shad = shader;
+    shader_stats.precompiled++;
+    shader_stats.precompile_ms += ms;
   }
   else
   {
-    shad = result->payload;
+    shader_stats.frame_compiled++;
+    shader_stats.frame_ms += ms;
   }
 
-  mrb_hash_foreach(mrb, RHASH(uniforms), on_shader_uniform_foreach, &shad);
-  BeginShaderMode(shad);
-  mrb_hash_foreach(mrb, RHASH(textures), on_shader_texture_foreach, &shad);
+  hp_shader_program* program = hp_shader_program_init(shader);
+  if (program == NULL)
+  {
+    UnloadShader(shader);
+    mrb_raise(mrb, E_STANDARD_ERROR, "Cannot allocate shader uniforms");
+  }
+
+  hashmap_set(shaders, &(shader_cache){ .key=strdup(hash), .payload=shader, .program=program });
+  return program;
+}
+
+mrb_value on_draw_shader_begin(mrb_state* mrb, mrb_value self)
+{
+  mrb_value command;
+  mrb_get_args(mrb, "o", &command);
+
+  mrb_value fragment_shader = mrb_funcall_argv(mrb, command, mrb_intern_lit(mrb, "fragment_shader"), 0, NULL);
+  // hp_handle_error(mrb);
+
+  mrb_value vertex_shader = mrb_funcall_argv(mrb, command, mrb_intern_lit(mrb, "vertex_shader"), 0, NULL);
+  // hp_handle_error(mrb);
+
+  mrb_value uniforms = mrb_funcall_argv(mrb, command, mrb_intern_lit(mrb, "uniforms"), 0, NULL);
+
+  mrb_value textures = mrb_funcall(mrb, command, "textures", 0, NULL);
+  hp_handle_error(mrb);
+
+  hp_shader_program* program = hp_backend_shader(mrb, vertex_shader, fragment_shader, false);
+
+  // only uniforms that changed since the last draw with this shader are sent
+  mrb_hash_foreach(mrb, RHASH(uniforms), on_shader_uniform_foreach, program);
+  hp_shader_program_upload(program);
+  BeginShaderMode(program->shader);
+  shader_depth++;
+  mrb_hash_foreach(mrb, RHASH(textures), on_shader_texture_foreach, program);
 
   return mrb_nil_value();
 }
 
+mrb_value on_precompile_shader(mrb_state* mrb, mrb_value self)
+{
+  mrb_value vertex_shader;
+  mrb_value fragment_shader;
+  mrb_get_args(mrb, "oo", &vertex_shader, &fragment_shader);
+
+  hp_shader_program* program = hp_backend_shader(mrb, vertex_shader, fragment_shader, true);
+  return mrb_bool_value(program->shader.id != rlGetShaderIdDefault());
+}
+
+mrb_value on_shader_stats(mrb_state* mrb, mrb_value self)
+{
+  mrb_value stats = mrb_hash_new(mrb);
+  uint64_t uploads = 0;
+  uint64_t skipped = 0;
+  size_t iter = 0;
+  void* item;
+
+  if (shaders != NULL)
+  {
+    while (hashmap_iter(shaders, &iter, &item))
+    {
+      const shader_cache* shader = item;
+      uploads += shader->program->uploads;
+      skipped += shader->program->skipped;
+    }
+  }
+
+  mrb_hash_set(mrb, stats, mrb_symbol_value(mrb_intern_lit(mrb, "compiled")), mrb_int_value(mrb, (mrb_int)shader_stats.compiled));
+  mrb_hash_set(mrb, stats, mrb_symbol_value(mrb_intern_lit(mrb, "compile_ms")), mrb_float_value(mrb, shader_stats.compile_ms));
+  mrb_hash_set(mrb, stats, mrb_symbol_value(mrb_intern_lit(mrb, "precompiled")), mrb_int_value(mrb, shader_stats.precompiled));
+  mrb_hash_set(mrb, stats, mrb_symbol_value(mrb_intern_lit(mrb, "precompile_ms")), mrb_float_value(mrb, shader_stats.precompile_ms));
+  mrb_hash_set(mrb, stats, mrb_symbol_value(mrb_intern_lit(mrb, "compiles_last_frame")), mrb_int_value(mrb, shader_stats.last_compiled));
+  mrb_hash_set(mrb, stats, mrb_symbol_value(mrb_intern_lit(mrb, "compile_ms_last_frame")), mrb_float_value(mrb, shader_stats.last_ms));
+  mrb_hash_set(mrb, stats, mrb_symbol_value(mrb_intern_lit(mrb, "uniform_uploads")), mrb_int_value(mrb, (mrb_int)uploads));
+  mrb_hash_set(mrb, stats, mrb_symbol_value(mrb_intern_lit(mrb, "uniform_uploads_skipped")), mrb_int_value(mrb, (mrb_int)skipped));
+
+  return stats;
+}
+
 mrb_value on_draw_shader_end(mrb_state* mrb, mrb_value self)
 {
   EndShaderMode();
+  if (shader_depth > 0) shader_depth--;
 
   return mrb_nil_value();
 }
@@ -552,6 +671,7 @@ mrb_value on_draw_rotation_begin(mrb_state* mrb, mrb_value self)
   hp_handle_error(mrb);
 
   rlPushMatrix();
+  transform_depth++;
   rlTranslatef(x, y, 0);
   rlRotatef(degrees, 0, 0, 1);
 
@@ -561,6 +681,7 @@ mrb_value on_draw_rotation_begin(mrb_state* mrb, mrb_value self)
 mrb_value on_draw_rotation_end(mrb_state* mrb, mrb_value self)
 {
   rlPopMatrix();
+  if (transform_depth > 0) transform_depth--;
   return mrb_nil_value();
 }
 
@@ -574,6 +695,7 @@ mrb_value on_draw_translation_begin(mrb_state* mrb, mrb_value self)
   hp_handle_error(mrb);
 
   rlPushMatrix();
+  transform_depth++;
   rlTranslatef(x, y, 0);
 
   return mrb_nil_value();
@@ -582,6 +704,7 @@ mrb_value on_draw_translation_begin(mrb_state* mrb, mrb_value self)
 mrb_value on_draw_translation_end(mrb_state* mrb, mrb_value self)
 {
   rlPopMatrix();
+  if (transform_depth > 0) transform_depth--;
   return mrb_nil_value();
 }
 
@@ -594,6 +717,7 @@ mrb_value on_draw_scale_begin(mrb_state* mrb, mrb_value self)
   float y = mrb_float(mrb_funcall_argv(mrb, command, mrb_intern_lit(mrb,"y"), 0, NULL));
 
   rlPushMatrix();
+  transform_depth++;
   rlScalef(x, y, 0.0);
   
   return mrb_nil_value();
@@ -602,6 +726,7 @@ mrb_value on_draw_scale_begin(mrb_state* mrb, mrb_value self)
 mrb_value on_draw_scale_end(mrb_state* mrb, mrb_value self)
 {
   rlPopMatrix();
+  if (transform_depth > 0) transform_depth--;
   return mrb_nil_value();
 }
 
@@ -653,7 +778,10 @@ mrb_value on_draw_texture(mrb_state* mrb, mrb_value self)
   mrb_get_args(mrb, "o", &command);
 
   mrb_value texture = mrb_funcall_argv(mrb, command, mrb_intern_lit(mrb, "texture"), 0, NULL);
-  hp_texture_wrapper* wrapper = hp_texture_get(mrb, texture);
+  hp_texture_wrapper* wrapper = hp_texture_peek(mrb, texture);
+
+  // still queued, so nothing has been drawn into it yet
+  if (!wrapper->ready) return mrb_nil_value();
 
   float x = mrb_float(mrb_funcall_argv(mrb, command, mrb_intern_lit(mrb, "x"), 0, NULL));
   hp_handle_error(mrb);
@@ -666,6 +794,7 @@ mrb_value on_draw_texture(mrb_state* mrb, mrb_value self)
   float rotation = mrb_float(mrb_funcall_argv(mrb, command, mrb_intern_lit(mrb, "rotation"), 0, NULL));
   bool flip = mrb_bool(mrb_funcall(mrb, command, "flip", 0, NULL));
   bool repeat = mrb_bool(mrb_funcall(mrb, command, "repeat", 0, NULL));
+  bool premultiplied = mrb_bool(mrb_funcall(mrb, command, "premultiplied", 0, NULL));
 
   hp_handle_error(mrb);
 
@@ -688,7 +817,9 @@ mrb_value on_draw_texture(mrb_state* mrb, mrb_value self)
   Rectangle dest = (Rectangle){ x, y, width, height};
 
   SetTextureFilter(wrapper->texture.texture, TEXTURE_FILTER_BILINEAR);
+  if (premultiplied) BeginBlendMode(BLEND_ALPHA_PREMULTIPLY);
   DrawTexturePro(wrapper->texture.texture, source, dest, (Vector2){ 0, 0 }, rotation, WHITE);
+  if (premultiplied) EndBlendMode();
   return mrb_nil_value();
 }
 
@@ -848,6 +979,83 @@ mrb_value on_save_file(mrb_state* mrb, mrb_value self)
   }
 }
 
+// renders a layer's commands into its texture, with (x, y) as the texture's origin.
+// the active scissor is suspended meanwhile and restored for the rest of the frame.
+// inside another texture mode or transform, switching targets would lose the outer ones,
+// so nothing is recorded and the layer draws directly until it can be
+mrb_value on_render_layer(mrb_state* mrb, mrb_value self)
+{
+  mrb_value texture;
+  mrb_value commands;
+  mrb_float x;
+  mrb_float y;
+  mrb_get_args(mrb, "oAff", &texture, &commands, &x, &y);
+  if (hp_texture_mode_active() || transform_depth > 0) return mrb_false_value();
+
+  hp_texture_wrapper* wrapper = hp_texture_get(mrb, texture);
+
+  int scissor[5];
+  memcpy(scissor, hp_current_scissor, sizeof(scissor));
+  if (scissor[4]) EndScissorMode();
+  hp_current_scissor[4] = 0;
+  hp_scissor_active(false);
+  hp_scissor_offset[0] = (int)x;
+  hp_scissor_offset[1] = (int)y;
+
+  hp_texture_mode_begin(wrapper->texture);
+  ClearBackground((Color){0, 0, 0, 0});
+  // keep the texture premultiplied so translucent edges composite like direct draws
+  rlSetBlendFactorsSeparate(RL_SRC_ALPHA, RL_ONE_MINUS_SRC_ALPHA, RL_ONE, RL_ONE_MINUS_SRC_ALPHA, RL_FUNC_ADD, RL_FUNC_ADD);
+  BeginBlendMode(BLEND_CUSTOM_SEPARATE);
+  rlPushMatrix();
+  rlTranslatef(-x, -y, 0);
+
+  mrb_int len = RARRAY_LEN(commands);
+  for (int i=0; i<len; i++)
+  {
+    mrb_funcall(mrb, mrb_ary_entry(commands, i), "draw", 0, NULL);
+    if (mrb->exc) break;
+  }
+
+  rlPopMatrix();
+  EndBlendMode();
+  hp_texture_mode_end();
+  wrapper->generation++;
+
+  hp_scissor_offset[0] = 0;
+  hp_scissor_offset[1] = 0;
+  memcpy(hp_current_scissor, scissor, sizeof(scissor));
+  if (scissor[4]) BeginScissorMode(scissor[0], scissor[1], scissor[2], scissor[3]);
+  hp_scissor_active(scissor[4]);
+
+  hp_handle_error(mrb);
+  return mrb_true_value();
+}
+
+mrb_value on_texture_stats(mrb_state* mrb, mrb_value self)
+{
+  mrb_value stats = mrb_hash_new(mrb);
+  if (textures == NULL) return stats;
+
+  mrb_hash_set(mrb, stats, mrb_symbol_value(mrb_intern_lit(mrb, "hits")), mrb_int_value(mrb, (mrb_int)textures->hits));
+  mrb_hash_set(mrb, stats, mrb_symbol_value(mrb_intern_lit(mrb, "misses")), mrb_int_value(mrb, (mrb_int)textures->misses));
+  mrb_hash_set(mrb, stats, mrb_symbol_value(mrb_intern_lit(mrb, "evictions")), mrb_int_value(mrb, (mrb_int)textures->evictions));
+  mrb_hash_set(mrb, stats, mrb_symbol_value(mrb_intern_lit(mrb, "resident_bytes")), mrb_int_value(mrb, (mrb_int)textures->resident_bytes));
+  mrb_hash_set(mrb, stats, mrb_symbol_value(mrb_intern_lit(mrb, "budget")), mrb_int_value(mrb, (mrb_int)textures->budget));
+  mrb_hash_set(mrb, stats, mrb_symbol_value(mrb_intern_lit(mrb, "entries")), mrb_int_value(mrb, (mrb_int)hp_texture_cache_count(textures)));
+  mrb_hash_set(mrb, stats, mrb_symbol_value(mrb_intern_lit(mrb, "atlas_pages")), mrb_int_value(mrb, textures->atlas->loaded));
+
+  hp_upload_queue* uploads = hp_upload_queue_get();
+  if (uploads == NULL) return stats;
+
+  mrb_hash_set(mrb, stats, mrb_symbol_value(mrb_intern_lit(mrb, "uploads_queued")), mrb_int_value(mrb, uploads->len));
+  mrb_hash_set(mrb, stats, mrb_symbol_value(mrb_intern_lit(mrb, "uploads_last_frame")), mrb_int_value(mrb, uploads->last_uploads));
+  mrb_hash_set(mrb, stats, mrb_symbol_value(mrb_intern_lit(mrb, "upload_bytes_last_frame")), mrb_int_value(mrb, (mrb_int)uploads->last_bytes));
+  mrb_hash_set(mrb, stats, mrb_symbol_value(mrb_intern_lit(mrb, "upload_ms_last_frame")), mrb_float_value(mrb, uploads->last_ms));
+
+  return stats;
+}
+
 void hp_backend_render_callbacks(mrb_state* mrb, struct RClass* module)
 {
   /* Top level callbacks */
@@ -860,6 +1068,18 @@ void hp_backend_render_callbacks(mrb_state* mrb, struct RClass* module)
   struct RProc* can_render_proc = mrb_proc_new_cfunc(mrb, on_can_render);
   mrb_funcall_with_block(mrb, mrb_obj_value(module), mrb_intern_lit(mrb, "on_can_render"), 0, NULL, mrb_obj_value(can_render_proc));
 
+  struct RProc* texture_stats_proc = mrb_proc_new_cfunc(mrb, on_texture_stats);
+  mrb_funcall_with_block(mrb, mrb_obj_value(module), mrb_intern_lit(mrb, "on_texture_stats"), 0, NULL, mrb_obj_value(texture_stats_proc));
+
+  struct RProc* shader_stats_proc = mrb_proc_new_cfunc(mrb, on_shader_stats);
+  mrb_funcall_with_block(mrb, mrb_obj_value(module), mrb_intern_lit(mrb, "on_shader_stats"), 0, NULL, mrb_obj_value(shader_stats_proc));
+
+  struct RProc* precompile_shader_proc = mrb_proc_new_cfunc(mrb, on_precompile_shader);
+  mrb_funcall_with_block(mrb, mrb_obj_value(module), mrb_intern_lit(mrb, "on_precompile_shader"), 0, NULL, mrb_obj_value(precompile_shader_proc));
+
+  struct RProc* render_layer_proc = mrb_proc_new_cfunc(mrb, on_render_layer);
+  mrb_funcall_with_block(mrb, mrb_obj_value(module), mrb_intern_lit(mrb, "on_render_layer"), 0, NULL, mrb_obj_value(render_layer_proc));
+
   struct RProc* window_resize_proc = mrb_proc_new_cfunc(mrb, on_resize_window);
   mrb_funcall_with_block(mrb, mrb_obj_value(module), mrb_intern_lit(mrb, "on_resize_window"), 0, NULL, mrb_obj_value(window_resize_proc));
 
@@ -884,6 +1104,10 @@ void hp_backend_render_callbacks(mrb_state* mrb, struct RClass* module)
   struct RProc* text_proc = mrb_proc_new_cfunc(mrb, on_draw_text);
   mrb_funcall_with_block(mrb, mrb_obj_value(text_class), mrb_intern_lit(mrb, "on_draw"), 0, NULL, mrb_obj_value(text_proc));
 
+  struct RClass* glyph_run_class = mrb_class_get_under(mrb, com_class, "GlyphRun");
+  struct RProc* glyph_run_proc = mrb_proc_new_cfunc(mrb, on_draw_glyph_run);
+  mrb_funcall_with_block(mrb, mrb_obj_value(glyph_run_class), mrb_intern_lit(mrb, "on_draw"), 0, NULL, mrb_obj_value(glyph_run_proc));
+
   struct RClass* scissor_begin_class = mrb_class_get_under(mrb, com_class, "ScissorBegin");
   struct RProc* scissor_begin_proc = mrb_proc_new_cfunc(mrb, on_draw_scissor_begin);
   mrb_funcall_with_block(mrb, mrb_obj_value(scissor_begin_class), mrb_intern_lit(mrb, "on_draw"), 0, NULL, mrb_obj_value(scissor_begin_proc));
@@ -1106,12 +1330,26 @@ void hp_process_input(mrb_state* mrb, mrb_value input, bool use_touch)
 
 int hp_backend_run(mrb_state* mrb, struct RClass* hokusai_module, mrb_value backend)
 {
-  textures = hashmap_new(sizeof(texture_cache), 0, 0, 0, texture_hash, texture_compare, texture_free, NULL);
   shaders = hashmap_new(sizeof(shader_cache), 0, 0, 0, shader_hash, shader_compare, shader_free, NULL);
   // glue setup glue
   mrb_value config = mrb_funcall_argv(mrb, backend, mrb_intern_lit(mrb, "config"), 0, NULL);
   if (mrb->exc) mrb_print_error(mrb);
 
+  mrb_value texture_budget = mrb_funcall(mrb, config, "texture_budget", 0, NULL);
+  hp_texture_cache_init(&textures, mrb_nil_p(texture_budget) ? HP_TEXTURE_CACHE_DEFAULT_BUDGET : (size_t)mrb_int(mrb, texture_budget));
+
+  hp_image_loader_init(&image_loader, textures);
+
+  mrb_value upload_ms = mrb_funcall(mrb, config, "upload_budget_ms", 0, NULL);
+  mrb_value upload_bytes = mrb_funcall(mrb, config, "upload_budget_bytes", 0, NULL);
+  hp_upload_queue_init(
+    mrb_nil_p(upload_ms) ? HP_UPLOAD_DEFAULT_BUDGET_MS : mrb_as_float(mrb, upload_ms),
+    mrb_nil_p(upload_bytes) ? HP_UPLOAD_DEFAULT_BUDGET_BYTES : (size_t)mrb_int(mrb, upload_bytes)
+  );
+
+  mrb_value pool_budget = mrb_funcall(mrb, config, "render_texture_pool_budget", 0, NULL);
+  hp_render_pool_init(mrb_nil_p(pool_budget) ? HP_RENDER_POOL_DEFAULT_BUDGET : (size_t)mrb_int(mrb, pool_budget));
+
   mrb_value on_reload = mrb_funcall(mrb, config, "on_reload_proc", 0, NULL);
   mrb_value app = mrb_funcall_argv(mrb, backend, mrb_intern_lit(mrb, "app"), 0, NULL);
   if (mrb->exc) mrb_print_error(mrb);
@@ -1158,8 +1396,15 @@ int hp_backend_run(mrb_state* mrb, struct RClass* hokusai_module, mrb_value back
     InitAudioDevice();
   }
 
+  // keep every template's tree, so a reload only re-parses what was edited
+  hp_ast_retain(!mrb_nil_p(on_reload));
   mrb_value block = mrb_funcall_argv(mrb, app, mrb_intern_lit(mrb, "mount"), 0, NULL);
 
+  // compile the shaders the app's blocks declare before the first frame
+  mrb_value shader_registry = mrb_funcall(mrb, mrb_obj_value(hokusai_module), "shaders", 0, NULL);
+  mrb_funcall(mrb, shader_registry, "warm", 1, app);
+  if (mrb->exc) mrb_print_error(mrb);
+
   mrb_value after_load_proc = mrb_funcall_argv(mrb, config, mrb_intern_lit(mrb, "after_load_cb"), 0, NULL);
   if(!mrb_nil_p(after_load_proc)) mrb_funcall_argv(mrb, after_load_proc, mrb_intern_lit(mrb, "call"), 0, NULL);
   // SetTraceLogLevel(LOG_ERROR); 
@@ -1179,6 +1424,15 @@ int hp_backend_run(mrb_state* mrb, struct RClass* hokusai_module, mrb_value back
       EnableEventWaiting();
     }
     
+    hp_texture_cache_begin_frame(textures);
+    // resizes that finished since the last frame join the upload queue before it runs
+    hp_image_loader_poll(image_loader);
+    hp_upload_queue_run(hp_upload_queue_get());
+
+    shader_stats.last_compiled = shader_stats.frame_compiled;
+    shader_stats.last_ms = shader_stats.frame_ms;
+    shader_stats.frame_compiled = 0;
+    shader_stats.frame_ms = 0.0;
     BeginDrawing();
       // manage hot reload
       if (!mrb_nil_p(on_reload))
@@ -1194,6 +1448,7 @@ int hp_backend_run(mrb_state* mrb, struct RClass* hokusai_module, mrb_value back
           {
             mrb_funcall(mrb, mrb_obj_value(hokusai_module), "copy_state", 2, block, new_block);
             block = new_block;
+            mrb_funcall(mrb, mrb_funcall(mrb, mrb_obj_value(hokusai_module), "shaders", 0, NULL), "warm", 1, app);
           }
         }
       }
@@ -1243,8 +1498,16 @@ int hp_backend_run(mrb_state* mrb, struct RClass* hokusai_module, mrb_value back
   }
 
   if (audio) CloseAudioDevice();
-  hashmap_free(textures);
+  hp_upload_queue_free();
+  hp_render_pool_free();
+  hp_image_loader_free(image_loader);
+  image_loader = NULL;
+  hp_texture_cache_free(textures);
+  textures = NULL;
   hashmap_free(shaders);
+  if (sdf_shader.id != 0) UnloadShader(sdf_shader);
+  hp_ast_retain(false);
+  hoku_parser_release();
   return 0;
 }
 #endif
\ No newline at end of file
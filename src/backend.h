@@ -12,27 +12,29 @@
 #include <rlgl.h>
 #include "ast.h"
 #include "style.h"
+#include "template_cache.h"
 #include "error.h"
 #include "font.h"
 #include "texture.h"
 #include "image.h"
 #include "music.h"
+#include "json.h"
+#include "piece_table.h"
+#include "cache.h"
+#include "loader.h"
+#include "primitives.h"
+#include "shader.h"
 #include "mruby-uv/loop.h"
 
 /**
  * 
  *  Declare caches
  */
-typedef struct TextureCache
-{
-  char* key;
-  Texture payload;
-} texture_cache;
-
 typedef struct ShaderCache
 {
   char* key;
   Shader payload;
+  hp_shader_program* program;
 } shader_cache;
 
 typedef struct FontCache
@@ -49,8 +51,18 @@ typedef struct MeasureCache
 } measure_cache;
 
 // static char default_chars[122] = "\x1b– —‘’“”…\r\n\t0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ!@#$%%^&*(),.?/\\[]-_=+|~`{}<>;:\"'";
-static struct hashmap* textures = NULL;
+static hp_texture_cache* textures = NULL;
+static hp_image_loader* image_loader = NULL;
 static struct hashmap* shaders = NULL;
+static hp_shader_stats shader_stats = {0};
+// the built-in shader SDF fonts draw with, compiled on first use
+static Shader sdf_shader = {0};
+// how many ShaderBegin commands are open
+static int shader_depth = 0;
+// how many rotation, scale and translation commands are open
+static int transform_depth = 0;
+
+#define HP_IMAGE_PLACEHOLDER (Color){ 200, 200, 200, 64 }
 
 enum HP_TOUCH_EXTENSIONS
 {
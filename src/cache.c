@@ -0,0 +1,312 @@
+#ifndef HOKUSAI_POCKET_CACHE
+#define HOKUSAI_POCKET_CACHE
+
+#include "cache.h"
+
+typedef struct HpTextureCacheItem
+{
+  char* key;
+  hp_texture_cache_entry* entry;
+} hp_texture_cache_item;
+
+static int hp_texture_cache_compare(const void* a, const void* b, void* udata)
+{
+  const hp_texture_cache_item* item_a = (hp_texture_cache_item*) a;
+  const hp_texture_cache_item* item_b = (hp_texture_cache_item*) b;
+  return strcmp(item_a->key, item_b->key);
+}
+
+static uint64_t hp_texture_cache_hash(const void* item, uint64_t seed0, uint64_t seed1)
+{
+  const hp_texture_cache_item* cache_item = (hp_texture_cache_item*) item;
+  return hashmap_sip(cache_item->key, strlen(cache_item->key), seed0, seed1);
+}
+
+static size_t hp_texture_bytes(Texture texture)
+{
+  size_t bytes = 0;
+  int width = texture.width;
+  int height = texture.height;
+
+  for (int i=0; i<(texture.mipmaps > 0 ? texture.mipmaps : 1); i++)
+  {
+    bytes += GetPixelDataSize(width, height, texture.format);
+    width = width > 1 ? width / 2 : 1;
+    height = height > 1 ? height / 2 : 1;
+  }
+
+  return bytes;
+}
+
+int hp_texture_cache_init(hp_texture_cache** cache, size_t budget)
+{
+  hp_texture_cache* init = malloc(sizeof(hp_texture_cache));
+  if (init == NULL) return -1;
+
+  init->map = hashmap_new(sizeof(hp_texture_cache_item), 0, 0, 0, hp_texture_cache_hash, hp_texture_cache_compare, NULL, NULL);
+  if (init->map == NULL)
+  {
+    free(init);
+    return -1;
+  }
+
+  if (hp_atlas_init(&init->atlas) != 0)
+  {
+    hashmap_free(init->map);
+    free(init);
+    return -1;
+  }
+
+  init->head = NULL;
+  init->tail = NULL;
+  init->budget = budget;
+  init->resident_bytes = 0;
+  init->frame = 0;
+  init->hits = 0;
+  init->misses = 0;
+  init->evictions = 0;
+  *cache = init;
+
+  return 0;
+}
+
+void hp_texture_cache_begin_frame(hp_texture_cache* cache)
+{
+  cache->frame++;
+}
+
+static void hp_texture_cache_unlink(hp_texture_cache* cache, hp_texture_cache_entry* entry)
+{
+  if (entry->prev) entry->prev->next = entry->next;
+  else cache->head = entry->next;
+
+  if (entry->next) entry->next->prev = entry->prev;
+  else cache->tail = entry->prev;
+
+  entry->prev = NULL;
+  entry->next = NULL;
+}
+
+static void hp_texture_cache_push_front(hp_texture_cache* cache, hp_texture_cache_entry* entry)
+{
+  entry->prev = NULL;
+  entry->next = cache->head;
+  if (cache->head) cache->head->prev = entry;
+  cache->head = entry;
+  if (cache->tail == NULL) cache->tail = entry;
+}
+
+/*
+  resident_bytes counts standalone textures and whole atlas pages,
+  an atlased entry only changes it when its page is loaded or unloaded
+*/
+static void hp_texture_cache_release(hp_texture_cache* cache, hp_texture_cache_entry* entry)
+{
+  if (entry->atlased)
+  {
+    size_t pages = cache->atlas->resident_bytes;
+    hp_atlas_release(cache->atlas, entry->page);
+    cache->resident_bytes -= pages - cache->atlas->resident_bytes;
+  }
+  else
+  {
+    UnloadTexture(entry->texture);
+    cache->resident_bytes -= entry->bytes;
+  }
+
+  free(entry->key);
+  free(entry);
+}
+
+static void hp_texture_cache_drop(hp_texture_cache* cache, hp_texture_cache_entry* entry)
+{
+  hp_texture_cache_unlink(cache, entry);
+  hashmap_delete(cache->map, &(hp_texture_cache_item){ .key=entry->key });
+  hp_texture_cache_release(cache, entry);
+  cache->evictions++;
+}
+
+/* whether any region on page was drawn this frame */
+static bool hp_texture_cache_page_drawn(hp_texture_cache* cache, int page)
+{
+  for (hp_texture_cache_entry* entry = cache->head; entry; entry = entry->next)
+  {
+    if (entry->atlased && entry->page == page && entry->last_frame == cache->frame) return true;
+  }
+
+  return false;
+}
+
+/* evicts every region on page, which unloads it */
+static void hp_texture_cache_evict_page(hp_texture_cache* cache, int page)
+{
+  hp_texture_cache_entry* entry = cache->head;
+
+  while (entry)
+  {
+    hp_texture_cache_entry* next = entry->next;
+    if (entry->atlased && entry->page == page) hp_texture_cache_drop(cache, entry);
+    entry = next;
+  }
+}
+
+/*
+  Least recently used first.
+  A region only frees memory with the rest of its page,
+  so the page goes as a whole, unless something on it was drawn this frame.
+*/
+static void hp_texture_cache_evict(hp_texture_cache* cache, size_t incoming)
+{
+  hp_texture_cache_entry* entry = cache->tail;
+
+  while (entry && cache->resident_bytes + incoming > cache->budget)
+  {
+    // everything newer than this was drawn this frame too
+    if (entry->last_frame == cache->frame) break;
+
+    if (!entry->atlased)
+    {
+      hp_texture_cache_entry* prev = entry->prev;
+      hp_texture_cache_drop(cache, entry);
+      entry = prev;
+    }
+    else if (hp_texture_cache_page_drawn(cache, entry->page))
+    {
+      entry = entry->prev;
+    }
+    else
+    {
+      // the page's other regions may sit anywhere in the list
+      hp_texture_cache_evict_page(cache, entry->page);
+      entry = cache->tail;
+    }
+  }
+}
+
+hp_texture_cache_entry* hp_texture_cache_get(hp_texture_cache* cache, const char* key)
+{
+  hp_texture_cache_entry* entry = hp_texture_cache_peek(cache, key);
+  if (entry == NULL)
+  {
+    cache->misses++;
+    return NULL;
+  }
+
+  cache->hits++;
+  return entry;
+}
+
+bool hp_texture_cache_has(hp_texture_cache* cache, const char* key)
+{
+  return hashmap_get(cache->map, &(hp_texture_cache_item){ .key=(char*)key }) != NULL;
+}
+
+hp_texture_cache_entry* hp_texture_cache_peek(hp_texture_cache* cache, const char* key)
+{
+  const hp_texture_cache_item* item = hashmap_get(cache->map, &(hp_texture_cache_item){ .key=(char*)key });
+  if (item == NULL) return NULL;
+
+  hp_texture_cache_entry* entry = item->entry;
+  entry->last_frame = cache->frame;
+
+  if (cache->head != entry)
+  {
+    hp_texture_cache_unlink(cache, entry);
+    hp_texture_cache_push_front(cache, entry);
+  }
+
+  return entry;
+}
+
+hp_texture_cache_entry* hp_texture_cache_put(hp_texture_cache* cache, const char* key, Image* image, bool atlas)
+{
+  hp_texture_cache_entry* entry = malloc(sizeof(hp_texture_cache_entry));
+  if (entry == NULL) return NULL;
+
+  entry->key = strdup(key);
+  if (entry->key == NULL)
+  {
+    free(entry);
+    return NULL;
+  }
+
+  hp_atlas_region region;
+  size_t pages = cache->atlas->resident_bytes;
+
+  if (atlas && hp_atlas_insert(cache->atlas, image, &region) == 0)
+  {
+    entry->atlased = true;
+    entry->page = region.page;
+    entry->source = region.source;
+    entry->texture = hp_atlas_texture(cache->atlas, region.page);
+    entry->bytes = GetPixelDataSize(image->width, image->height, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    // a page loaded for this region counts whole
+    cache->resident_bytes += cache->atlas->resident_bytes - pages;
+  }
+  else
+  {
+    // estimate with a full mip chain (+1/3) before uploading
+    hp_texture_cache_evict(cache, GetPixelDataSize(image->width, image->height, image->format) * 4 / 3);
+
+    Texture texture = LoadTextureFromImage(*image);
+    GenTextureMipmaps(&texture);
+
+    entry->atlased = false;
+    entry->page = -1;
+    entry->source = (Rectangle){ 0, 0, texture.width, texture.height };
+    entry->texture = texture;
+    entry->bytes = hp_texture_bytes(texture);
+    cache->resident_bytes += entry->bytes;
+  }
+
+  entry->last_frame = cache->frame;
+  entry->prev = NULL;
+  entry->next = NULL;
+
+  // replace any stale entry under the same key
+  const hp_texture_cache_item* old = hashmap_get(cache->map, &(hp_texture_cache_item){ .key=entry->key });
+  if (old)
+  {
+    hp_texture_cache_entry* stale = old->entry;
+    hashmap_delete(cache->map, &(hp_texture_cache_item){ .key=entry->key });
+    hp_texture_cache_unlink(cache, stale);
+    hp_texture_cache_release(cache, stale);
+  }
+
+  hashmap_set(cache->map, &(hp_texture_cache_item){ .key=entry->key, .entry=entry });
+  hp_texture_cache_push_front(cache, entry);
+
+  // a new atlas page isn't known until the region is packed, the new entry itself is kept
+  if (entry->atlased) hp_texture_cache_evict(cache, 0);
+
+  return entry;
+}
+
+void hp_texture_cache_set_budget(hp_texture_cache* cache, size_t budget)
+{
+  cache->budget = budget;
+  hp_texture_cache_evict(cache, 0);
+}
+
+size_t hp_texture_cache_count(hp_texture_cache* cache)
+{
+  return hashmap_count(cache->map);
+}
+
+void hp_texture_cache_free(hp_texture_cache* cache)
+{
+  hp_texture_cache_entry* entry = cache->head;
+
+  while (entry)
+  {
+    hp_texture_cache_entry* next = entry->next;
+    hp_texture_cache_release(cache, entry);
+    entry = next;
+  }
+
+  hashmap_free(cache->map);
+  hp_atlas_free(cache->atlas);
+  free(cache);
+}
+
+#endif
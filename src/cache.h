@@ -0,0 +1,90 @@
+#ifndef HOKUSAI_POCKET_CACHE_H
+#define HOKUSAI_POCKET_CACHE_H
+
+#include <raylib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hashmap.h"
+#include "atlas.h"
+
+#define HP_TEXTURE_CACHE_DEFAULT_BUDGET (256 * 1024 * 1024)
+
+/**
+  A GPU texture owned by the cache, either standalone or a region of an atlas page.
+  Entries are linked most to least recently used.
+  For a region, `bytes` is its own share of the page.
+*/
+typedef struct HpTextureCacheEntry
+{
+  char* key;
+  Texture texture;
+  bool atlased;
+  int page;
+  Rectangle source;
+  size_t bytes;
+  uint64_t last_frame;
+  struct HpTextureCacheEntry* prev;
+  struct HpTextureCacheEntry* next;
+} hp_texture_cache_entry;
+
+/**
+  `resident_bytes` is what the cache holds on the GPU:
+  standalone textures plus every loaded atlas page, full or not
+*/
+typedef struct HpTextureCache
+{
+  struct hashmap* map;
+  hp_atlas* atlas;
+  hp_texture_cache_entry* head;
+  hp_texture_cache_entry* tail;
+  size_t budget;
+  size_t resident_bytes;
+  uint64_t frame;
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t evictions;
+} hp_texture_cache;
+
+int hp_texture_cache_init(hp_texture_cache** cache, size_t budget);
+
+/**
+  Marks the start of a frame.
+  Entries drawn during the current frame are never evicted,
+  since their draws may still be pending in the render batch.
+*/
+void hp_texture_cache_begin_frame(hp_texture_cache* cache);
+
+/**
+  Looks up an entry, counting the hit or miss and marking it as most recently used
+  @return the entry or NULL
+*/
+hp_texture_cache_entry* hp_texture_cache_get(hp_texture_cache* cache, const char* key);
+
+/**
+  Same as hp_texture_cache_get, without touching the hit/miss counters
+*/
+hp_texture_cache_entry* hp_texture_cache_peek(hp_texture_cache* cache, const char* key);
+
+/**
+  Whether key is resident, without touching the counters or the LRU order
+*/
+bool hp_texture_cache_has(hp_texture_cache* cache, const char* key);
+
+/**
+  Uploads an image and stores it under key, evicting least recently used
+  entries until the cache fits its budget.
+  @param cache the cache
+  @param key the cache key (copied)
+  @param image the image to upload (may be converted in place)
+  @param atlas whether the image may be packed into a shared atlas page
+  @return the new entry or NULL
+*/
+hp_texture_cache_entry* hp_texture_cache_put(hp_texture_cache* cache, const char* key, Image* image, bool atlas);
+
+void hp_texture_cache_set_budget(hp_texture_cache* cache, size_t budget);
+size_t hp_texture_cache_count(hp_texture_cache* cache);
+void hp_texture_cache_free(hp_texture_cache* cache);
+
+#endif
@@ -0,0 +1,179 @@
+#ifndef HOKU_CORE_ARENA
+#define HOKU_CORE_ARENA
+
+#include "core-arena.h"
+
+static hoku_arena_chunk* hoku_arena_chunk_new(size_t size)
+{
+	hoku_arena_chunk* chunk = malloc(sizeof(hoku_arena_chunk) + size);
+	if (chunk == NULL) return NULL;
+
+	chunk->next = NULL;
+	chunk->size = size;
+	chunk->used = 0;
+	return chunk;
+}
+
+int hoku_arena_init(hoku_arena** out, size_t chunk_size)
+{
+	hoku_arena* init = malloc(sizeof(hoku_arena));
+	if (init == NULL) return -1;
+
+	init->chunk_size = chunk_size < HOKU_ARENA_CHUNK ? HOKU_ARENA_CHUNK : chunk_size;
+	init->head = hoku_arena_chunk_new(init->chunk_size);
+	if (init->head == NULL)
+	{
+		free(init);
+		return -1;
+	}
+
+	init->chunks = 1;
+	init->bytes = 0;
+	init->interned = NULL;
+	init->interned_len = 0;
+	init->interned_cap = 0;
+	*out = init;
+	return 0;
+}
+
+static void* hoku_arena_bump(hoku_arena* arena, size_t size, size_t align)
+{
+	hoku_arena_chunk* chunk = arena->head;
+	size_t offset = (chunk->used + align - 1) & ~(align - 1);
+
+	if (offset > chunk->size || chunk->size - offset < size)
+	{
+		if (size > arena->chunk_size / 4)
+		{
+			// a chunk of its own, behind the current one
+			chunk = hoku_arena_chunk_new(size);
+			if (chunk == NULL) return NULL;
+
+			chunk->next = arena->head->next;
+			arena->head->next = chunk;
+		}
+		else
+		{
+			chunk = hoku_arena_chunk_new(arena->chunk_size);
+			if (chunk == NULL) return NULL;
+
+			chunk->next = arena->head;
+			arena->head = chunk;
+		}
+
+		arena->chunks++;
+		offset = 0;
+	}
+
+	chunk->used = offset + size;
+	arena->bytes += size;
+	return (char*) chunk->data + offset;
+}
+
+void* hoku_arena_alloc(hoku_arena* arena, size_t size)
+{
+	return hoku_arena_bump(arena, size == 0 ? 1 : size, _Alignof(max_align_t));
+}
+
+char* hoku_arena_strndup(hoku_arena* arena, const char* str, size_t len)
+{
+	// strings need no alignment, they pack back to back
+	char* init = hoku_arena_bump(arena, len + 1, 1);
+	if (init == NULL) return NULL;
+
+	memcpy(init, str, len);
+	init[len] = '\0';
+	return init;
+}
+
+char* hoku_arena_strdup(hoku_arena* arena, const char* str)
+{
+	return hoku_arena_strndup(arena, str, strlen(str));
+}
+
+static uint32_t hoku_arena_hash(const char* str, size_t len)
+{
+	// FNV-1a, names are short
+	uint32_t hash = 2166136261u;
+	for (size_t i = 0; i < len; i++)
+	{
+		hash ^= (unsigned char) str[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+static hoku_arena_string* hoku_arena_slot(hoku_arena_string* table, size_t cap, const char* str, size_t len, uint32_t hash)
+{
+	size_t i = hash & (cap - 1);
+	while (table[i].str != NULL)
+	{
+		if (table[i].hash == hash && table[i].len == len && memcmp(table[i].str, str, len) == 0) break;
+		i = (i + 1) & (cap - 1);
+	}
+	return &table[i];
+}
+
+// the table lives in the arena too, an outgrown one is left behind
+static int hoku_arena_intern_grow(hoku_arena* arena)
+{
+	size_t cap = arena->interned_cap == 0 ? HOKU_ARENA_INTERN_SLOTS : arena->interned_cap * 2;
+	hoku_arena_string* table = hoku_arena_alloc(arena, sizeof(hoku_arena_string) * cap);
+	if (table == NULL) return -1;
+	memset(table, 0, sizeof(hoku_arena_string) * cap);
+
+	for (size_t i = 0; i < arena->interned_cap; i++)
+	{
+		hoku_arena_string entry = arena->interned[i];
+		if (entry.str == NULL) continue;
+
+		*hoku_arena_slot(table, cap, entry.str, entry.len, entry.hash) = entry;
+	}
+
+	arena->interned = table;
+	arena->interned_cap = cap;
+	return 0;
+}
+
+char* hoku_arena_intern(hoku_arena* arena, const char* str, size_t len)
+{
+	if ((arena->interned_len + 1) * 2 > arena->interned_cap && hoku_arena_intern_grow(arena) == -1) return NULL;
+
+	uint32_t hash = hoku_arena_hash(str, len);
+	hoku_arena_string* slot = hoku_arena_slot(arena->interned, arena->interned_cap, str, len, hash);
+	if (slot->str != NULL) return slot->str;
+
+	char* copy = hoku_arena_strndup(arena, str, len);
+	if (copy == NULL) return NULL;
+
+	slot->str = copy;
+	slot->len = (uint32_t) len;
+	slot->hash = hash;
+	arena->interned_len++;
+	return copy;
+}
+
+char* hoku_arena_interned(hoku_arena* arena, const char* str)
+{
+	if (arena->interned_cap == 0) return NULL;
+
+	size_t len = strlen(str);
+	return hoku_arena_slot(arena->interned, arena->interned_cap, str, len, hoku_arena_hash(str, len))->str;
+}
+
+void hoku_arena_free(hoku_arena* arena)
+{
+	if (arena == NULL) return;
+
+	hoku_arena_chunk* chunk = arena->head;
+	while (chunk != NULL)
+	{
+		hoku_arena_chunk* next = chunk->next;
+		free(chunk);
+		chunk = next;
+	}
+
+	free(arena);
+}
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef HOKU_CORE_ARENA_H
+#define HOKU_CORE_ARENA_H
+
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// smallest chunk an arena asks malloc for
+#define HOKU_ARENA_CHUNK 8192
+// slots in an arena's first intern table, it doubles at half full
+#define HOKU_ARENA_INTERN_SLOTS 64
+
+typedef struct HokuArenaChunk
+{
+	struct HokuArenaChunk* next;
+	size_t size;
+	size_t used;
+	max_align_t data[];
+} hoku_arena_chunk;
+
+typedef struct HokuArenaString
+{
+	char* str;
+	uint32_t len;
+	uint32_t hash;
+} hoku_arena_string;
+
+/**
+  A bump allocator for data that is thrown away all at once,
+  like the trees built from a template.
+
+  Allocations are carved out of malloc'd chunks and are never freed one by one,
+  hoku_arena_free releases every chunk.
+  Requests bigger than a quarter chunk get a chunk of their own
+  so they don't strand the rest of the current one.
+
+  The arena also interns strings: equal strings interned in one arena
+  share a single copy, so their pointers can be compared instead of their bytes.
+*/
+typedef struct HokuArena
+{
+	hoku_arena_chunk* head;
+	size_t chunk_size;
+	size_t chunks;
+	size_t bytes;
+	hoku_arena_string* interned;
+	size_t interned_len;
+	size_t interned_cap;
+} hoku_arena;
+
+/**
+  @param chunk_size the size of the first chunk, at least HOKU_ARENA_CHUNK
+  @return 0 for success, -1 for error
+*/
+int hoku_arena_init(hoku_arena** out, size_t chunk_size);
+
+/**
+  @return size bytes aligned for any type, or NULL when malloc fails
+*/
+void* hoku_arena_alloc(hoku_arena* arena, size_t size);
+
+/**
+  Copies len bytes of str into the arena and null terminates them
+*/
+char* hoku_arena_strndup(hoku_arena* arena, const char* str, size_t len);
+char* hoku_arena_strdup(hoku_arena* arena, const char* str);
+
+/**
+  The arena's one copy of the len bytes at str, made on first use
+  @return a null terminated string, or NULL when allocation fails
+*/
+char* hoku_arena_intern(hoku_arena* arena, const char* str, size_t len);
+
+/**
+  Looks str up without interning it
+  @return the arena's copy of str, or NULL if it was never interned
+*/
+char* hoku_arena_interned(hoku_arena* arena, const char* str);
+
+void hoku_arena_free(hoku_arena* arena);
+
+#endif
@@ -3,249 +3,144 @@
 
 #include "core-ast.h"
 
-int hoku_ast_class_list_init(hoku_ast_class_list** out, char* name)
+/* room for one more item in an arena array, a full one is copied to one twice the size */
+static void* hoku_ast_grow(hoku_arena* arena, void* items, uint16_t len, uint16_t* cap, size_t size)
 {
-	hoku_ast_class_list* init = malloc(sizeof(hoku_ast_class_list));
-	if (init == NULL) return -1;
+	if (len < *cap) return items;
+	if (*cap >= UINT16_MAX / 2) return NULL;
 
-	init->name = strdup(name);
-	if (init->name == NULL)
-	{
-		free(init);
-		return -1;
-	}
+	uint16_t next = *cap == 0 ? HOKU_AST_INLINE : *cap * 2;
+	void* init = hoku_arena_alloc(arena, size * next);
+	if (init == NULL) return NULL;
 
-	init->next = NULL;
-	*out = init;
-	return 0;
+	if (len > 0) memcpy(init, items, size * len);
+	*cap = next;
+	return init;
 }
 
-void hoku_ast_class_list_free(hoku_ast_class_list* list)
+static int hoku_ast_names_append(hoku_arena* arena, hoku_ast_names* list, char* name)
 {
-	hoku_ast_class_list* head = list;
-	while (head != NULL)
-	{
-		hoku_ast_class_list* cpy = head->next;
-		free(head->name);
-		free(head);
-		head = cpy;
-	}
-}
-
-int hoku_ast_style_list_prepend(hoku_ast* ast, char* name)
-{
-	hoku_ast_class_list* init;
-	if (hoku_ast_class_list_init(&init, name) == -1) return -1;
-
-	if (ast->style_list == NULL)
-	{
-		ast->style_list = init;
-	}
-	else
-	{
-		init->next = ast->style_list;
-		ast->style_list = init;
-	}
+	char** names = hoku_ast_grow(arena, list->names, list->len, &list->cap, sizeof(char*));
+	if (names == NULL) return -1;
 
+	names[list->len++] = name;
+	list->names = names;
 	return 0;
 }
 
-int hoku_ast_class_list_prepend(hoku_ast* ast, char* name)
+int hoku_ast_style_list_append(hoku_ast* ast, char* name)
 {
-	hoku_ast_class_list* init;
-	if (hoku_ast_class_list_init(&init, name) == -1) return -1;
-
-	if (ast->class_list == NULL)
-	{
-		ast->class_list = init;
-	}
-	else
-	{
-		init->next = ast->class_list;
-		ast->class_list = init;
-	}
+	return hoku_ast_names_append(ast->arena, &ast->style_list, name);
+}
 
-	return 0;
+int hoku_ast_class_list_append(hoku_ast* ast, char* name)
+{
+	return hoku_ast_names_append(ast->arena, &ast->class_list, name);
 }
 
 bool hoku_ast_class_list_includes(hoku_ast* ast, char* name)
 {
-	hoku_ast_class_list* head = ast->class_list;
-	bool found = false;
-	while (head != NULL)
+	// a name the arena never interned is on no node of the tree
+	char* interned = hoku_arena_interned(ast->arena, name);
+	if (interned == NULL) return false;
+
+	for (uint16_t i = 0; i < ast->class_list.len; i++)
 	{
-		if (strcmp(head->name, name) == 0)
-		{
-			found = true;
-			break;
-		}
-		head = head->next;
+		if (ast->class_list.names[i] == interned) return true;
 	}
 
-	return found;
+	return false;
 }
 
-int hoku_ast_func_call_init(hoku_ast_func_call** call, char* name)
+int hoku_ast_func_call_init(hoku_ast_func_call** call, hoku_arena* arena, char* name)
 {
-	hoku_ast_func_call* init = malloc(sizeof(hoku_ast_func_call));
+	hoku_ast_func_call* init = hoku_arena_alloc(arena, sizeof(hoku_ast_func_call));
 	if (init == NULL) return -1;
 
-	// name should be null terminated.
-	init->function = strdup(name);
-	if (init->function == NULL)
-	{
-		free(init);
-		return -1;
-	}	
-
+	init->function = name;
 	init->args_len = 0;
 	init->args = NULL;
-	init->strargs = malloc(sizeof(char*) * 10);
-	// 10 arg buffer.
+	init->strargs = NULL;
 
 	*call = init;
 	return 0;
 }
 
-void hoku_ast_func_call_free(hoku_ast_func_call* init)
-{
-	for (int i=0; i<init->args_len; i++)
-	{
-		free(init->strargs[i]);
-	}
-  free(init->strargs);
-	free(init->function);
-	free(init);
-}
+/** props and events are short arrays matched by interned name, a later one replaces an earlier one of the same name
+*/
 
-int hoku_ast_event_init(hoku_ast_event** event, char* name)
+int hoku_ast_add_prop(hoku_ast* component, hoku_ast_prop* prop)
 {
-	hoku_ast_event* init = malloc(sizeof(hoku_ast_event));
-	if (init == NULL) return -1;
-
-	init->call = NULL;
-	init->name = strdup(name);
-	if (init->name == NULL)
+	for (uint16_t i = 0; i < component->props_len; i++)
 	{
-		free(init);
-		return -1;
+		if (component->props[i].name == prop->name)
+		{
+			component->props[i] = *prop;
+			return 0;
+		}
 	}
 
-	*event = init;
-	return 0;
-}
+	hoku_ast_prop* props = hoku_ast_grow(component->arena, component->props, component->props_len, &component->props_cap, sizeof(hoku_ast_prop));
+	if (props == NULL) return -1;
 
-void hoku_ast_event_free(void* payload)
-{
-	hoku_ast_event* event = (hoku_ast_event*)payload;
-	hoku_ast_func_call_free(event->call);
-	free(event->name);
+	props[component->props_len++] = *prop;
+	component->props = props;
+	return 0;
 }
 
-int hoku_ast_prop_init(hoku_ast_prop** prop, char* name)
+hoku_ast_prop* hoku_ast_get_prop(hoku_ast* component, hoku_ast_prop* prop)
 {
-	hoku_ast_prop* init = malloc(sizeof(hoku_ast_prop));
-	if (init == NULL) return -1;
+	char* name = hoku_arena_interned(component->arena, prop->name);
+	if (name == NULL) return NULL;
 
-	init->computed = false;
-	init->call = NULL;
-	init->name = strdup(name);
-	if (init->name == NULL)
+	for (uint16_t i = 0; i < component->props_len; i++)
 	{
-		free(init);
-		return -1;
+		if (component->props[i].name == name) return &component->props[i];
 	}
 
-	*prop = init;
-	return 0;
-}
-
-void hoku_ast_prop_free(void* payload)
-{
-	hoku_ast_prop* prop = (hoku_ast_prop*)payload;
-	hoku_ast_func_call_free(prop->call);
-	free(prop->name);
-}
-
-/** hashmap functions for props and events
-*/
-
-uint64_t hoku_ast_prop_hash(const void* item, uint64_t seed0, uint64_t seed1)
-{
-	hoku_ast_prop* prop = (hoku_ast_prop*) item;
-	return hashmap_sip(prop->name, strlen(prop->name), seed0, seed1);
-}
-
-uint64_t hoku_ast_event_hash(const void* item, uint64_t seed0, uint64_t seed1)
-{
-	hoku_ast_event* event = (hoku_ast_event*) item;
-	return hashmap_sip(event->name, strlen(event->name), seed0, seed1);
-}
-
-int hoku_ast_prop_compare(const void* a, const void* b, void* udata)
-{
-	const hoku_ast_prop* prop_a = (hoku_ast_prop*) a;
-	const hoku_ast_prop* prop_b = (hoku_ast_prop*) b;
-	return strcmp(prop_a->name, prop_b->name);
+	return NULL;
 }
 
-int hoku_ast_event_compare(const void* a, const void* b, void* udata)
+int hoku_ast_add_event(hoku_ast* component, hoku_ast_event* event)
 {
-	const hoku_ast_event* ea = (hoku_ast_event*) a;
-	const hoku_ast_event* eb = (hoku_ast_event*) b;
-	return strcmp(ea->name, eb->name);
-}
+	for (uint16_t i = 0; i < component->events_len; i++)
+	{
+		if (component->events[i].name == event->name)
+		{
+			component->events[i] = *event;
+			return 0;
+		}
+	}
 
-int hoku_ast_add_prop(hoku_ast* component, hoku_ast_prop* prop)
-{
-	hashmap_set(component->props, prop);
-	free(prop);
-	return 0;
-}
+	hoku_ast_event* events = hoku_ast_grow(component->arena, component->events, component->events_len, &component->events_cap, sizeof(hoku_ast_event));
+	if (events == NULL) return -1;
 
-hoku_ast_prop* hoku_ast_get_prop(hoku_ast* component, hoku_ast_prop* prop)
-{
-	return (hoku_ast_prop*)hashmap_get(component->props, prop);
-}
-
-int hoku_ast_add_event(hoku_ast* component, hoku_ast_event* event)
-{
-	hashmap_set(component->events, event);
-	free(event);
+	events[component->events_len++] = *event;
+	component->events = events;
 	return 0;
 }
 
 hoku_ast_event* hoku_ast_get_event(hoku_ast* component, hoku_ast_event* event)
 {
-	return (hoku_ast_event*) hashmap_get(component->events, event);
-}
-
-int hoku_ast_props_init(struct hashmap** props)
-{
-	struct hashmap* init = hashmap_new(sizeof(hoku_ast_prop), 0, 0, 0, hoku_ast_prop_hash, hoku_ast_prop_compare, hoku_ast_prop_free, NULL);
-	if (init == NULL) return -1;
+	char* name = hoku_arena_interned(component->arena, event->name);
+	if (name == NULL) return NULL;
 
-	*props = init;
-	return 0;
-}
-
-int hoku_ast_events_init(struct hashmap** events)
-{
-	struct hashmap* init = hashmap_new(sizeof(hoku_ast_event), 0, 0, 0, hoku_ast_event_hash, hoku_ast_event_compare, hoku_ast_event_free, NULL);
-	if (init == NULL) return -1;
+	for (uint16_t i = 0; i < component->events_len; i++)
+	{
+		if (component->events[i].name == name) return &component->events[i];
+	}
 
-	*events = init;
-	return 0;
+	return NULL;
 }
 
 int hoku_ast_events_count(hoku_ast* component)
 {
-	return hashmap_count(component->events);
+	return component->events_len;
 }
 
 int hoku_ast_props_count(hoku_ast* component)
 {
-	return hashmap_count(component->props);
+	return component->props_len;
 }
 
 int hoku_ast_prepend_sibling(hoku_ast** first, hoku_ast* second)
@@ -314,9 +209,9 @@ int hoku_ast_append_child(hoku_ast** parent, hoku_ast* child)
 	return 0;
 }
 
-int hoku_ast_cond_init(hoku_ast_condition** cond, hoku_ast_func_call* call)
+int hoku_ast_cond_init(hoku_ast_condition** cond, hoku_arena* arena, hoku_ast_func_call* call)
 {
-	hoku_ast_condition* init = malloc(sizeof(hoku_ast_condition));
+	hoku_ast_condition* init = hoku_arena_alloc(arena, sizeof(hoku_ast_condition));
 	if (init == NULL) return -1;
 
 	init->not = false;
@@ -325,71 +220,48 @@ int hoku_ast_cond_init(hoku_ast_condition** cond, hoku_ast_func_call* call)
 	return 0;
 }
 
-int hoku_ast_loop_init(hoku_ast_loop** loop, char* name, char* list_name)
+int hoku_ast_loop_init(hoku_ast_loop** loop, hoku_arena* arena, char* name, char* list_name)
 {
-	hoku_ast_loop* init = malloc(sizeof(hoku_ast_loop));
+	hoku_ast_loop* init = hoku_arena_alloc(arena, sizeof(hoku_ast_loop));
 	if (init == NULL) return -1;
-	init->name = strdup(name);
-	if (init->name == NULL)
-	{
-		free(init);
-		return -1;
-	}
-
-	init->list_name = strdup(list_name);
-	if (init->list_name == NULL)
-	{
-		free(init);
-		return -1;
-	}
 
+	init->name = name;
+	init->list_name = list_name;
 	*loop = init;
 	return 0;
 }
 
-int hoku_ast_init(hoku_ast** component, char* type)
+int hoku_ast_init(hoku_ast** component, hoku_arena* arena, char* type)
 {
-	hoku_ast* init = malloc(sizeof(hoku_ast));
+	hoku_ast* init = hoku_arena_alloc(arena, sizeof(hoku_ast));
 	if (init == NULL) return -1;
 
-	init->type = strdup(type);
-	if (init->type == NULL)
-	{
-		free(init);
-		return -1;
-	}
-
-	if (hoku_ast_props_init(&init->props) == -1)
-	{
-		free(init->type);
-		free(init);
-		return -1;
-	}
-
-	if (hoku_ast_events_init(&init->events) == -1)
-	{
-		hashmap_free(init->props);
-		free(init->type);
-		free(init);
-		return -1;
-	}
+	init->relations = hoku_arena_alloc(arena, sizeof(hoku_ast_list));
+	if (init->relations == NULL) return -1;
 
+	init->type = type;
 	init->child_len = 0;
 	init->id = NULL;
 	init->error = NULL;
 	init->styles = NULL;
-	init->style_list = NULL;
-	init->class_list = NULL;
+	init->style_list = (hoku_ast_names){0};
+	init->class_list = (hoku_ast_names){0};
 	init->has_slot = false;
 	init->cond = NULL;
 	init->loop = NULL;
+	init->props = NULL;
+	init->props_len = 0;
+	init->props_cap = 0;
+	init->events = NULL;
+	init->events_len = 0;
+	init->events_cap = 0;
 	init->parent = NULL;
-	init->relations = malloc(sizeof(hoku_ast_list));
 	init->relations->next_child = NULL;
 	init->relations->next_sibling = NULL;
 	init->else_relations = NULL;
 	init->else_active = false;
 	init->is_root = false;
+	init->arena = arena;
 	*component = init;
 
 	return 0;
@@ -399,8 +271,8 @@ int hoku_ast_set_error(hoku_ast* ast, char* error,  TSNode node, char* tag)
 {
 	char copy[600];
 	TSPoint start = ts_node_start_point(node);
-	sprintf(copy, "Error at row: %d col: %d - %s, got: \"%s\"\n", start.row, start.column, error, tag);
-	ast->error = strdup(copy);
+	snprintf(copy, sizeof(copy), "Error at row: %d col: %d - %s, got: \"%s\"\n", start.row, start.column, error, tag);
+	ast->error = hoku_arena_strdup(ast->arena, copy);
 	if (ast->error == NULL) return -1;
 	return 0;
 }
@@ -426,45 +298,8 @@ hoku_ast* hoku_errored_ast(hoku_ast* ast)
 	return NULL;
 }
 
-void hoku_ast_list_free(hoku_ast_list* list)
-{
-  if (list->next_sibling)
-  {
-    hoku_ast_free(list->next_sibling);
-  }
-
-  if (list->next_child)
-  {
-    hoku_ast_free(list->next_child);
-  }
-
-  free(list);
-}
-
 void hoku_ast_free(hoku_ast* component)
 {
-	hoku_ast_class_list_free(component->style_list);
-  hoku_ast_class_list_free(component->class_list);
-	hashmap_free(component->props);
-	hashmap_free(component->events);
-	free(component->type);
-	free(component->id);
-
-	if (component->cond) 
-	{
-		hoku_ast_func_call_free(component->cond->call);
-		free(component->cond);
-	}
-
-	if (component->loop)
-	{
-		free(component->loop->list_name);
-		free(component->loop->name);
-		free(component->loop);		
-	}
-
-	hoku_ast_list_free(component->relations);
-	if (component->else_relations) hoku_ast_list_free(component->else_relations);
-	free(component);
+	hoku_arena_free(component->arena);
 }
 #endif
@@ -4,12 +4,17 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <tree_sitter/api.h>
-#include "hashmap.h"
+#include "core-arena.h"
 #include "core-style.h"
 
 extern TSLanguage* tree_sitter_hml();
 
+// slots a node's prop, event, class or style array starts with, it doubles when full
+#define HOKU_AST_INLINE 4
+
 /** @struct HmlFuncCall
 * @brief represents a function call, used in events or props
 * @var function
@@ -95,11 +100,17 @@ typedef struct HmlAstList
   struct HmlAst* next_child;
 } hoku_ast_list;
 
-typedef struct HmlAstClassList
+/** @struct HmlAstNames
+* @brief class or style names of a component, in template order
+* @var names
+* interned names, compared by pointer
+*/
+typedef struct HmlAstNames
 {
-  char* name;
-  struct HmlAstClassList* next;
-} hoku_ast_class_list;
+  char** names;
+  uint16_t len;
+  uint16_t cap;
+} hoku_ast_names;
 
 /** @struct HmlAst
 * @brief a component tree
@@ -110,15 +121,18 @@ typedef struct HmlAstClassList
 * @var cond
 * a HmlCondition that decides if the component should be rendered
 * @var props
-* a hashmap of properties
+* an array of props_len properties, one per name, in template order
 * @var events
-* a hashmap of events
+* an array of events_len events, one per name, in template order
 * @var parent
 * the parent of this component
 * @var next_sibling
 * the next sibling of this component
 * @var next_child
 * the next child of this component
+* @var arena
+* the arena every node and string of this tree is allocated from,
+* names are interned in it
 */
 typedef struct HmlAst
 {
@@ -128,19 +142,33 @@ typedef struct HmlAst
   bool has_slot;
   int child_len;
   struct HmlStyle* styles;
-  struct HmlAstClassList* style_list;
-  struct HmlAstClassList* class_list;
+  hoku_ast_names style_list;
+  hoku_ast_names class_list;
   struct HmlAstCondition* cond;
   struct HmlAstLoop* loop;
-  struct hashmap* props;
-  struct hashmap* events;
+  struct HmlAstProp* props;
+  uint16_t props_len;
+  uint16_t props_cap;
+  struct HmlAstEvent* events;
+  uint16_t events_len;
+  uint16_t events_cap;
   struct HmlAst* parent;
   struct HmlAstList* relations;
   struct HmlAstList* else_relations;
   bool else_active;
   bool is_root;
+  struct HokuArena* arena;
 } hoku_ast;
 
+/**
+  Trees live in one hoku_arena, nodes, lists, calls and strings alike.
+  The init functions below allocate from the arena they are given
+  and keep the strings they are passed, which must come from that arena too.
+  Names (types, props, events, classes, styles) are interned in the arena,
+  so props, events and classes are matched by pointer.
+  Nothing is freed on its own, hoku_ast_free drops the whole tree.
+*/
+
 /**
   Marks this ast as errored
   @param ast the ast to error
@@ -157,20 +185,20 @@ int hoku_ast_set_error(hoku_ast* ast, char* error, TSNode node, char* template);
 hoku_ast* hoku_errored_ast(hoku_ast* ast);
 
 /**
-  Prepends an style name to the ast's style list
-  @param ast the ast to prepend to
-  @param name the style name to prepend
+  Appends an style name to the ast's style list
+  @param ast the ast to append to
+  @param name the style name, interned in the ast's arena
   @return 0 for success, -1 for error
 */
-int hoku_ast_style_list_prepend(hoku_ast* ast, char* name);
+int hoku_ast_style_list_append(hoku_ast* ast, char* name);
 
 /**
-  Prepends an class name to the ast's class list
-  @param ast the ast to prepend to
-  @param name the class name to prepend
+  Appends an class name to the ast's class list
+  @param ast the ast to append to
+  @param name the class name, interned in the ast's arena
   @return 0 for success, -1 for error
 */
-int hoku_ast_class_list_prepend(hoku_ast* ast, char* name);
+int hoku_ast_class_list_append(hoku_ast* ast, char* name);
 
 /**
   Does the ast include this class name?
@@ -220,9 +248,9 @@ int hoku_ast_prepend_child(hoku_ast** parent, hoku_ast* child);
 int hoku_ast_props_count(hoku_ast* component);
 
 /**
-  Adds a prop to this ast node
+  Copies a prop into this ast node, replacing a prop of the same name
   @param component the target ast
-  @param prop the prop to add
+  @param prop the prop to add, its name interned in the ast's arena
   @return 0 for success, -1 for error
 */
 int hoku_ast_add_prop(hoku_ast* component, hoku_ast_prop* prop);
@@ -239,22 +267,20 @@ int hoku_ast_add_prop(hoku_ast* component, hoku_ast_prop* prop);
   hoku_ast_prop* prop = hoku_ast_get_prop(ast_node, &(hoku_ast_prop){.name="prop"});
 */
 hoku_ast_prop* hoku_ast_get_prop(hoku_ast* component, hoku_ast_prop* prop);
-int hoku_ast_cond_init(hoku_ast_condition** cond, hoku_ast_func_call* call);
-int hoku_ast_loop_init(hoku_ast_loop** loop, char* name, char* list_name);
+int hoku_ast_cond_init(hoku_ast_condition** cond, hoku_arena* arena, hoku_ast_func_call* call);
+int hoku_ast_loop_init(hoku_ast_loop** loop, hoku_arena* arena, char* name, char* list_name);
 int hoku_ast_events_count(hoku_ast* component);
 int hoku_ast_add_event(hoku_ast* component, hoku_ast_event* event);
 hoku_ast_event* hoku_ast_get_event(hoku_ast* component, hoku_ast_event* event);
 
-int hoku_ast_init(hoku_ast** component, char* type);
-void hoku_ast_free(hoku_ast* component);
-
-int hoku_ast_func_call_init(hoku_ast_func_call** call, char* name);
-void hoku_ast_func_call_free(hoku_ast_func_call* init);
+int hoku_ast_init(hoku_ast** component, hoku_arena* arena, char* type);
 
-int hoku_ast_event_init(hoku_ast_event** event, char* name);
-void hoku_ast_event_free(void* event);
+/**
+  Frees the arena of component's tree, and with it every node in the tree
+  @param component any node of the tree, usually the root
+*/
+void hoku_ast_free(hoku_ast* component);
 
-int hoku_ast_prop_init(hoku_ast_prop** prop, char* name);
-void hoku_ast_prop_free(void* prop);
+int hoku_ast_func_call_init(hoku_ast_func_call** call, hoku_arena* arena, char* name);
 
 #endif
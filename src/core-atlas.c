@@ -0,0 +1,152 @@
+#ifndef HOKU_CORE_ATLAS
+#define HOKU_CORE_ATLAS
+
+#include "core-atlas.h"
+
+int hoku_atlas_init(hoku_atlas** atlas, int width, int height, int padding)
+{
+  hoku_atlas* init = malloc(sizeof(hoku_atlas));
+  if (init == NULL) return -1;
+
+  init->width = width;
+  init->height = height;
+  init->padding = padding;
+  init->node_cap = 64;
+  init->nodes = malloc(sizeof(hoku_atlas_node) * init->node_cap);
+  if (init->nodes == NULL)
+  {
+    free(init);
+    return -1;
+  }
+
+  hoku_atlas_reset(init);
+  *atlas = init;
+
+  return 0;
+}
+
+void hoku_atlas_reset(hoku_atlas* atlas)
+{
+  atlas->node_len = 1;
+  atlas->nodes[0] = (hoku_atlas_node){ .x = 0, .y = 0, .width = atlas->width };
+}
+
+void hoku_atlas_free(hoku_atlas* atlas)
+{
+  free(atlas->nodes);
+  free(atlas);
+}
+
+/* returns the y a w x h rect would rest at when placed on node i, or -1 */
+static int hoku_atlas_fit(hoku_atlas* atlas, int i, int w, int h)
+{
+  int x = atlas->nodes[i].x;
+  if (x + w > atlas->width) return -1;
+
+  int y = atlas->nodes[i].y;
+  int remaining = w;
+
+  while (remaining > 0)
+  {
+    if (i == atlas->node_len) return -1;
+    if (atlas->nodes[i].y > y) y = atlas->nodes[i].y;
+    if (y + h > atlas->height) return -1;
+
+    remaining -= atlas->nodes[i].width;
+    i++;
+  }
+
+  return y;
+}
+
+static int hoku_atlas_insert_node(hoku_atlas* atlas, int index, int x, int y, int w)
+{
+  if (atlas->node_len == atlas->node_cap)
+  {
+    int cap = atlas->node_cap * 2;
+    hoku_atlas_node* nodes = realloc(atlas->nodes, sizeof(hoku_atlas_node) * cap);
+    if (nodes == NULL) return -1;
+
+    atlas->nodes = nodes;
+    atlas->node_cap = cap;
+  }
+
+  memmove(&atlas->nodes[index + 1], &atlas->nodes[index], sizeof(hoku_atlas_node) * (atlas->node_len - index));
+  atlas->nodes[index] = (hoku_atlas_node){ .x = x, .y = y, .width = w };
+  atlas->node_len++;
+
+  return 0;
+}
+
+static void hoku_atlas_remove_node(hoku_atlas* atlas, int index)
+{
+  memmove(&atlas->nodes[index], &atlas->nodes[index + 1], sizeof(hoku_atlas_node) * (atlas->node_len - index - 1));
+  atlas->node_len--;
+}
+
+int hoku_atlas_pack(hoku_atlas* atlas, int w, int h, int* x, int* y)
+{
+  // padded on all four sides, so filtering never samples a neighbour
+  w += atlas->padding * 2;
+  h += atlas->padding * 2;
+
+  int best_index = -1;
+  int best_height = atlas->height + 1;
+  int best_width = atlas->width + 1;
+  int best_x = 0;
+  int best_y = 0;
+
+  for (int i=0; i<atlas->node_len; i++)
+  {
+    int fit = hoku_atlas_fit(atlas, i, w, h);
+    if (fit == -1) continue;
+
+    // lowest resting edge first, then the tightest segment
+    if (fit + h < best_height || (fit + h == best_height && atlas->nodes[i].width < best_width))
+    {
+      best_index = i;
+      best_height = fit + h;
+      best_width = atlas->nodes[i].width;
+      best_x = atlas->nodes[i].x;
+      best_y = fit;
+    }
+  }
+
+  if (best_index == -1) return -1;
+  if (hoku_atlas_insert_node(atlas, best_index, best_x, best_y + h, w) != 0) return -1;
+
+  // trim the segments now shadowed by the new one
+  for (int i=best_index + 1; i<atlas->node_len; i++)
+  {
+    hoku_atlas_node* prev = &atlas->nodes[i - 1];
+    hoku_atlas_node* node = &atlas->nodes[i];
+    int overlap = prev->x + prev->width - node->x;
+    if (overlap <= 0) break;
+
+    node->x += overlap;
+    node->width -= overlap;
+
+    if (node->width > 0) break;
+
+    hoku_atlas_remove_node(atlas, i);
+    i--;
+  }
+
+  // merge neighbours at the same height
+  for (int i=0; i<atlas->node_len - 1; i++)
+  {
+    if (atlas->nodes[i].y == atlas->nodes[i + 1].y)
+    {
+      atlas->nodes[i].width += atlas->nodes[i + 1].width;
+      hoku_atlas_remove_node(atlas, i + 1);
+      i--;
+    }
+  }
+
+  *x = best_x + atlas->padding;
+  *y = best_y + atlas->padding;
+
+  return 0;
+}
+
+#endif
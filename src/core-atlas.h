@@ -0,0 +1,50 @@
+#ifndef HOKU_CORE_ATLAS_H
+#define HOKU_CORE_ATLAS_H
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+  A skyline segment: the packed height (y) over [x, x + width)
+*/
+typedef struct HokuAtlasNode
+{
+  int x;
+  int y;
+  int width;
+} hoku_atlas_node;
+
+/**
+  Skyline bottom-left rectangle packer.
+
+  Only tracks free space, the caller owns whatever pixels live
+  at the returned coordinates.
+*/
+typedef struct HokuAtlas
+{
+  int width;
+  int height;
+  int padding;
+  int node_len;
+  int node_cap;
+  hoku_atlas_node* nodes;
+} hoku_atlas;
+
+int hoku_atlas_init(hoku_atlas** atlas, int width, int height, int padding);
+
+/**
+  Reserves a w x h region, with `padding` free pixels on every side of it
+  @param atlas the atlas
+  @param x out param for the region x
+  @param y out param for the region y
+  @return 0 on success, -1 when the atlas is full
+*/
+int hoku_atlas_pack(hoku_atlas* atlas, int w, int h, int* x, int* y);
+
+/**
+  Releases every region in the atlas
+*/
+void hoku_atlas_reset(hoku_atlas* atlas);
+void hoku_atlas_free(hoku_atlas* atlas);
+
+#endif
@@ -0,0 +1,494 @@
+#ifndef HOKU_CORE_BLOB
+#define HOKU_CORE_BLOB
+
+#include "core-blob.h"
+#include "hashmap.h"
+
+#define HOKU_BLOB_NULL UINT32_MAX
+
+typedef struct HokuBlobWriter
+{
+	char* data;
+	size_t len;
+	size_t cap;
+	bool failed;
+} hoku_blob_writer;
+
+typedef struct HokuBlobReader
+{
+	const char* at;
+	const char* end;
+	hoku_arena* arena;
+	bool failed;
+} hoku_blob_reader;
+
+uint64_t hoku_blob_key(const char* type, const char* template, size_t template_bytes)
+{
+	return hashmap_sip(template, template_bytes, hashmap_sip(type, strlen(type), 0, 0), HOKU_BLOB_VERSION);
+}
+
+/* writing */
+
+static void hoku_blob_put(hoku_blob_writer* writer, const void* data, size_t len)
+{
+	if (writer->failed) return;
+
+	if (writer->len + len > writer->cap)
+	{
+		size_t cap = writer->cap == 0 ? 1024 : writer->cap;
+		while (cap < writer->len + len) cap *= 2;
+
+		char* grown = realloc(writer->data, cap);
+		if (grown == NULL)
+		{
+			writer->failed = true;
+			return;
+		}
+
+		writer->data = grown;
+		writer->cap = cap;
+	}
+
+	memcpy(writer->data + writer->len, data, len);
+	writer->len += len;
+}
+
+static void hoku_blob_put_u8(hoku_blob_writer* writer, uint8_t value)
+{
+	hoku_blob_put(writer, &value, sizeof(value));
+}
+
+static void hoku_blob_put_u16(hoku_blob_writer* writer, uint16_t value)
+{
+	hoku_blob_put(writer, &value, sizeof(value));
+}
+
+static void hoku_blob_put_u32(hoku_blob_writer* writer, uint32_t value)
+{
+	hoku_blob_put(writer, &value, sizeof(value));
+}
+
+static void hoku_blob_put_str(hoku_blob_writer* writer, const char* str)
+{
+	if (str == NULL)
+	{
+		hoku_blob_put_u32(writer, HOKU_BLOB_NULL);
+		return;
+	}
+
+	uint32_t len = (uint32_t) strlen(str);
+	hoku_blob_put_u32(writer, len);
+	hoku_blob_put(writer, str, len);
+}
+
+static void hoku_blob_put_names(hoku_blob_writer* writer, hoku_ast_names* names)
+{
+	hoku_blob_put_u16(writer, names->len);
+	for (uint16_t i = 0; i < names->len; i++) hoku_blob_put_str(writer, names->names[i]);
+}
+
+static void hoku_blob_put_call(hoku_blob_writer* writer, hoku_ast_func_call* call)
+{
+	hoku_blob_put_u8(writer, call != NULL);
+	if (call == NULL) return;
+
+	hoku_blob_put_str(writer, call->function);
+	hoku_blob_put_u8(writer, (uint8_t) call->args_len);
+	for (int i = 0; i < call->args_len; i++) hoku_blob_put_str(writer, call->strargs[i]);
+}
+
+static void hoku_blob_put_ast(hoku_blob_writer* writer, hoku_ast* ast)
+{
+	hoku_blob_put_str(writer, ast->type);
+	hoku_blob_put_str(writer, ast->id);
+	hoku_blob_put_str(writer, ast->error);
+	hoku_blob_put_u8(writer, ast->has_slot | ast->else_active << 1 | ast->is_root << 2);
+	hoku_blob_put_u32(writer, (uint32_t) ast->child_len);
+
+	hoku_blob_put_u8(writer, ast->cond != NULL);
+	if (ast->cond != NULL)
+	{
+		hoku_blob_put_u8(writer, ast->cond->not);
+		hoku_blob_put_call(writer, ast->cond->call);
+	}
+
+	hoku_blob_put_u8(writer, ast->loop != NULL);
+	if (ast->loop != NULL)
+	{
+		hoku_blob_put_str(writer, ast->loop->name);
+		hoku_blob_put_str(writer, ast->loop->list_name);
+	}
+
+	hoku_blob_put_names(writer, &ast->class_list);
+	hoku_blob_put_names(writer, &ast->style_list);
+
+	hoku_blob_put_u16(writer, ast->props_len);
+	for (hoku_ast_prop* prop = ast->props; prop < ast->props + ast->props_len; prop++)
+	{
+		hoku_blob_put_str(writer, prop->name);
+		hoku_blob_put_u8(writer, prop->computed);
+		hoku_blob_put_call(writer, prop->call);
+	}
+
+	hoku_blob_put_u16(writer, ast->events_len);
+	for (hoku_ast_event* event = ast->events; event < ast->events + ast->events_len; event++)
+	{
+		hoku_blob_put_str(writer, event->name);
+		hoku_blob_put_call(writer, event->call);
+	}
+
+	uint32_t children = 0;
+	for (hoku_ast* child = ast->relations->next_child; child != NULL; child = child->relations->next_sibling) children++;
+
+	hoku_blob_put_u32(writer, children);
+	for (hoku_ast* child = ast->relations->next_child; child != NULL; child = child->relations->next_sibling)
+	{
+		hoku_blob_put_ast(writer, child);
+	}
+
+	hoku_ast* else_ast = ast->else_relations == NULL ? NULL : ast->else_relations->next_child;
+	hoku_blob_put_u8(writer, else_ast != NULL);
+	if (else_ast != NULL) hoku_blob_put_ast(writer, else_ast);
+}
+
+static void hoku_blob_put_style(hoku_blob_writer* writer, hoku_style* style)
+{
+	uint32_t count = 0;
+	for (hoku_style* head = style; head != NULL; head = head->next) count++;
+
+	hoku_blob_put_u32(writer, count);
+	for (hoku_style* head = style; head != NULL; head = head->next)
+	{
+		hoku_blob_put_str(writer, head->name);
+		hoku_blob_put_str(writer, head->event_name);
+
+		uint32_t attributes = 0;
+		for (hoku_style_attribute* attribute = head->attributes; attribute != NULL; attribute = attribute->next) attributes++;
+
+		hoku_blob_put_u32(writer, attributes);
+		for (hoku_style_attribute* attribute = head->attributes; attribute != NULL; attribute = attribute->next)
+		{
+			hoku_blob_put_str(writer, attribute->name);
+			hoku_blob_put_str(writer, attribute->value);
+			hoku_blob_put_str(writer, attribute->function_name);
+			hoku_blob_put_u8(writer, (uint8_t) attribute->type);
+		}
+	}
+}
+
+static void hoku_blob_put_header(hoku_blob_writer* writer, enum HOKU_BLOB_KIND kind, uint64_t key, uint32_t template_bytes)
+{
+	hoku_blob_header header = {
+		.magic = HOKU_BLOB_MAGIC,
+		.version = HOKU_BLOB_VERSION,
+		.kind = (uint8_t) kind,
+		.reserved = 0,
+		.key = key,
+		.template_bytes = template_bytes,
+		.body_bytes = 0
+	};
+
+	hoku_blob_put(writer, &header, sizeof(header));
+}
+
+/* fills in body_bytes, hands the buffer to the caller */
+static int hoku_blob_finish(hoku_blob_writer* writer, char** out, size_t* out_size)
+{
+	if (writer->failed || writer->len - sizeof(hoku_blob_header) > UINT32_MAX)
+	{
+		free(writer->data);
+		return -1;
+	}
+
+	uint32_t body_bytes = (uint32_t)(writer->len - sizeof(hoku_blob_header));
+	memcpy(writer->data + offsetof(hoku_blob_header, body_bytes), &body_bytes, sizeof(body_bytes));
+
+	*out = writer->data;
+	*out_size = writer->len;
+	return 0;
+}
+
+int hoku_blob_write_ast(hoku_ast* ast, uint64_t key, uint32_t template_bytes, char** out, size_t* out_size)
+{
+	hoku_blob_writer writer = {0};
+	hoku_blob_put_header(&writer, HOKU_BLOB_AST, key, template_bytes);
+	hoku_blob_put_ast(&writer, ast);
+	return hoku_blob_finish(&writer, out, out_size);
+}
+
+int hoku_blob_write_style(hoku_style* style, uint64_t key, uint32_t template_bytes, char** out, size_t* out_size)
+{
+	hoku_blob_writer writer = {0};
+	hoku_blob_put_header(&writer, HOKU_BLOB_STYLE, key, template_bytes);
+	hoku_blob_put_style(&writer, style);
+	return hoku_blob_finish(&writer, out, out_size);
+}
+
+/* reading, every read past the end marks the reader failed */
+
+static bool hoku_blob_get(hoku_blob_reader* reader, void* out, size_t len)
+{
+	if (reader->failed || (size_t)(reader->end - reader->at) < len)
+	{
+		reader->failed = true;
+		memset(out, 0, len);
+		return false;
+	}
+
+	memcpy(out, reader->at, len);
+	reader->at += len;
+	return true;
+}
+
+static uint8_t hoku_blob_get_u8(hoku_blob_reader* reader)
+{
+	uint8_t value;
+	hoku_blob_get(reader, &value, sizeof(value));
+	return value;
+}
+
+static uint16_t hoku_blob_get_u16(hoku_blob_reader* reader)
+{
+	uint16_t value;
+	hoku_blob_get(reader, &value, sizeof(value));
+	return value;
+}
+
+static uint32_t hoku_blob_get_u32(hoku_blob_reader* reader)
+{
+	uint32_t value;
+	hoku_blob_get(reader, &value, sizeof(value));
+	return value;
+}
+
+static char* hoku_blob_get_str(hoku_blob_reader* reader)
+{
+	uint32_t len = hoku_blob_get_u32(reader);
+	if (reader->failed || len == HOKU_BLOB_NULL) return NULL;
+
+	if ((size_t)(reader->end - reader->at) < len)
+	{
+		reader->failed = true;
+		return NULL;
+	}
+
+	char* str = hoku_arena_intern(reader->arena, reader->at, len);
+	if (str == NULL) reader->failed = true;
+
+	reader->at += len;
+	return str;
+}
+
+static hoku_ast_func_call* hoku_blob_get_call(hoku_blob_reader* reader)
+{
+	if (!hoku_blob_get_u8(reader) || reader->failed) return NULL;
+
+	hoku_ast_func_call* call;
+	if (hoku_ast_func_call_init(&call, reader->arena, hoku_blob_get_str(reader)) == -1)
+	{
+		reader->failed = true;
+		return NULL;
+	}
+
+	uint8_t args_len = hoku_blob_get_u8(reader);
+	if (args_len == 0) return call;
+
+	call->strargs = hoku_arena_alloc(reader->arena, sizeof(char*) * args_len);
+	if (call->strargs == NULL)
+	{
+		reader->failed = true;
+		return call;
+	}
+
+	for (uint8_t i = 0; i < args_len; i++) call->strargs[i] = hoku_blob_get_str(reader);
+	call->args_len = args_len;
+	return call;
+}
+
+static hoku_ast* hoku_blob_get_ast(hoku_blob_reader* reader, hoku_ast* parent)
+{
+	hoku_ast* ast;
+	char* type = hoku_blob_get_str(reader);
+	if (reader->failed || type == NULL || hoku_ast_init(&ast, reader->arena, type) == -1)
+	{
+		reader->failed = true;
+		return NULL;
+	}
+
+	ast->parent = parent;
+	ast->id = hoku_blob_get_str(reader);
+	ast->error = hoku_blob_get_str(reader);
+
+	uint8_t flags = hoku_blob_get_u8(reader);
+	ast->has_slot = flags & 1;
+	ast->else_active = flags & 2;
+	ast->is_root = flags & 4;
+	ast->child_len = (int) hoku_blob_get_u32(reader);
+
+	if (hoku_blob_get_u8(reader))
+	{
+		bool not = hoku_blob_get_u8(reader);
+		if (hoku_ast_cond_init(&ast->cond, reader->arena, hoku_blob_get_call(reader)) == -1) reader->failed = true;
+		else ast->cond->not = not;
+	}
+
+	if (hoku_blob_get_u8(reader))
+	{
+		char* name = hoku_blob_get_str(reader);
+		char* list_name = hoku_blob_get_str(reader);
+		if (hoku_ast_loop_init(&ast->loop, reader->arena, name, list_name) == -1) reader->failed = true;
+	}
+
+	uint16_t classes = hoku_blob_get_u16(reader);
+	for (uint16_t i = 0; i < classes && !reader->failed; i++)
+	{
+		if (hoku_ast_class_list_append(ast, hoku_blob_get_str(reader)) == -1) reader->failed = true;
+	}
+
+	uint16_t styles = hoku_blob_get_u16(reader);
+	for (uint16_t i = 0; i < styles && !reader->failed; i++)
+	{
+		if (hoku_ast_style_list_append(ast, hoku_blob_get_str(reader)) == -1) reader->failed = true;
+	}
+
+	uint16_t props = hoku_blob_get_u16(reader);
+	for (uint16_t i = 0; i < props && !reader->failed; i++)
+	{
+		hoku_ast_prop prop;
+		prop.name = hoku_blob_get_str(reader);
+		prop.computed = hoku_blob_get_u8(reader);
+		prop.call = hoku_blob_get_call(reader);
+		if (prop.name == NULL || hoku_ast_add_prop(ast, &prop) == -1) reader->failed = true;
+	}
+
+	uint16_t events = hoku_blob_get_u16(reader);
+	for (uint16_t i = 0; i < events && !reader->failed; i++)
+	{
+		hoku_ast_event event;
+		event.name = hoku_blob_get_str(reader);
+		event.call = hoku_blob_get_call(reader);
+		if (event.name == NULL || hoku_ast_add_event(ast, &event) == -1) reader->failed = true;
+	}
+
+	uint32_t children = hoku_blob_get_u32(reader);
+	hoku_ast* last = NULL;
+	for (uint32_t i = 0; i < children && !reader->failed; i++)
+	{
+		hoku_ast* child = hoku_blob_get_ast(reader, ast);
+		if (child == NULL) return NULL;
+
+		if (last == NULL) ast->relations->next_child = child;
+		else last->relations->next_sibling = child;
+		last = child;
+	}
+
+	if (hoku_blob_get_u8(reader))
+	{
+		hoku_ast* else_ast = hoku_blob_get_ast(reader, ast);
+		ast->else_relations = hoku_arena_alloc(reader->arena, sizeof(hoku_ast_list));
+		if (else_ast == NULL || ast->else_relations == NULL)
+		{
+			reader->failed = true;
+			return NULL;
+		}
+
+		ast->else_relations->next_child = else_ast;
+		ast->else_relations->next_sibling = NULL;
+	}
+
+	return reader->failed ? NULL : ast;
+}
+
+static hoku_style* hoku_blob_get_style(hoku_blob_reader* reader)
+{
+	hoku_style* top = NULL;
+	hoku_style* last = NULL;
+
+	uint32_t count = hoku_blob_get_u32(reader);
+	for (uint32_t i = 0; i < count && !reader->failed; i++)
+	{
+		hoku_style* style;
+		char* name = hoku_blob_get_str(reader);
+		if (reader->failed || name == NULL || hoku_style_init(&style, reader->arena, name) == -1) return NULL;
+
+		style->event_name = hoku_blob_get_str(reader);
+
+		hoku_style_attribute* last_attribute = NULL;
+		uint32_t attributes = hoku_blob_get_u32(reader);
+		for (uint32_t j = 0; j < attributes && !reader->failed; j++)
+		{
+			hoku_style_attribute* attribute;
+			char* attribute_name = hoku_blob_get_str(reader);
+			char* value = hoku_blob_get_str(reader);
+			char* function_name = hoku_blob_get_str(reader);
+			uint8_t type = hoku_blob_get_u8(reader);
+			if (reader->failed || type > HOKU_STYLE_TYPE_FUNC) return NULL;
+			if (hoku_style_attribute_init(&attribute, reader->arena, attribute_name, value, (enum HOKU_STYLE_TYPE) type) == -1) return NULL;
+
+			attribute->function_name = function_name;
+			if (last_attribute == NULL) style->attributes = attribute;
+			else last_attribute->next = attribute;
+			last_attribute = attribute;
+		}
+
+		if (top == NULL) top = style;
+		else last->next = style;
+		last = style;
+	}
+
+	return reader->failed ? NULL : top;
+}
+
+int hoku_blob_header_read(const char* data, size_t size, hoku_blob_header* out)
+{
+	if (size < sizeof(hoku_blob_header)) return -1;
+
+	memcpy(out, data, sizeof(hoku_blob_header));
+	if (out->magic != HOKU_BLOB_MAGIC || out->version != HOKU_BLOB_VERSION) return -1;
+	if (size - sizeof(hoku_blob_header) < out->body_bytes) return -1;
+
+	return 0;
+}
+
+const char* hoku_blob_check(const char* data, size_t size, enum HOKU_BLOB_KIND kind, uint64_t key, uint32_t template_bytes, hoku_blob_header* header)
+{
+	if (hoku_blob_header_read(data, size, header) == -1) return NULL;
+	if (header->kind != kind || header->key != key || header->template_bytes != template_bytes) return NULL;
+
+	return data + sizeof(hoku_blob_header);
+}
+
+int hoku_blob_read_ast(const char* body, size_t body_bytes, hoku_ast** out)
+{
+	hoku_blob_reader reader = { .at = body, .end = body + body_bytes, .failed = false };
+	// decoded trees are about as big as walked ones, and the blob is smaller than its template
+	if (hoku_arena_init(&reader.arena, body_bytes * 4) == -1) return -1;
+
+	hoku_ast* ast = hoku_blob_get_ast(&reader, NULL);
+	if (ast == NULL || reader.at != reader.end)
+	{
+		hoku_arena_free(reader.arena);
+		return -1;
+	}
+
+	*out = ast;
+	return 0;
+}
+
+int hoku_blob_read_style(const char* body, size_t body_bytes, hoku_style** out)
+{
+	hoku_blob_reader reader = { .at = body, .end = body + body_bytes, .failed = false };
+	if (hoku_arena_init(&reader.arena, body_bytes * 4) == -1) return -1;
+
+	hoku_style* style = hoku_blob_get_style(&reader);
+	if (style == NULL || reader.at != reader.end)
+	{
+		hoku_arena_free(reader.arena);
+		return -1;
+	}
+
+	*out = style;
+	return 0;
+}
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef HOKU_CORE_BLOB_H
+#define HOKU_CORE_BLOB_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "core-arena.h"
+#include "core-ast.h"
+#include "core-style.h"
+
+#define HOKU_BLOB_MAGIC 0x42544b48 // "HKTB"
+// bump whenever hoku_ast, hoku_style or the encoding below changes
+#define HOKU_BLOB_VERSION 1
+
+enum HOKU_BLOB_KIND
+{
+	HOKU_BLOB_AST,
+	HOKU_BLOB_STYLE
+};
+
+/**
+  Precedes every blob.
+  A blob is the header and body_bytes of encoded tree, blobs can be concatenated into a pack.
+  @var key
+  hoku_blob_key of the source the tree was parsed from
+  @var template_bytes
+  length of that source, a second check against key collisions
+*/
+typedef struct HokuBlobHeader
+{
+	uint32_t magic;
+	uint16_t version;
+	uint8_t kind;
+	uint8_t reserved;
+	uint64_t key;
+	uint32_t template_bytes;
+	uint32_t body_bytes;
+} hoku_blob_header;
+
+/**
+  A compact encoding of parsed template and style trees,
+  so unchanged templates can be loaded without running tree-sitter.
+
+  Fields are written in order with native byte order,
+  strings as a u32 length (UINT32_MAX for NULL) and their bytes, lists as a count and their items.
+  Blobs are only read back by the build that wrote them (see HOKU_BLOB_VERSION).
+*/
+
+/**
+  @param type the component type (or "" for styles)
+  @param template the template source
+  @return a 64 bit key for the pair
+*/
+uint64_t hoku_blob_key(const char* type, const char* template, size_t template_bytes);
+
+/**
+  Encodes an ast tree into a malloc'd blob
+  @return 0 for success, -1 for error
+*/
+int hoku_blob_write_ast(hoku_ast* ast, uint64_t key, uint32_t template_bytes, char** out, size_t* out_size);
+int hoku_blob_write_style(hoku_style* style, uint64_t key, uint32_t template_bytes, char** out, size_t* out_size);
+
+/**
+  Reads the header at data, which may be unaligned (blobs in a pack are)
+  @param size the bytes available at data
+  @return 0 for success, -1 if data isn't a whole blob from this build
+*/
+int hoku_blob_header_read(const char* data, size_t size, hoku_blob_header* out);
+
+/**
+  @return the body of the blob at data, or NULL unless it holds a tree of kind parsed from (key, template_bytes)
+*/
+const char* hoku_blob_check(const char* data, size_t size, enum HOKU_BLOB_KIND kind, uint64_t key, uint32_t template_bytes, hoku_blob_header* header);
+
+/**
+  Decodes a checked blob body into a new tree with its own arena, freed like a parsed one
+  @return 0 for success, -1 for error or a malformed body
+*/
+int hoku_blob_read_ast(const char* body, size_t body_bytes, hoku_ast** out);
+int hoku_blob_read_style(const char* body, size_t body_bytes, hoku_style** out);
+
+#endif
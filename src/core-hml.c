@@ -3,29 +3,240 @@
 
 #include "core-hml.h"
 
-char* hoku_get_substr(char* template, int idx, int len)
+/* a template type's last parse, while the thread retains them */
+typedef struct HokuRetainedTree
 {
-	char* init = malloc(sizeof(char) * (len + 1));
-	if (init == NULL) return NULL;
+	char* type;
+	char* source;
+	size_t bytes;
+	TSTree* tree;
+} hoku_retained_tree;
+
+static _Thread_local TSParser* hoku_parser = NULL;
+static _Thread_local hoku_parse_stats hoku_stats = {0};
+static _Thread_local struct hashmap* hoku_retained = NULL;
+static _Thread_local bool hoku_retaining = false;
+
+/* the calling thread's parser, ready for a new document */
+static TSParser* hoku_parser_get(void)
+{
+	if (hoku_parser == NULL)
+	{
+		hoku_parser = ts_parser_new();
+		if (hoku_parser == NULL) return NULL;
 
-	memcpy(init, template + idx, len);
-	init[len] = '\0';
-	return init;
+		ts_parser_set_language(hoku_parser, tree_sitter_hml());
+	}
+	else
+	{
+		ts_parser_reset(hoku_parser);
+	}
+
+	return hoku_parser;
 }
 
-char* hoku_get_tag(TSNode tag, char* template)
+static int hoku_retained_compare(const void* a, const void* b, void* udata)
+{
+	return strcmp(((hoku_retained_tree*) a)->type, ((hoku_retained_tree*) b)->type);
+}
+
+static uint64_t hoku_retained_hash(const void* item, uint64_t seed0, uint64_t seed1)
+{
+	const char* type = ((hoku_retained_tree*) item)->type;
+	return hashmap_sip(type, strlen(type), seed0, seed1);
+}
+
+static void hoku_retained_free(void* item)
+{
+	hoku_retained_tree* retained = (hoku_retained_tree*) item;
+	free(retained->type);
+	free(retained->source);
+	ts_tree_delete(retained->tree);
+}
+
+/* the row and byte column of offset in source */
+static TSPoint hoku_point_at(const char* source, size_t offset)
+{
+	TSPoint point = {0, 0};
+	for (size_t i = 0; i < offset; i++)
+	{
+		if (source[i] == '\n')
+		{
+			point.row++;
+			point.column = 0;
+		}
+		else
+		{
+			point.column++;
+		}
+	}
+
+	return point;
+}
+
+/* edits the retained tree to match template: everything between the common prefix and suffix changed */
+static void hoku_retained_edit(hoku_retained_tree* retained, char* template, size_t bytes)
+{
+	size_t start = 0;
+	while (start < retained->bytes && start < bytes && retained->source[start] == template[start]) start++;
+
+	size_t old_end = retained->bytes;
+	size_t new_end = bytes;
+	while (old_end > start && new_end > start && retained->source[old_end - 1] == template[new_end - 1])
+	{
+		old_end--;
+		new_end--;
+	}
+
+	if (start == old_end && start == new_end) return;
+
+	TSInputEdit edit = {
+		.start_byte = (uint32_t) start,
+		.old_end_byte = (uint32_t) old_end,
+		.new_end_byte = (uint32_t) new_end,
+		.start_point = hoku_point_at(template, start),
+		.old_end_point = hoku_point_at(retained->source, old_end),
+		.new_end_point = hoku_point_at(template, new_end)
+	};
+	ts_tree_edit(retained->tree, &edit);
+}
+
+/* keeps a copy of tree as type's last parse, replacing the one it was edited from */
+static void hoku_retain(char* type, char* template, size_t bytes, TSTree* tree)
+{
+	if (hoku_retained == NULL)
+	{
+		hoku_retained = hashmap_new(sizeof(hoku_retained_tree), 0, 0, 0, hoku_retained_hash, hoku_retained_compare, hoku_retained_free, NULL);
+		if (hoku_retained == NULL) return;
+	}
+
+	hoku_retained_tree retained = {
+		.type = strdup(type),
+		.source = malloc(bytes + 1),
+		.bytes = bytes,
+		.tree = ts_tree_copy(tree)
+	};
+
+	if (retained.type == NULL || retained.source == NULL)
+	{
+		hoku_retained_free(&retained);
+		return;
+	}
+
+	memcpy(retained.source, template, bytes + 1);
+
+	const hoku_retained_tree* replaced = hashmap_set(hoku_retained, &retained);
+	if (replaced != NULL)
+	{
+		hoku_retained_tree old = *replaced;
+		hoku_retained_free(&old);
+	}
+	else if (hashmap_oom(hoku_retained))
+	{
+		hoku_retained_free(&retained);
+	}
+}
+
+/* parses template, counting it towards the thread's stats, type is NULL for templates that aren't retained */
+static TSTree* hoku_parse(char* type, char* template)
+{
+	TSParser* parser = hoku_parser_get();
+	if (parser == NULL) return NULL;
+
+	size_t bytes = strlen(template);
+	double start = monotonic_seconds();
+
+	TSTree* old_tree = NULL;
+	if (hoku_retaining && type != NULL && hoku_retained != NULL)
+	{
+		hoku_retained_tree* retained = (hoku_retained_tree*) hashmap_get(hoku_retained, &(hoku_retained_tree){ .type = type });
+		if (retained != NULL)
+		{
+			hoku_retained_edit(retained, template, bytes);
+			old_tree = retained->tree;
+		}
+	}
+
+	TSTree* tree = ts_parser_parse_string(parser, old_tree, template, bytes);
+	if (tree != NULL && hoku_retaining && type != NULL)
+	{
+		hoku_retain(type, template, bytes, tree);
+	}
+	else if (old_tree != NULL)
+	{
+		// the kept tree was edited for a source it no longer has
+		const hoku_retained_tree* dropped = hashmap_delete(hoku_retained, &(hoku_retained_tree){ .type = type });
+		if (dropped != NULL)
+		{
+			hoku_retained_tree old = *dropped;
+			hoku_retained_free(&old);
+		}
+	}
+
+	hoku_stats.parses++;
+	if (old_tree != NULL) hoku_stats.incremental++;
+	hoku_stats.bytes += bytes;
+	hoku_stats.parse_ms += (monotonic_seconds() - start) * 1000.0;
+
+	return tree;
+}
+
+/* an arena chunk that fits most templates' trees without a second one */
+static size_t hoku_arena_size(char* template)
+{
+	return strlen(template) * 8;
+}
+
+/* counts a walked tree's arena towards the thread's stats */
+static void hoku_arena_count(hoku_arena* arena)
+{
+	hoku_stats.arena_chunks += arena->chunks;
+	hoku_stats.arena_bytes += arena->bytes;
+}
+
+hoku_parse_stats hoku_parse_stats_get(void)
+{
+	return hoku_stats;
+}
+
+void hoku_parser_retain(bool retain)
+{
+	hoku_retaining = retain;
+	if (retain || hoku_retained == NULL) return;
+
+	hashmap_free(hoku_retained);
+	hoku_retained = NULL;
+}
+
+void hoku_parser_release(void)
+{
+	hoku_parser_retain(false);
+	if (hoku_parser == NULL) return;
+
+	ts_parser_delete(hoku_parser);
+	hoku_parser = NULL;
+}
+
+/* token text is interned in the tree's arena, next to the nodes that use it */
+char* hoku_get_substr(hoku_arena* arena, char* template, int idx, int len)
+{
+	return hoku_arena_intern(arena, template + idx, len);
+}
+
+char* hoku_get_tag(hoku_arena* arena, TSNode tag, char* template)
 {
 	uint32_t start =  ts_node_start_byte(tag);
 	uint32_t end = ts_node_end_byte(tag);
-	return hoku_get_substr(template, start, end - start);
+	return hoku_get_substr(arena, template, start, end - start);
 }
 
 void hoku_debug(TSNode node, char* template)
 {
 	const char* ntype = ts_node_type(node);
-	char* val = hoku_get_tag(node, template);
+	uint32_t start = ts_node_start_byte(node);
+	uint32_t end = ts_node_end_byte(node);
 
-	printf("[type: %s] ->\n%s\n", ntype, val);
+	printf("[type: %s] ->\n%.*s\n", ntype, (int)(end - start), template + start);
 }
 
 void hoku_dump(hoku_ast* c, int level)
@@ -33,14 +244,12 @@ void hoku_dump(hoku_ast* c, int level)
 	printf("%*s%s", (int)((level) * 2), "", c->type);
 	if (c->id != NULL) printf("#%s", c->id);
 
-	hoku_ast_class_list* head = c->class_list;
-	while (head != NULL)
+	for (uint16_t i = 0; i < c->class_list.len; i++)
 	{
-		printf(".%s", head->name);
-		head = head->next;
+		printf(".%s", c->class_list.names[i]);
 	}
 
-	printf(" [%zu]", hashmap_count(c->props) + hashmap_count(c->events));
+	printf(" [%d]", hoku_ast_props_count(c) + hoku_ast_events_count(c));
 	if (c->loop != NULL)
 	{
 		printf(" (loop) ");
@@ -53,12 +262,7 @@ void hoku_dump(hoku_ast* c, int level)
 
 	printf("\n");
 
-	size_t iter = 0;
-	size_t eiter = 0;
-	void *item;
-
-	while (hashmap_iter(c->props, &iter, &item)) {
-		hoku_ast_prop* p = (hoku_ast_prop*) item;
+	for (hoku_ast_prop* p = c->props; p < c->props + c->props_len; p++) {
 		hoku_ast_func_call* c = p->call;
 		char* cname = c->function;
 		int alen = c->args_len;
@@ -66,8 +270,7 @@ void hoku_dump(hoku_ast* c, int level)
 		printf("%*s prop (%s = %s(%d))\n", (int)((level) * 2), "", p->name, cname, alen);
 	}
 
-	while (hashmap_iter(c->events, &eiter, &item)) {
-		hoku_ast_event* p = (hoku_ast_event*) item;
+	for (hoku_ast_event* p = c->events; p < c->events + c->events_len; p++) {
 		hoku_ast_func_call* c = p->call;
 		char* cname = c->function;
 		int alen = c->args_len;
@@ -94,18 +297,21 @@ void hoku_dump(hoku_ast* c, int level)
 	return;
 }
 
-hoku_ast_func_call* hoku_ast_walk_func(TSNode node, char* template, int level)
+hoku_ast_func_call* hoku_ast_walk_func(hoku_arena* arena, TSNode node, char* template, int level)
 {
 	TSNode nname = ts_node_child(node, 0);
-	char* name = hoku_get_tag(nname, template);
+	char* name = hoku_get_tag(arena, nname, template);
 	hoku_ast_func_call* init;
-	hoku_ast_func_call_init(&init, name);
-	free(name);
+	if (hoku_ast_func_call_init(&init, arena, name) == -1) return NULL;
 
 	TSNode arguments = ts_node_next_sibling(nname);
 	
 	if (!ts_node_is_null(arguments))
 	{
+		uint32_t count = ts_node_child_count(arguments);
+		init->strargs = hoku_arena_alloc(arena, sizeof(char*) * (count < 9 ? count : 9));
+		if (init->strargs == NULL) return NULL;
+
 		TSNode arg = ts_node_child(arguments, 0);
 
 		while (!ts_node_is_null(arg))
@@ -115,7 +321,7 @@ hoku_ast_func_call* hoku_ast_walk_func(TSNode node, char* template, int level)
 				// printf("maxed args!\n");
 				break;
 			}
-			char* str = hoku_get_tag(arg, template);
+			char* str = hoku_get_tag(arena, arg, template);
 			init->strargs[init->args_len] = str;
 			init->args_len++;
 			arg = ts_node_next_sibling(arg);
@@ -124,25 +330,21 @@ hoku_ast_func_call* hoku_ast_walk_func(TSNode node, char* template, int level)
 	return init;
 }
 
-hoku_ast_event* hoku_ast_walk_event(TSNode node, char* template, int level)
+int hoku_ast_walk_event(hoku_arena* arena, hoku_ast_event* out, TSNode node, char* template, int level)
 {
 	// const char* type = ts_node_type(node);
 	TSNode nname = ts_node_child(node, 0);
 
-	char* name = hoku_get_tag(nname, template);
-	hoku_ast_event* init;
-	hoku_ast_event_init(&init, name);
-	free(name);
+	out->name = hoku_get_tag(arena, nname, template);
+	if (out->name == NULL) return -1;
 
 	// get value
 	TSNode nvalue = ts_node_next_sibling(nname);
-	hoku_ast_func_call* call = hoku_ast_walk_func(nvalue, template, level + 1);
-
-	init->call = call;
-	return init;
+	out->call = hoku_ast_walk_func(arena, nvalue, template, level + 1);
+	return 0;
 }
 
-hoku_ast_prop* hoku_ast_walk_prop(TSNode node, char* template, int level)
+int hoku_ast_walk_prop(hoku_arena* arena, hoku_ast_prop* out, TSNode node, char* template, int level)
 {
 	// const char* type = ts_node_type(node);
 	bool computed = false;
@@ -154,19 +356,14 @@ hoku_ast_prop* hoku_ast_walk_prop(TSNode node, char* template, int level)
 		nname = ts_node_next_sibling(nname);
 	}
 
-	char* name = hoku_get_tag(nname, template);
-
-	hoku_ast_prop* init;
-	hoku_ast_prop_init(&init, name);
-  free(name);
-	init->computed = computed;
+	out->name = hoku_get_tag(arena, nname, template);
+	if (out->name == NULL) return -1;
+	out->computed = computed;
 
 	// get value
 	TSNode nvalue = ts_node_next_sibling(nname);
-	hoku_ast_func_call* call = hoku_ast_walk_func(nvalue, template, level + 1);
-
-	init->call = call;
-	return init;
+	out->call = hoku_ast_walk_func(arena, nvalue, template, level + 1);
+	return 0;
 }
 
 /**
@@ -180,7 +377,7 @@ element 1
 	element 2 -> child to 1, sibling to 3
 	element 3 -> child to 1, sibling to 2
 */
-hoku_ast* hoku_ast_walk_tree(TSNode node, char* template, int level)
+hoku_ast* hoku_ast_walk_tree(hoku_arena* arena, TSNode node, char* template, int level)
 {
 	const char* ntype = ts_node_type(node);
 	if (ntype == NULL)
@@ -191,20 +388,19 @@ hoku_ast* hoku_ast_walk_tree(TSNode node, char* template, int level)
 
 	if (strcmp(ntype, "name") == 0)
 	{
-		char* name = hoku_get_tag(node, template);
+		char* name = hoku_get_tag(arena, node, template);
 		if (name == NULL)
 		{
 			f_log(F_LOG_ERROR, "Node name is null!\n%s", template);
 			return NULL;
 		}
 		hoku_ast* init;
-		if (hoku_ast_init(&init, name) == -1)
+		if (hoku_ast_init(&init, arena, name) == -1)
 		{
 			f_log(F_LOG_ERROR, "Could not init ast for %s", name);
 			return NULL;
 		}
 
-		free(name);
 		// int i = 0;
 
 		TSNode sibling = ts_node_next_named_sibling(node);
@@ -237,30 +433,30 @@ hoku_ast* hoku_ast_walk_tree(TSNode node, char* template, int level)
 					if (strcmp(atype, "prop") == 0)
 					{
 						f_log(F_LOG_FINE, "Walking props");
-						hoku_ast_prop* prop = hoku_ast_walk_prop(attribute, template, level + 1);
-						if (prop == NULL)
+						hoku_ast_prop prop;
+						if (hoku_ast_walk_prop(arena, &prop, attribute, template, level + 1) == -1)
 						{
 							f_log(F_LOG_ERROR, "Prop is null for attribute %s", attribute);
 							return NULL;
 						}
-						if (hoku_ast_add_prop(init, prop) == -1)
+						if (hoku_ast_add_prop(init, &prop) == -1)
 						{
-							f_log(F_LOG_ERROR, "Couldn't add prop %s to %s", prop->name, init->type);
+							f_log(F_LOG_ERROR, "Couldn't add prop %s to %s", prop.name, init->type);
 							return NULL;
 						}
 					}
 					else if (strcmp(atype, "event") == 0)
 					{
 						f_log(F_LOG_FINE, "Walking events");
-						hoku_ast_event* event = hoku_ast_walk_event(attribute, template, level + 1);
-						if (event == NULL)
+						hoku_ast_event event;
+						if (hoku_ast_walk_event(arena, &event, attribute, template, level + 1) == -1)
 						{
 							f_log(F_LOG_ERROR, "Event is null for attribute %s", attribute);
 							return NULL;
 						}
 
-						f_log(F_LOG_FINE, "Adding event %s to ast", event->name);
-						if (hoku_ast_add_event(init, event) == -1)
+						f_log(F_LOG_FINE, "Adding event %s to ast", event.name);
+						if (hoku_ast_add_event(init, &event) == -1)
 						{
 							f_log(F_LOG_ERROR, "Couldn't add event to %s", init->type);
 							return NULL;
@@ -268,19 +464,18 @@ hoku_ast* hoku_ast_walk_tree(TSNode node, char* template, int level)
 					}
 					else if (strcmp(atype, "style") == 0)
 					{
-						char* style_name = hoku_get_tag(attribute, template);
+						char* style_name = hoku_get_tag(arena, attribute, template);
 						if (style_name == NULL)
 						{
 							f_log(F_LOG_ERROR, "Style tag name is NULL");
 							return NULL;
 						}
-						f_log(F_LOG_FINE, "prepending style name %s to ast", style_name);
-						if (hoku_ast_style_list_prepend(init, style_name) != 0) return NULL;
-						free(style_name);
+						f_log(F_LOG_FINE, "appending style name %s to ast", style_name);
+						if (hoku_ast_style_list_append(init, style_name) != 0) return NULL;
 					}
 					else
 					{
-						hoku_ast_set_error(init, "Expecting `event` or `prop`", attribute, hoku_get_tag(attribute, template));
+						hoku_ast_set_error(init, "Expecting `event` or `prop`", attribute, hoku_get_tag(arena, attribute, template));
 					}
 					attribute = ts_node_next_named_sibling(attribute);
 				}
@@ -292,7 +487,7 @@ hoku_ast* hoku_ast_walk_tree(TSNode node, char* template, int level)
 				while (!ts_node_is_null(sel))
 				{	
 					const char* seltype = ts_node_type(sel);
-					char* seltag = hoku_get_tag(sel, template);
+					char* seltag = hoku_get_tag(arena, sel, template);
 					if (seltag == NULL)
 					{
 						f_log(F_LOG_ERROR, "selector tag is null!");
@@ -301,13 +496,11 @@ hoku_ast* hoku_ast_walk_tree(TSNode node, char* template, int level)
 
 					if (strcmp(seltype, "id") == 0)
 					{
-						init->id = strdup(seltag);
-						free(seltag);
+						init->id = seltag;
 					}
 					else if (strcmp(seltype, "class") == 0)
 					{
-						hoku_ast_class_list_prepend(init, seltag);
-						free(seltag);
+						if (hoku_ast_class_list_append(init, seltag) != 0) return NULL;
 					}
 
 					f_log(F_LOG_FINE, "Getting next selector sibling");
@@ -332,7 +525,7 @@ hoku_ast* hoku_ast_walk_tree(TSNode node, char* template, int level)
 					if(strcmp(ctype, "else_macro") != 0)
 					{
 
-						hoku_ast* cchild = hoku_ast_walk_tree(child, template, level + 1);
+						hoku_ast* cchild = hoku_ast_walk_tree(arena, child, template, level + 1);
 						if (cchild == NULL)
 						{
 							f_log(F_LOG_ERROR, "Ast child is NULL");
@@ -365,18 +558,18 @@ hoku_ast* hoku_ast_walk_tree(TSNode node, char* template, int level)
 	{
 		f_log(F_LOG_FINE, "Walking element tree");
 		TSNode child = ts_node_child(node, 0);
-		return hoku_ast_walk_tree(child, template, level + 1);
+		return hoku_ast_walk_tree(arena, child, template, level + 1);
 	}
 	else if (strcmp(ntype, "children") == 0)
 	{
 		f_log(F_LOG_FINE, "Walking children tree");
 		TSNode child = ts_node_child(node, 0);
-		return hoku_ast_walk_tree(child, template, level + 1);
+		return hoku_ast_walk_tree(arena, child, template, level + 1);
 	}
 	else if (strcmp(ntype, "for_macro") == 0)
 	{
 		TSNode child = ts_node_named_child(node, 0);
-		char* name = hoku_get_tag(child, template);
+		char* name = hoku_get_tag(arena, child, template);
 		if (name == NULL)
 		{
 			f_log(F_LOG_ERROR, "for macro name is null!");
@@ -384,7 +577,7 @@ hoku_ast* hoku_ast_walk_tree(TSNode node, char* template, int level)
 		}
 
 		TSNode sibling = ts_node_next_named_sibling(child);
-		char* list_name = hoku_get_tag(sibling, template);
+		char* list_name = hoku_get_tag(arena, sibling, template);
 		if (list_name == NULL)
 		{
 			f_log(F_LOG_ERROR, "for macro list name is null!");
@@ -392,18 +585,16 @@ hoku_ast* hoku_ast_walk_tree(TSNode node, char* template, int level)
 		}
 
 		hoku_ast_loop* loop;
-		if (hoku_ast_loop_init(&loop, name, list_name) == -1)
+		if (hoku_ast_loop_init(&loop, arena, name, list_name) == -1)
 		{
 			f_log(F_LOG_ERROR, "Failed to initialize loop %s %s", name, list_name);
 			return NULL;
 		}
 
-		free(name);
-		free(list_name);
 
 		TSNode children = ts_node_next_named_sibling(sibling);
 		f_log(F_LOG_DEBUG, "Walking loop children");
-		hoku_ast* ast = hoku_ast_walk_tree(children, template, level + 1);
+		hoku_ast* ast = hoku_ast_walk_tree(arena, children, template, level + 1);
 		if (ast == NULL)
 		{
 			f_log(F_LOG_ERROR, "Loop ast is null");
@@ -418,7 +609,7 @@ hoku_ast* hoku_ast_walk_tree(TSNode node, char* template, int level)
 	{
 		f_log(F_LOG_DEBUG, "Handling if macro");
 		TSNode child = ts_node_named_child(node, 0);
-		hoku_ast_func_call* call = hoku_ast_walk_func(child, template, level);
+		hoku_ast_func_call* call = hoku_ast_walk_func(arena, child, template, level);
 		if (call == NULL)
 		{
 			f_log(F_LOG_ERROR, "Func call for if macro is null");
@@ -426,7 +617,7 @@ hoku_ast* hoku_ast_walk_tree(TSNode node, char* template, int level)
 		}
 
 		hoku_ast_condition* cond;
-		if (hoku_ast_cond_init(&cond, call) == -1)
+		if (hoku_ast_cond_init(&cond, arena, call) == -1)
 		{
 			f_log(F_LOG_ERROR, "Condition for if macro is null");
 			return NULL;
@@ -434,7 +625,7 @@ hoku_ast* hoku_ast_walk_tree(TSNode node, char* template, int level)
 
 		TSNode ichildren = ts_node_next_named_sibling(child);
 
-		hoku_ast* iast = hoku_ast_walk_tree(ichildren, template, level + 1);
+		hoku_ast* iast = hoku_ast_walk_tree(arena, ichildren, template, level + 1);
 		if (iast == NULL)
 		{
 			f_log(F_LOG_ERROR, "If macro children ast is null");
@@ -456,14 +647,14 @@ hoku_ast* hoku_ast_walk_tree(TSNode node, char* template, int level)
 				TSNode eechildren = ts_node_named_child(echild, 0);
 				if (!ts_node_is_null(eechildren))
 				{
-					hoku_ast* oast = hoku_ast_walk_tree(eechildren, template, level + 1);
+					hoku_ast* oast = hoku_ast_walk_tree(arena, eechildren, template, level + 1);
 					if (oast == NULL)
 					{
 						f_log(F_LOG_ERROR, "Else cond children ast is null");
 						return NULL;
 					}
 
-					iast->else_relations = malloc(sizeof(hoku_ast_list));
+					iast->else_relations = hoku_arena_alloc(arena, sizeof(hoku_ast_list));
 					if (iast->else_relations == NULL) return NULL;
 
 					oast->parent = iast;
@@ -482,30 +673,28 @@ hoku_ast* hoku_ast_walk_tree(TSNode node, char* template, int level)
 	{
 		f_log(F_LOG_DEBUG, "Handling for/if macro");
 		TSNode child = ts_node_named_child(node, 0);
-		char* name = hoku_get_tag(child, template);
+		char* name = hoku_get_tag(arena, child, template);
 
 		TSNode sibling = ts_node_next_named_sibling(child);
-		char* list_name = hoku_get_tag(sibling, template);
+		char* list_name = hoku_get_tag(arena, sibling, template);
 		
 		TSNode if_func = ts_node_next_named_sibling(sibling);
-		hoku_ast_func_call* call = hoku_ast_walk_func(if_func, template, level);
+		hoku_ast_func_call* call = hoku_ast_walk_func(arena, if_func, template, level);
 
 		hoku_ast_condition* cond;
-		if (hoku_ast_cond_init(&cond, call) == -1)
+		if (hoku_ast_cond_init(&cond, arena, call) == -1)
 		{
 			return NULL;
 		}
 
 		hoku_ast_loop* loop;
-		if (hoku_ast_loop_init(&loop, name, list_name) == -1)
+		if (hoku_ast_loop_init(&loop, arena, name, list_name) == -1)
 		{
 			return NULL;
 		}
 
-    free(name);
-    free(list_name);
 		TSNode children = ts_node_next_named_sibling(if_func);
-		hoku_ast* ast = hoku_ast_walk_tree(children, template, level + 1);
+		hoku_ast* ast = hoku_ast_walk_tree(arena, children, template, level + 1);
 		ast->loop = loop;
 		ast->cond = cond;
 
@@ -518,8 +707,8 @@ hoku_ast* hoku_ast_walk_tree(TSNode node, char* template, int level)
 			if (strcmp(etype, "else_macro") == 0)
 			{
 				TSNode eechildren = ts_node_named_child(echild, 0);
-				hoku_ast* oast = hoku_ast_walk_tree(eechildren, template, level + 1);
-				ast->else_relations = malloc(sizeof(hoku_ast_list));
+				hoku_ast* oast = hoku_ast_walk_tree(arena, eechildren, template, level + 1);
+				ast->else_relations = hoku_arena_alloc(arena, sizeof(hoku_ast_list));
 				if (ast->else_relations == NULL) return NULL;
 
 				oast->parent = ast;
@@ -537,7 +726,7 @@ hoku_ast* hoku_ast_walk_tree(TSNode node, char* template, int level)
 	}
 }
 
-hoku_style_attribute* hoku_walk_style_attributes(TSNode node, char* template)
+hoku_style_attribute* hoku_walk_style_attributes(hoku_arena* arena, TSNode node, char* template)
 {
 	f_log(F_LOG_DEBUG, "walking attrs\n");
 	TSNode attribute_node = ts_node_named_child(node, 0);
@@ -546,7 +735,7 @@ hoku_style_attribute* hoku_walk_style_attributes(TSNode node, char* template)
 	while (!ts_node_is_null(attribute_node))
 	{
 		TSNode attribute_name_node = ts_node_named_child(attribute_node, 0);
-		char* attribute_name = hoku_get_tag(attribute_name_node, template);
+		char* attribute_name = hoku_get_tag(arena, attribute_name_node, template);
 		TSNode value_node;
 		value_node = ts_node_next_named_sibling(attribute_name_node);
 		const char* value_node_type = ts_node_type(value_node);
@@ -563,24 +752,24 @@ hoku_style_attribute* hoku_walk_style_attributes(TSNode node, char* template)
 		if (strcmp(value_node_type, "style_int") == 0)
 		{
 			type = HOKU_STYLE_TYPE_INT;
-			value = hoku_get_tag(value_node, template);
+			value = hoku_get_tag(arena, value_node, template);
 			
 		}
 		else if (strcmp(value_node_type, "style_float") == 0)
 		{
 			type = HOKU_STYLE_TYPE_FLOAT;
-			value = hoku_get_tag(value_node, template);
+			value = hoku_get_tag(arena, value_node, template);
 		}
 		else if (strcmp(value_node_type, "style_bool") == 0)
 		{
 			type = HOKU_STYLE_TYPE_BOOL;
-			value = hoku_get_tag(value_node, template);
+			value = hoku_get_tag(arena, value_node, template);
 
 		}
 		else if (strcmp(value_node_type, "style_string") == 0)
 		{
 			type = HOKU_STYLE_TYPE_STRING;
-			value = hoku_get_tag(value_node, template);
+			value = hoku_get_tag(arena, value_node, template);
 
 		}
 		else if (strcmp(value_node_type, "style_func") == 0)
@@ -588,10 +777,10 @@ hoku_style_attribute* hoku_walk_style_attributes(TSNode node, char* template)
 			type = HOKU_STYLE_TYPE_FUNC;
 			TSNode func_name_node = ts_node_named_child(value_node, 0);
 
-			function_name = hoku_get_tag(func_name_node, template);
+			function_name = hoku_get_tag(arena, func_name_node, template);
 
 			TSNode func_value_node = ts_node_next_named_sibling(func_name_node);
-			value = hoku_get_tag(func_value_node, template);
+			value = hoku_get_tag(arena, func_value_node, template);
 		}
 		else
 		{
@@ -600,22 +789,8 @@ hoku_style_attribute* hoku_walk_style_attributes(TSNode node, char* template)
 		}
 
 		hoku_style_attribute* attribute;
-		hoku_style_attribute_init(&attribute, attribute_name, value, type);
-		if (attribute == NULL) return NULL;
-
-		if (function_name)
-		{
-			// printf("setting func name!\n");
-			attribute->function_name = strdup(function_name);
-			if (attribute->function_name == NULL) return NULL;
-			free(function_name);
-			// printf("fter set func name\n");
-		}
-
-		free(attribute_name);
-		free(value);
-
-		// printf("after free!\n");
+		if (hoku_style_attribute_init(&attribute, arena, attribute_name, value, type) == -1) return NULL;
+		attribute->function_name = function_name;
 
 		if (top == NULL)
 		{
@@ -634,7 +809,7 @@ hoku_style_attribute* hoku_walk_style_attributes(TSNode node, char* template)
 	return top;
 }
 
-hoku_style* hoku_walk_style_template(TSNode node, char* template)
+hoku_style* hoku_walk_style_template(hoku_arena* arena, TSNode node, char* template)
 {
 	TSNode style_node = ts_node_named_child(node, 0);
 	hoku_style* top = NULL;
@@ -642,26 +817,22 @@ hoku_style* hoku_walk_style_template(TSNode node, char* template)
 	while (!ts_node_is_null(style_node))
 	{
 		TSNode style_name_node = ts_node_named_child(style_node, 0);
-		char* style_name = hoku_get_tag(style_name_node, template);
+		char* style_name = hoku_get_tag(arena, style_name_node, template);
 		hoku_style* style;
-		hoku_style_init(&style, style_name);
-		free(style_name);
-
-		if (style == NULL) return NULL;
+		if (hoku_style_init(&style, arena, style_name) == -1) return NULL;
 
 		char* event_name;
 		TSNode style_children_node = ts_node_next_named_sibling(style_name_node);
 		if (strcmp(ts_node_type(style_children_node), "event_name") == 0)
 		{
-			event_name = hoku_get_tag(style_children_node, template);
+			event_name = hoku_get_tag(arena, style_children_node, template);
 			style_children_node = ts_node_next_named_sibling(style_children_node);
-			style->event_name = strdup(event_name);
-			free(event_name);
+			style->event_name = event_name;
 		}
 
 
 		// printf("walking attributes!\n");
-		hoku_style_attribute* attributes = hoku_walk_style_attributes(style_children_node, template);
+		hoku_style_attribute* attributes = hoku_walk_style_attributes(arena, style_children_node, template);
 		// printf("after walk attributes!\n");
 		if (attributes == NULL) return NULL;
 		style->attributes = attributes;
@@ -683,25 +854,15 @@ hoku_style* hoku_walk_style_template(TSNode node, char* template)
 
 int hoku_style_from_template(hoku_style** out, char* template)
 {
-	TSParser* parser = ts_parser_new();
-	if (parser == NULL) return -1;
-
-	ts_parser_set_language(parser, tree_sitter_hml());
-	TSTree* tree = ts_parser_parse_string(parser, NULL, template, strlen(template));
+	TSTree* tree = hoku_parse(NULL, template);
 
 	f_log(F_LOG_DEBUG, "Done parsing style!");
-	if (tree == NULL)
-	{
-		ts_parser_delete(parser);
-		return -1;
-	}
+	if (tree == NULL) return -1;
 
 	TSNode document = ts_tree_root_node(tree);
 	if (strcmp(ts_node_type(document), "document") != 0)
 	{
 		ts_tree_delete(tree);
-		ts_parser_delete(parser);
-
 		return -1;
 	}
 
@@ -709,57 +870,56 @@ int hoku_style_from_template(hoku_style** out, char* template)
 	if (strcmp(ts_node_type(templ), "style_template") != 0)
 	{
 		ts_tree_delete(tree);
-		ts_parser_delete(parser);
+		return -1;
+	}
 
+	hoku_arena* arena;
+	if (hoku_arena_init(&arena, hoku_arena_size(template)) == -1)
+	{
+		ts_tree_delete(tree);
 		return -1;
 	}
 
 	f_log(F_LOG_DEBUG, "Walking style!");
-	hoku_style* style = hoku_walk_style_template(templ, template);
+	hoku_style* style = hoku_walk_style_template(arena, templ, template);
 	f_log(F_LOG_DEBUG, "Done walking style!");
-	// printf("after walk style!\n");
+	hoku_arena_count(arena);
 	if (style == NULL)
 	{
+		hoku_arena_free(arena);
 		ts_tree_delete(tree);
-		ts_parser_delete(parser);
-
 		return -1;
 	}
 
 	ts_tree_delete(tree);
-	ts_parser_delete(parser);
 	*out = style;
 	return 0;
 }
 
 int hoku_ast_from_template(hoku_ast** out, char* type, char* template)
 {
-	hoku_ast* init;
-	if (hoku_ast_init(&init, type) == -1)
+	hoku_arena* arena;
+	if (hoku_arena_init(&arena, hoku_arena_size(template)) == -1)
 	{
-		f_log(F_LOG_ERROR, "AST initialization failed.");
+		f_log(F_LOG_ERROR, "AST arena initialization failed.");
 		return -1;
 	}
 
-	hoku_style* style = NULL;
-
-	f_log(F_LOG_FINE, "Initializing parser.");
-	TSParser* parser = ts_parser_new();
-	if (parser == NULL)
+	hoku_ast* init;
+	char* root_type = hoku_arena_intern(arena, type, strlen(type));
+	if (root_type == NULL || hoku_ast_init(&init, arena, root_type) == -1)
 	{
-		f_log(F_LOG_ERROR, "Parser initialization failed.");
-		free(init);
+		f_log(F_LOG_ERROR, "AST initialization failed.");
+		hoku_arena_free(arena);
 		return -1;
 	}
 
 	f_log(F_LOG_FINE, "Parsing document.");
-	ts_parser_set_language(parser, tree_sitter_hml());
-	TSTree* tree = ts_parser_parse_string(parser, NULL, template, strlen(template));
+	TSTree* tree = hoku_parse(type, template);
 	if (tree == NULL)
 	{
 		f_log(F_LOG_ERROR, "TS Parser tree is NULL.");
-		ts_parser_delete(parser);
-		free(init);
+		hoku_ast_free(init);
 		return -1;
 	}
 
@@ -767,7 +927,8 @@ int hoku_ast_from_template(hoku_ast** out, char* type, char* template)
 	TSNode document = ts_tree_root_node(tree);
 	if (strcmp(ts_node_type(document), "document") != 0)
 	{
-		hoku_ast_set_error(init, "Expecting document (starts with [template])", document, hoku_get_tag(document, template));
+		hoku_ast_set_error(init, "Expecting document (starts with [template])", document, hoku_get_tag(arena, document, template));
+		ts_tree_delete(tree);
 		*out = init;
 		return 0;
 	}
@@ -777,7 +938,8 @@ int hoku_ast_from_template(hoku_ast** out, char* type, char* template)
 	if (strcmp(ts_node_type(templ), "template") != 0 && strcmp(ts_node_type(templ), "style_template") != 0)
 	{
 		f_log(F_LOG_DEBUG, "Document not expected.");
-		hoku_ast_set_error(init, "Expecting template", templ, hoku_get_tag(templ, template));
+		hoku_ast_set_error(init, "Expecting template", templ, hoku_get_tag(arena, templ, template));
+		ts_tree_delete(tree);
 		*out = init;
 		return 0;
 	}
@@ -785,13 +947,14 @@ int hoku_ast_from_template(hoku_ast** out, char* type, char* template)
 	f_log(F_LOG_FINE, "Checking style template");
 	if (strcmp(ts_node_type(templ), "style_template") == 0)
 	{
-		f_log(F_LOG_DEBUG, "Walking style template.");
-		style = hoku_walk_style_template(templ, template);
+		// templates don't keep their styles (see below), so it isn't walked
+		f_log(F_LOG_DEBUG, "Skipping style template.");
 		templ = ts_node_next_named_sibling(templ);
 
 		if (ts_node_is_null(templ) || strcmp(ts_node_type(templ), "template") != 0)
 		{
 			hoku_ast_set_error(init, "Expecting template, got only style template", templ, "ERROR");
+			ts_tree_delete(tree);
 			*out = init;
 			return 0;
 		}
@@ -810,7 +973,7 @@ int hoku_ast_from_template(hoku_ast** out, char* type, char* template)
 		if (strcmp(ntype, "else_macro") != 0)
 		{
 			hoku_ast* children;
-			children = hoku_ast_walk_tree(child, template, 0);
+			children = hoku_ast_walk_tree(arena, child, template, 0);
 
 			f_log(F_LOG_DEBUG, "Walked template children, %p", children);
 
@@ -852,15 +1015,14 @@ int hoku_ast_from_template(hoku_ast** out, char* type, char* template)
 	// if (!ts_node_is_null(templ) && strcmp(ts_node_type(templ), "style_template") == 0)
 	// {
 	// 	f_log(F_LOG_FINE, "walking style template\n");
-	// 	style = hoku_walk_style_template(templ, template);
+	// 	style = hoku_walk_style_template(arena, templ, template);
 	// }
 
 	// init->styles = style;
 
 	f_log(F_LOG_FINE, "delete tree");
 	ts_tree_delete(tree);
-	f_log(F_LOG_FINE, "delete parser");
-	ts_parser_delete(parser);
+	hoku_arena_count(arena);
 	f_log(F_LOG_FINE, "All done, exporting %p", init);
 	
 	init->is_root = true;
@@ -3,10 +3,49 @@
 
 #include "core-style.h"
 #include "core-ast.h"
+#include "core-arena.h"
 #include "core-log.h"
+#include "monotonic_timer.h"
+#include "hashmap.h"
+#include <stdbool.h>
+#include <stdint.h>
 
+/**
+  Templates parsed on the calling thread, how long the parsing took,
+  and the arena chunks and bytes their trees were walked into.
+  Incremental parses are the ones that edited a retained tree (see hoku_parser_retain)
+*/
+typedef struct HokuParseStats
+{
+  uint64_t parses;
+  uint64_t incremental;
+  uint64_t bytes;
+  double parse_ms;
+  uint64_t arena_chunks;
+  uint64_t arena_bytes;
+} hoku_parse_stats;
+
+/**
+  Both parse with one tree-sitter parser per thread,
+  created on first use and reset between templates
+*/
 int hoku_style_from_template(hoku_style** out, char* template);
 int hoku_ast_from_template(hoku_ast** out, char* type, char* template);
 void hoku_dump(hoku_ast* c, int level);
 
+hoku_parse_stats hoku_parse_stats_get(void);
+
+/**
+  While on, the calling thread keeps every template type's last source and tree-sitter tree,
+  and the next parse of that type edits the kept tree so only the changed range is re-parsed.
+  Turning it off drops the kept trees.
+*/
+void hoku_parser_retain(bool retain);
+
+/**
+  Deletes the calling thread's parser and kept trees.
+  Called when a worker's vm is done and at shutdown, the next parse on the thread makes a new parser.
+*/
+void hoku_parser_release(void);
+
 #endif
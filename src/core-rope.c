@@ -0,0 +1,467 @@
+#ifndef HOKU_CORE_ROPE
+#define HOKU_CORE_ROPE
+
+#include "core-rope.h"
+
+static uint32_t hoku_rope_random(hoku_rope* rope)
+{
+  // xorshift32
+  uint32_t x = rope->seed;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  rope->seed = x;
+  return x;
+}
+
+static inline size_t hoku_rope_total_chars(hoku_rope_node* node)
+{
+  return node == NULL ? 0 : node->total_chars;
+}
+
+static inline size_t hoku_rope_total_bytes(hoku_rope_node* node)
+{
+  return node == NULL ? 0 : node->total_bytes;
+}
+
+static inline size_t hoku_rope_total_newlines(hoku_rope_node* node)
+{
+  return node == NULL ? 0 : node->total_newlines;
+}
+
+static void hoku_rope_update(hoku_rope_node* node)
+{
+  node->total_chars = node->chars + hoku_rope_total_chars(node->left) + hoku_rope_total_chars(node->right);
+  node->total_bytes = node->bytes + hoku_rope_total_bytes(node->left) + hoku_rope_total_bytes(node->right);
+  node->total_newlines = node->newlines + hoku_rope_total_newlines(node->left) + hoku_rope_total_newlines(node->right);
+}
+
+static const char* hoku_rope_text(hoku_rope* rope, hoku_rope_node* node)
+{
+  return (node->source == HOKU_ROPE_ORIGINAL ? rope->original : rope->add) + node->byte_start;
+}
+
+static inline int hoku_rope_is_char(char byte)
+{
+  return (byte & 0xC0) != 0x80;
+}
+
+// byte index of character `chars` in text, and the newlines before it
+static size_t hoku_rope_seek(const char* text, size_t bytes, size_t chars, size_t* newlines)
+{
+  size_t seen = 0;
+  size_t lines = 0;
+  size_t i = 0;
+
+  for (; i<bytes; i++)
+  {
+    if (hoku_rope_is_char(text[i]))
+    {
+      if (seen == chars) break;
+      seen++;
+    }
+    if (text[i] == '\n') lines++;
+  }
+
+  if (newlines != NULL) *newlines = lines;
+  return i;
+}
+
+static hoku_rope_node* hoku_rope_node_new(hoku_rope* rope, int source, size_t byte_start, size_t bytes, size_t char_start, size_t chars, size_t newlines)
+{
+  hoku_rope_node* node = malloc(sizeof(hoku_rope_node));
+  if (node == NULL) return NULL;
+
+  node->left = NULL;
+  node->right = NULL;
+  node->priority = hoku_rope_random(rope);
+  node->source = source;
+  node->byte_start = byte_start;
+  node->bytes = bytes;
+  node->char_start = char_start;
+  node->chars = chars;
+  node->newlines = newlines;
+  hoku_rope_update(node);
+
+  return node;
+}
+
+static void hoku_rope_node_free(hoku_rope_node* node)
+{
+  if (node == NULL) return;
+
+  hoku_rope_node_free(node->left);
+  hoku_rope_node_free(node->right);
+  free(node);
+}
+
+static hoku_rope_node* hoku_rope_merge(hoku_rope_node* a, hoku_rope_node* b)
+{
+  if (a == NULL) return b;
+  if (b == NULL) return a;
+
+  if (a->priority > b->priority)
+  {
+    a->right = hoku_rope_merge(a->right, b);
+    hoku_rope_update(a);
+    return a;
+  }
+
+  b->left = hoku_rope_merge(a, b->left);
+  hoku_rope_update(b);
+  return b;
+}
+
+// left gets the first `chars` characters, right the rest
+static int hoku_rope_split(hoku_rope* rope, hoku_rope_node* node, size_t chars, hoku_rope_node** left, hoku_rope_node** right)
+{
+  if (node == NULL)
+  {
+    *left = NULL;
+    *right = NULL;
+    return 0;
+  }
+
+  size_t before = hoku_rope_total_chars(node->left);
+
+  if (chars <= before)
+  {
+    if (hoku_rope_split(rope, node->left, chars, left, &node->left) == -1) return -1;
+    hoku_rope_update(node);
+    *right = node;
+    return 0;
+  }
+
+  if (chars >= before + node->chars)
+  {
+    if (hoku_rope_split(rope, node->right, chars - before - node->chars, &node->right, right) == -1) return -1;
+    hoku_rope_update(node);
+    *left = node;
+    return 0;
+  }
+
+  // the cut falls inside this piece
+  size_t cut = chars - before;
+  size_t newlines;
+  size_t bytes = hoku_rope_seek(hoku_rope_text(rope, node), node->bytes, cut, &newlines);
+
+  hoku_rope_node* rest = hoku_rope_node_new(rope, node->source, node->byte_start + bytes, node->bytes - bytes, node->char_start + cut, node->chars - cut, node->newlines - newlines);
+  if (rest == NULL) return -1;
+
+  // rest takes this node's place above the right subtree
+  rest->priority = node->priority;
+  rest->right = node->right;
+  hoku_rope_update(rest);
+
+  node->bytes = bytes;
+  node->chars = cut;
+  node->newlines = newlines;
+  node->right = NULL;
+  hoku_rope_update(node);
+
+  *left = node;
+  *right = rest;
+  return 0;
+}
+
+// pieces for `bytes` of a buffer, at most HOKU_ROPE_MAX_PIECE characters each
+static int hoku_rope_build(hoku_rope* rope, int source, size_t byte_start, size_t char_start, size_t bytes, hoku_rope_node** out)
+{
+  const char* buffer = source == HOKU_ROPE_ORIGINAL ? rope->original : rope->add;
+  hoku_rope_node* tree = NULL;
+  size_t offset = 0;
+
+  while (offset < bytes)
+  {
+    size_t newlines;
+    size_t len = hoku_rope_seek(buffer + byte_start + offset, bytes - offset, HOKU_ROPE_MAX_PIECE, &newlines);
+    size_t chars = 0;
+    for (size_t i=0; i<len; i++) chars += hoku_rope_is_char(buffer[byte_start + offset + i]);
+
+    hoku_rope_node* node = hoku_rope_node_new(rope, source, byte_start + offset, len, char_start, chars, newlines);
+    if (node == NULL)
+    {
+      hoku_rope_node_free(tree);
+      return -1;
+    }
+
+    tree = hoku_rope_merge(tree, node);
+    offset += len;
+    char_start += chars;
+  }
+
+  *out = tree;
+  return 0;
+}
+
+int hoku_rope_init(hoku_rope** rope, const char* text, size_t bytes)
+{
+  hoku_rope* init = malloc(sizeof(hoku_rope));
+  if (init == NULL) return -1;
+
+  init->original = malloc(bytes + 1);
+  if (init->original == NULL)
+  {
+    free(init);
+    return -1;
+  }
+
+  memcpy(init->original, text, bytes);
+  init->original[bytes] = '\0';
+  init->original_bytes = bytes;
+  init->add = NULL;
+  init->add_bytes = 0;
+  init->add_chars = 0;
+  init->add_cap = 0;
+  init->seed = 2463534242u;
+  init->root = NULL;
+
+  if (hoku_rope_build(init, HOKU_ROPE_ORIGINAL, 0, 0, bytes, &init->root) == -1)
+  {
+    free(init->original);
+    free(init);
+    return -1;
+  }
+
+  init->original_chars = hoku_rope_total_chars(init->root);
+  *rope = init;
+  return 0;
+}
+
+size_t hoku_rope_chars(hoku_rope* rope)
+{
+  return hoku_rope_total_chars(rope->root);
+}
+
+size_t hoku_rope_bytes(hoku_rope* rope)
+{
+  return hoku_rope_total_bytes(rope->root);
+}
+
+size_t hoku_rope_lines(hoku_rope* rope)
+{
+  return hoku_rope_total_newlines(rope->root) + 1;
+}
+
+// grows the last piece of `node` when the new text directly follows it in the add buffer (typing)
+static int hoku_rope_extend_last(hoku_rope_node* node, size_t byte_start, size_t bytes, size_t chars, size_t newlines)
+{
+  if (node == NULL) return 0;
+
+  if (node->right != NULL)
+  {
+    if (!hoku_rope_extend_last(node->right, byte_start, bytes, chars, newlines)) return 0;
+  }
+  else
+  {
+    if (node->source != HOKU_ROPE_ADD || node->byte_start + node->bytes != byte_start) return 0;
+    if (node->chars + chars > HOKU_ROPE_MAX_PIECE) return 0;
+
+    node->bytes += bytes;
+    node->chars += chars;
+    node->newlines += newlines;
+  }
+
+  hoku_rope_update(node);
+  return 1;
+}
+
+int hoku_rope_insert(hoku_rope* rope, size_t offset, const char* text, size_t bytes)
+{
+  if (offset > hoku_rope_chars(rope)) return -1;
+  if (bytes == 0) return 0;
+
+  if (rope->add_bytes + bytes > rope->add_cap)
+  {
+    size_t cap = rope->add_cap == 0 ? 4096 : rope->add_cap;
+    while (cap < rope->add_bytes + bytes) cap *= 2;
+
+    char* add = realloc(rope->add, cap);
+    if (add == NULL) return -2;
+
+    rope->add = add;
+    rope->add_cap = cap;
+  }
+
+  size_t byte_start = rope->add_bytes;
+  memcpy(rope->add + byte_start, text, bytes);
+
+  hoku_rope_node* left;
+  hoku_rope_node* right;
+  if (hoku_rope_split(rope, rope->root, offset, &left, &right) == -1) return -2;
+
+  size_t newlines;
+  size_t chars = 0;
+  for (size_t i=0; i<bytes; i++) chars += hoku_rope_is_char(text[i]);
+  hoku_rope_seek(text, bytes, chars, &newlines);
+
+  if (hoku_rope_extend_last(left, byte_start, bytes, chars, newlines))
+  {
+    rope->root = hoku_rope_merge(left, right);
+  }
+  else
+  {
+    hoku_rope_node* middle;
+    if (hoku_rope_build(rope, HOKU_ROPE_ADD, byte_start, rope->add_chars, bytes, &middle) == -1)
+    {
+      rope->root = hoku_rope_merge(left, right);
+      return -2;
+    }
+
+    rope->root = hoku_rope_merge(hoku_rope_merge(left, middle), right);
+  }
+
+  rope->add_bytes += bytes;
+  rope->add_chars += chars;
+  return 0;
+}
+
+int hoku_rope_delete(hoku_rope* rope, size_t offset, size_t count)
+{
+  if (offset + count > hoku_rope_chars(rope)) return -1;
+  if (count == 0) return 0;
+
+  hoku_rope_node* left;
+  hoku_rope_node* middle;
+  hoku_rope_node* right;
+
+  if (hoku_rope_split(rope, rope->root, offset, &left, &right) == -1) return -2;
+  if (hoku_rope_split(rope, right, count, &middle, &right) == -1)
+  {
+    rope->root = hoku_rope_merge(left, right);
+    return -2;
+  }
+
+  hoku_rope_node_free(middle);
+  rope->root = hoku_rope_merge(left, right);
+  return 0;
+}
+
+static void hoku_rope_visit(hoku_rope* rope, hoku_rope_node* node, size_t base, size_t from, size_t to, hoku_rope_text_cb cb, void* data)
+{
+  if (node == NULL || from >= to) return;
+
+  size_t start = base + hoku_rope_total_chars(node->left);
+  size_t end = start + node->chars;
+
+  if (from < start) hoku_rope_visit(rope, node->left, base, from, to, cb, data);
+
+  if (from < end && to > start)
+  {
+    const char* text = hoku_rope_text(rope, node);
+    size_t a = from > start ? hoku_rope_seek(text, node->bytes, from - start, NULL) : 0;
+    size_t b = to < end ? hoku_rope_seek(text, node->bytes, to - start, NULL) : node->bytes;
+    if (b > a) cb(text + a, b - a, data);
+  }
+
+  if (to > end) hoku_rope_visit(rope, node->right, end, from, to, cb, data);
+}
+
+int hoku_rope_each(hoku_rope* rope, size_t offset, size_t count, hoku_rope_text_cb cb, void* data)
+{
+  if (offset + count > hoku_rope_chars(rope)) return -1;
+
+  hoku_rope_visit(rope, rope->root, 0, offset, offset + count, cb, data);
+  return 0;
+}
+
+static void hoku_rope_visit_pieces(hoku_rope_node* node, hoku_rope_piece_cb cb, void* data)
+{
+  if (node == NULL) return;
+
+  hoku_rope_visit_pieces(node->left, cb, data);
+  cb(node, data);
+  hoku_rope_visit_pieces(node->right, cb, data);
+}
+
+void hoku_rope_each_piece(hoku_rope* rope, hoku_rope_piece_cb cb, void* data)
+{
+  hoku_rope_visit_pieces(rope->root, cb, data);
+}
+
+size_t hoku_rope_line_at(hoku_rope* rope, size_t offset)
+{
+  hoku_rope_node* node = rope->root;
+  size_t lines = 0;
+
+  while (node != NULL)
+  {
+    size_t before = hoku_rope_total_chars(node->left);
+
+    if (offset < before)
+    {
+      node = node->left;
+      continue;
+    }
+
+    lines += hoku_rope_total_newlines(node->left);
+    offset -= before;
+
+    if (offset < node->chars)
+    {
+      size_t newlines;
+      hoku_rope_seek(hoku_rope_text(rope, node), node->bytes, offset, &newlines);
+      return lines + newlines;
+    }
+
+    lines += node->newlines;
+    offset -= node->chars;
+    node = node->right;
+  }
+
+  return lines;
+}
+
+long hoku_rope_line_offset(hoku_rope* rope, size_t line)
+{
+  if (line == 0) return 0;
+  if (line > hoku_rope_total_newlines(rope->root)) return -1;
+
+  hoku_rope_node* node = rope->root;
+  size_t offset = 0;
+
+  while (node != NULL)
+  {
+    size_t before = hoku_rope_total_newlines(node->left);
+
+    if (line <= before)
+    {
+      node = node->left;
+      continue;
+    }
+
+    line -= before;
+    offset += hoku_rope_total_chars(node->left);
+
+    if (line <= node->newlines)
+    {
+      // the character after this piece's line-th newline
+      const char* text = hoku_rope_text(rope, node);
+      size_t chars = 0;
+
+      for (size_t i=0; i<node->bytes; i++)
+      {
+        if (hoku_rope_is_char(text[i])) chars++;
+        if (text[i] == '\n' && --line == 0) return offset + chars;
+      }
+    }
+
+    line -= node->newlines;
+    offset += node->chars;
+    node = node->right;
+  }
+
+  return -1;
+}
+
+void hoku_rope_free(hoku_rope* rope)
+{
+  if (rope == NULL) return;
+
+  hoku_rope_node_free(rope->root);
+  free(rope->original);
+  free(rope->add);
+  free(rope);
+}
+
+#endif
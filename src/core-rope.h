@@ -0,0 +1,103 @@
+#ifndef HOKU_CORE_ROPE_H
+#define HOKU_CORE_ROPE_H
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+// longest piece in characters, keeps offset lookups inside a piece short
+#define HOKU_ROPE_MAX_PIECE 1024
+
+enum HOKU_ROPE_SOURCE
+{
+  HOKU_ROPE_ORIGINAL,
+  HOKU_ROPE_ADD
+};
+
+/**
+  A piece of one of the rope's buffers, and the totals of its subtree.
+  Characters are UTF-8 codepoints.
+*/
+typedef struct HokuRopeNode
+{
+  struct HokuRopeNode* left;
+  struct HokuRopeNode* right;
+  uint32_t priority;
+  int source;
+  size_t byte_start;
+  size_t bytes;
+  size_t char_start;
+  size_t chars;
+  size_t newlines;
+  size_t total_bytes;
+  size_t total_chars;
+  size_t total_newlines;
+} hoku_rope_node;
+
+/**
+  A piece table kept as a treap ordered by text position.
+
+  Text is never copied once it is in: the original buffer is read only,
+  inserts append to the add buffer, and the tree only rearranges pieces.
+  Every node caches its subtree's bytes, characters and newlines,
+  so insert, delete, offset <-> line and range lookups are O(log n).
+*/
+typedef struct HokuRope
+{
+  hoku_rope_node* root;
+  char* original;
+  size_t original_bytes;
+  size_t original_chars;
+  char* add;
+  size_t add_bytes;
+  size_t add_chars;
+  size_t add_cap;
+  uint32_t seed;
+} hoku_rope;
+
+typedef void (*hoku_rope_text_cb)(const char* text, size_t bytes, void* data);
+typedef void (*hoku_rope_piece_cb)(hoku_rope_node* node, void* data);
+
+int hoku_rope_init(hoku_rope** rope, const char* text, size_t bytes);
+
+size_t hoku_rope_chars(hoku_rope* rope);
+size_t hoku_rope_bytes(hoku_rope* rope);
+size_t hoku_rope_lines(hoku_rope* rope);
+
+/**
+  Inserts `text` before character `offset`
+  @return 0 on success, -1 when offset is past the end, -2 when out of memory
+*/
+int hoku_rope_insert(hoku_rope* rope, size_t offset, const char* text, size_t bytes);
+
+/**
+  Removes `count` characters from `offset`
+  @return 0 on success, -1 when the range is past the end
+*/
+int hoku_rope_delete(hoku_rope* rope, size_t offset, size_t count);
+
+/**
+  Calls `cb` with each run of text in [offset, offset + count), in order
+  @return -1 when the range is past the end
+*/
+int hoku_rope_each(hoku_rope* rope, size_t offset, size_t count, hoku_rope_text_cb cb, void* data);
+
+/**
+  Calls `cb` with every piece, in order
+*/
+void hoku_rope_each_piece(hoku_rope* rope, hoku_rope_piece_cb cb, void* data);
+
+/**
+  The line (0 based) that character `offset` is on
+*/
+size_t hoku_rope_line_at(hoku_rope* rope, size_t offset);
+
+/**
+  The character offset where `line` starts
+  @return -1 when there is no such line
+*/
+long hoku_rope_line_offset(hoku_rope* rope, size_t line);
+
+void hoku_rope_free(hoku_rope* rope);
+
+#endif
@@ -4,6 +4,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include "core-arena.h"
 
 enum HOKU_STYLE_TYPE
 {
@@ -30,13 +31,21 @@ typedef struct HmlStyle
   char* event_name;
   struct HmlStyleAttribute* attributes;
   struct HmlStyle* next;
+  struct HokuArena* arena;
 } hoku_style;
 
-int hoku_style_init(hoku_style** style, char* name);
-int hoku_style_attribute_init(hoku_style_attribute** attribute, char* name, char* value, enum HOKU_STYLE_TYPE type);
+/**
+  Like ast trees, a style list and its attributes live in one arena,
+  and the strings passed to the init functions must come from it.
+*/
+int hoku_style_init(hoku_style** style, hoku_arena* arena, char* name);
+int hoku_style_attribute_init(hoku_style_attribute** attribute, hoku_arena* arena, char* name, char* value, enum HOKU_STYLE_TYPE type);
 void hoku_style_append(hoku_style* style, hoku_style* next);
 void hoku_style_attribute_append(hoku_style_attribute* attribute, hoku_style_attribute* next);
-void hoku_style_attribute_free(hoku_style_attribute* attribute);
+
+/**
+  Frees the arena of style's list, and with it every style in the list
+*/
 void hoku_style_free(hoku_style* style);
 
 #endif
\ No newline at end of file
@@ -2,70 +2,244 @@
 #define HOKUSAI_POCKET_FONT
 
 #include "font.h"
+#include "wrap.h"
 #include <mruby.h>
 #include <mruby/hash.h>
 #include <mruby/proc.h>
 
 static char* default_codepoints = "–—‘’“”…\r\n\t 0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ!@#$%%^&*(),.?/\"\\[]-_=+|~`{}<>;:'\0";
 
+static void hp_font_advances_unload(hp_font_advances* advances)
+{
+  free(advances->codepoints);
+  free(advances->widths);
+  advances->codepoints = NULL;
+  advances->widths = NULL;
+  advances->len = 0;
+}
+
 static void hp_font_type_free(mrb_state* mrb, void* payload)
 {
   hp_font_wrapper* wrapper = (hp_font_wrapper*) payload;
-  UnloadFont(wrapper->font);
+  if (wrapper == NULL) return;
+
+  hp_font_advances_unload(&wrapper->advances);
+  if (wrapper->glyphs) hp_glyph_atlas_free(wrapper->glyphs);
+  if (wrapper->measures) hp_measure_cache_free(wrapper->measures);
+  // a font that failed to load has nothing to unload
+  if (wrapper->font.glyphs) UnloadFont(wrapper->font);
   mrb_free(mrb, payload);
 }
 
 static struct mrb_data_type hp_font_type = { "Font", hp_font_type_free };
 
-hp_font_wrapper* hp_font_get(mrb_state* mrb, mrb_value self)
+static float hp_font_glyph_width(GlyphInfo info)
 {
-  hp_font_wrapper* wrapper;
-  wrapper = DATA_GET_PTR(mrb, self, &hp_font_type, hp_font_wrapper);
-  if (!wrapper) {
-    mrb_raise(mrb, E_ARGUMENT_ERROR , "uninitialized ast data") ;
+  if (info.advanceX > 0) return 1.0 * info.advanceX;
+
+  return 1.0 * (info.image.width + info.offsetX);
+}
+
+static int hp_font_codepoint_compare(const void* a, const void* b)
+{
+  return *(const int*)a - *(const int*)b;
+}
+
+static void hp_font_advances_load(hp_font_advances* advances, Font font)
+{
+  for (int i=0; i<128; i++) advances->ascii[i] = -1.0;
+  advances->codepoints = NULL;
+  advances->widths = NULL;
+  advances->len = 0;
+
+  int rest = 0;
+  for (int i=0; i<font.glyphCount; i++)
+  {
+    int codepoint = font.glyphs[i].value;
+    if (codepoint >= 0 && codepoint < 128)
+    {
+      advances->ascii[codepoint] = hp_font_glyph_width(font.glyphs[i]);
+    }
+    else
+    {
+      rest++;
+    }
+  }
+
+  if (rest == 0) return;
+
+  advances->codepoints = malloc(sizeof(int) * rest);
+  advances->widths = malloc(sizeof(float) * rest);
+  if (advances->codepoints == NULL || advances->widths == NULL)
+  {
+    hp_font_advances_unload(advances);
+    return;
+  }
+
+  for (int i=0; i<font.glyphCount; i++)
+  {
+    int codepoint = font.glyphs[i].value;
+    if (codepoint < 0 || codepoint >= 128) advances->codepoints[advances->len++] = codepoint;
+  }
+
+  qsort(advances->codepoints, advances->len, sizeof(int), hp_font_codepoint_compare);
+
+  for (int i=0; i<advances->len; i++)
+  {
+    advances->widths[i] = hp_font_glyph_width(GetGlyphInfo(font, advances->codepoints[i]));
   }
-  
-  return wrapper;
 }
 
-mrb_value hp_font_default(mrb_state* mrb, mrb_value self)
+static int hp_font_advances_add(hp_font_advances* advances, int codepoint, float width)
+{
+  if (codepoint >= 0 && codepoint < 128)
+  {
+    advances->ascii[codepoint] = width;
+    return 0;
+  }
+
+  int* codepoints = realloc(advances->codepoints, sizeof(int) * (advances->len + 1));
+  if (codepoints == NULL) return -1;
+  advances->codepoints = codepoints;
+
+  float* widths = realloc(advances->widths, sizeof(float) * (advances->len + 1));
+  if (widths == NULL) return -1;
+  advances->widths = widths;
+
+  int at = 0;
+  while (at < advances->len && advances->codepoints[at] < codepoint) at++;
+
+  memmove(&advances->codepoints[at + 1], &advances->codepoints[at], sizeof(int) * (advances->len - at));
+  memmove(&advances->widths[at + 1], &advances->widths[at], sizeof(float) * (advances->len - at));
+  advances->codepoints[at] = codepoint;
+  advances->widths[at] = width;
+  advances->len++;
+
+  return 0;
+}
+
+/* bakes a glyph into a dynamic font, returns its width at the font's size or -1 */
+static float hp_font_rasterize(hp_font_wrapper* wrapper, int codepoint)
+{
+  if (wrapper->glyphs == NULL || codepoint <= 0) return -1.0;
+
+  int index = hp_glyph_atlas_add(wrapper->glyphs, &wrapper->font, codepoint);
+  if (index == -1) return -1.0;
+
+  float w = hp_font_glyph_width(wrapper->font.glyphs[index]);
+  if (hp_font_advances_add(&wrapper->advances, codepoint, w) == -1) return -1.0;
+  // the fallback glyph may be a different one now
+  wrapper->missing = -1.0;
+
+  return w;
+}
+
+void hp_font_prepare(hp_font_wrapper* wrapper, const char* text, size_t bytes)
+{
+  if (wrapper->glyphs == NULL) return;
+
+  for (size_t i=0; i<bytes;)
+  {
+    int len;
+    int codepoint = GetCodepointNext(text + i, &len);
+    i += len > 0 ? len : 1;
+
+    if (codepoint >= 0 && codepoint < 128 && wrapper->advances.ascii[codepoint] >= 0) continue;
+    hp_font_advance(wrapper, codepoint, wrapper->size);
+  }
+}
+
+float hp_font_advance(hp_font_wrapper* wrapper, int codepoint, int size)
+{
+  float w = -1.0;
+
+  if (codepoint >= 0 && codepoint < 128)
+  {
+    w = wrapper->advances.ascii[codepoint];
+  }
+  else if (wrapper->advances.len > 0)
+  {
+    int* found = bsearch(&codepoint, wrapper->advances.codepoints, wrapper->advances.len, sizeof(int), hp_font_codepoint_compare);
+    if (found != NULL) w = wrapper->advances.widths[found - wrapper->advances.codepoints];
+  }
+
+  if (w < 0) w = hp_font_rasterize(wrapper, codepoint);
+  if (w < 0) return -1.0;
+
+  float base_size = 1.0 * wrapper->size;
+  return ((1.0 * size) / base_size) * w + 1.0;
+}
+
+float hp_font_draw_width(hp_font_wrapper* wrapper, int codepoint, int size)
+{
+  float w = hp_font_advance(wrapper, codepoint, size);
+  if (w >= 0) return w;
+
+  // raylib falls back to the same glyph for every codepoint it doesn't have
+  if (wrapper->missing < 0) wrapper->missing = hp_font_glyph_width(GetGlyphInfo(wrapper->font, codepoint));
+
+  float base_size = 1.0 * wrapper->size;
+  return ((1.0 * size) / base_size) * wrapper->missing + 1.0;
+}
+
+/* a Font object with nothing loaded yet, so whatever raises after this leaves nothing behind */
+static mrb_value hp_font_new(mrb_state* mrb, mrb_value klass, int size)
 {
   hp_font_wrapper* wrapper;
-  Font font = GetFontDefault();
-  mrb_value obj = mrb_funcall_argv(mrb, self, mrb_intern_lit(mrb, "new"), 0, NULL);
+  mrb_value obj = mrb_funcall(mrb, klass, "new", 0, NULL);
   wrapper = (hp_font_wrapper*)DATA_PTR(obj);
   if (wrapper) mrb_free(mrb, wrapper);
   mrb_data_init(obj, NULL, &hp_font_type);
 
   wrapper = mrb_malloc(mrb, sizeof(hp_font_wrapper));
-  wrapper->font = font;
-  wrapper->size = 14;
+  *wrapper = (hp_font_wrapper){ .size = size, .glyphs = NULL, .measures = NULL, .missing = -1.0 };
 
   DATA_TYPE(obj) = &hp_font_type;
   DATA_PTR(obj) = wrapper;
   return obj;
 }
 
+/* hands a loaded font to the wrapper, which unloads it from then on */
+static void hp_font_set(hp_font_wrapper* wrapper, Font font)
+{
+  wrapper->font = font;
+  // measuring still works uncached if this fails
+  if (hp_measure_cache_init(&wrapper->measures, HP_MEASURE_CACHE_DEFAULT_CAPACITY) != 0) wrapper->measures = NULL;
+  hp_font_advances_load(&wrapper->advances, font);
+}
+
+static mrb_value hp_font_wrap(mrb_state* mrb, mrb_value klass, Font font, int size)
+{
+  mrb_value obj = hp_font_new(mrb, klass, size);
+  hp_font_set((hp_font_wrapper*) DATA_PTR(obj), font);
+  return obj;
+}
+
+hp_font_wrapper* hp_font_get(mrb_state* mrb, mrb_value self)
+{
+  hp_font_wrapper* wrapper;
+  wrapper = DATA_GET_PTR(mrb, self, &hp_font_type, hp_font_wrapper);
+  if (!wrapper) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR , "uninitialized ast data") ;
+  }
+  
+  return wrapper;
+}
+
+mrb_value hp_font_default(mrb_state* mrb, mrb_value self)
+{
+  Font font = GetFontDefault();
+  return hp_font_wrap(mrb, self, font, 14);
+}
+
 mrb_value hp_font_from(mrb_state* mrb, mrb_value self)
 {
   mrb_value path;
   mrb_get_args(mrb, "S", &path);
   char* cpath = mrb_str_to_cstr(mrb, path);
 
-  hp_font_wrapper* wrapper;
   Font font = LoadFont(cpath);
-  mrb_value obj = mrb_funcall(mrb, self, "new", 0, NULL);
-  wrapper = (hp_font_wrapper*)DATA_PTR(obj);
-  if (wrapper) mrb_free(mrb, wrapper);
-  mrb_data_init(obj, NULL, &hp_font_type);
-
-  wrapper = mrb_malloc(mrb, sizeof(hp_font_wrapper));
-  wrapper->font = font;
-  wrapper->size = 14;
-
-  DATA_TYPE(obj) = &hp_font_type;
-  DATA_PTR(obj) = wrapper;
-  return obj;
+  return hp_font_wrap(mrb, self, font, 14);
 }
 
 mrb_value hp_font_from_ext(mrb_state* mrb, mrb_value self)
@@ -93,21 +267,51 @@ mrb_value hp_font_from_ext(mrb_state* mrb, mrb_value self)
   SetTextureFilter(font.texture, TEXTURE_FILTER_POINT);
   UnloadCodepoints(codepoints);
 
-  hp_font_wrapper* wrapper;
-  mrb_value obj = mrb_funcall(mrb, self, "new", 0, NULL);
-  wrapper = (hp_font_wrapper*)DATA_PTR(obj);
-  if (wrapper) mrb_free(mrb, wrapper);
-  mrb_data_init(obj, NULL, &hp_font_type);
+  return hp_font_wrap(mrb, self, font, size);
+}
 
-  wrapper = mrb_malloc(mrb, sizeof(hp_font_wrapper));
-  wrapper->font = font;
-  wrapper->size = size;
+static mrb_value hp_font_load_atlas(mrb_state* mrb, mrb_value self, int type, mrb_int default_size)
+{
+  mrb_value path;
+  mrb_int size = default_size;
+  char* codepoint_str = default_codepoints;
+  mrb_get_args(mrb, "S|iz", &path, &size, &codepoint_str);
+
+  // everything that can raise comes before the codepoints and glyphs are allocated
+  char* cpath = mrb_str_to_cstr(mrb, path);
+  mrb_value obj = hp_font_new(mrb, self, size);
+  hp_font_wrapper* wrapper = (hp_font_wrapper*) DATA_PTR(obj);
+
+  int count;
+  int* codepoints = LoadCodepoints(codepoint_str, &count);
+  Font font;
+  hp_glyph_atlas* glyphs;
+  int status = hp_glyph_atlas_load(&glyphs, &font, cpath, size, codepoints, count, type);
+  UnloadCodepoints(codepoints);
+
+  if (status == -1) mrb_raisef(mrb, E_ARGUMENT_ERROR, "Cannot load font %v", path);
+
+  hp_font_set(wrapper, font);
+  wrapper->glyphs = glyphs;
 
-  DATA_TYPE(obj) = &hp_font_type;
-  DATA_PTR(obj) = wrapper;
   return obj;
 }
 
+mrb_value hp_font_dynamic(mrb_state* mrb, mrb_value self)
+{
+  return hp_font_load_atlas(mrb, self, FONT_DEFAULT, 14);
+}
+
+mrb_value hp_font_from_sdf(mrb_state* mrb, mrb_value self)
+{
+  return hp_font_load_atlas(mrb, self, FONT_SDF, HP_FONT_SDF_SIZE);
+}
+
+bool hp_font_sdf(hp_font_wrapper* wrapper)
+{
+  return wrapper->glyphs != NULL && wrapper->glyphs->type == FONT_SDF;
+}
+
 float hp_font_spacing(int height, hp_font_wrapper* wrapper)
 {
   int size = height;//wrapper->size;
@@ -122,67 +326,244 @@ mrb_value hp_font_measure(mrb_state* mrb, mrb_value self)
   mrb_value height;
   mrb_get_args(mrb, "So", &str, &height);
 
-  mrb_value arr = mrb_ary_new_capa(mrb, 2);
   hp_font_wrapper* wrapper = hp_font_get(mrb, self);
-  char* cstr = mrb_str_to_cstr(mrb, str);
   int h = mrb_int(mrb, height);
+  size_t bytes = RSTRING_LEN(str);
+  uint64_t hash = 0;
+  Vector2 vec2;
+
+  if (wrapper->measures) hash = hp_measure_cache_hash(RSTRING_PTR(str), bytes);
+
+  if (wrapper->measures == NULL || !hp_measure_cache_get(wrapper->measures, hash, bytes, h, &vec2))
+  {
+    char* cstr = mrb_str_to_cstr(mrb, str);
+    hp_font_prepare(wrapper, cstr, bytes);
+    vec2 = MeasureTextEx(wrapper->font, cstr, h, hp_font_spacing(h, wrapper));
 
-  Vector2 vec2 = MeasureTextEx(wrapper->font, cstr, h, hp_font_spacing(h, wrapper));
+    if (wrapper->measures) hp_measure_cache_put(wrapper->measures, hash, bytes, h, vec2);
+  }
 
-  mrb_ary_push(mrb, arr, mrb_float_value(mrb, vec2.x));
-  mrb_ary_push(mrb, arr, mrb_float_value(mrb, vec2.y));
-  return arr;
+  mrb_value measured[2] = { mrb_float_value(mrb, vec2.x), mrb_float_value(mrb, vec2.y) };
+  return mrb_ary_new_from_values(mrb, 2, measured);
 }
 
 mrb_value hp_font_measure_char(mrb_state* mrb, mrb_value self)
 {
-
   mrb_value chr;
   mrb_value size;
   mrb_get_args(mrb, "So", &chr, &size);
 
+  hp_font_wrapper* wrapper = hp_font_get(mrb, self);
+  if (RSTRING_LEN(chr) == 0) return mrb_nil_value();
+
+  int bytes;
+  int codepoint = GetCodepoint(RSTRING_PTR(chr), &bytes);
+  float w = hp_font_advance(wrapper, codepoint, mrb_integer(size));
+  if (w < 0) return mrb_nil_value();
+
+  return mrb_float_value(mrb, w);
+}
+
+/* packed native floats, one per character, read back with unpack("f*"). a passed buffer is reused */
+mrb_value hp_font_measure_run(mrb_state* mrb, mrb_value self)
+{
+  mrb_value str;
+  mrb_int size;
+  mrb_value buffer = mrb_nil_value();
+  mrb_get_args(mrb, "Si|S!", &str, &size, &buffer);
+
+  hp_font_wrapper* wrapper = hp_font_get(mrb, self);
+  mrb_int len = RSTRING_LEN(str);
+
+  // at most one char per byte
+  if (mrb_nil_p(buffer)) buffer = mrb_str_new_capa(mrb, sizeof(float) * len);
+  else mrb_str_modify(mrb, mrb_str_ptr(buffer));
+  mrb_str_resize(mrb, buffer, sizeof(float) * len);
+
+  const char* cstr = RSTRING_PTR(str);
+  char* widths = RSTRING_PTR(buffer);
+  mrb_int count = 0;
+
+  for (mrb_int i=0; i<len;)
+  {
+    int bytes;
+    int codepoint = GetCodepointNext(cstr + i, &bytes);
+    float w = hp_font_draw_width(wrapper, codepoint, size);
+
+    memcpy(widths + sizeof(float) * count++, &w, sizeof(float));
+    i += bytes > 0 ? bytes : 1;
+  }
+
+  mrb_str_resize(mrb, buffer, sizeof(float) * count);
+  return buffer;
+}
+
+mrb_value hp_font_pack_glyphs(mrb_state* mrb, mrb_value self)
+{
+  mrb_value buffer;
+  mrb_value str;
+  mrb_float x;
+  mrb_float y;
+  mrb_int size;
+  mrb_get_args(mrb, "SSffi", &buffer, &str, &x, &y, &size);
+  mrb_str_modify(mrb, mrb_str_ptr(buffer));
+
+  hp_font_wrapper* wrapper = hp_font_get(mrb, self);
+  const char* cstr = RSTRING_PTR(str);
+  mrb_int len = RSTRING_LEN(str);
+  // placed like DrawTextEx at the position Commands::Text draws from
+  float start = (float)(int) x;
+  float gx = start;
+  float gy = (float)(int) y;
+  // the widest line, which is what bounds the run
+  float right = gx;
+
+  for (mrb_int i=0; i<len;)
+  {
+    int bytes;
+    int codepoint = GetCodepointNext(cstr + i, &bytes);
+    i += bytes > 0 ? bytes : 1;
+
+    if (codepoint == '\n')
+    {
+      if (gx > right) right = gx;
+      gx = start;
+      gy += size + HP_FONT_LINE_SPACING;
+      continue;
+    }
+
+    float w = hp_font_draw_width(wrapper, codepoint, size);
+
+    if (codepoint != ' ' && codepoint != '\t')
+    {
+      hp_font_glyph glyph = { codepoint, gx, gy };
+      mrb_str_cat(mrb, buffer, (const char*) &glyph, sizeof(hp_font_glyph));
+    }
+
+    gx += w;
+  }
+
+  if (gx > right) right = gx;
+  return mrb_float_value(mrb, right);
+}
+
+mrb_value hp_font_wrap_text(mrb_state* mrb, mrb_value self)
+{
+  mrb_value str;
+  mrb_int size;
+  mrb_float width;
+  mrb_value rboundaries = mrb_nil_value();
+  mrb_get_args(mrb, "Sif|A!", &str, &size, &width, &rboundaries);
+
   hp_font_wrapper* wrapper = hp_font_get(mrb, self);
 
-  mrb_value map;
-  map = mrb_iv_get(mrb, self, mrb_intern_lit(mrb, "@measure_map"));
-  if (mrb_nil_p(map))
+  mrb_int boundary_len = mrb_nil_p(rboundaries) ? 0 : RARRAY_LEN(rboundaries);
+  // on the heap, the array can be any size. freed before anything below can raise
+  int* boundaries = mrb_malloc(mrb, sizeof(int) * (boundary_len + 1));
+  for (mrb_int i=0; i<boundary_len; i++)
   {
-    map = mrb_hash_new(mrb);
-    for (int i=0; i<strlen(default_codepoints); i++)
+    mrb_value entry = mrb_ary_entry(rboundaries, i);
+    if (!mrb_integer_p(entry))
+    {
+      mrb_free(mrb, boundaries);
+      mrb_raise(mrb, E_TYPE_ERROR, "Boundaries must be Integers");
+    }
+
+    mrb_int boundary = mrb_as_int(mrb, entry);
+    if (boundary < 0 || boundary > RSTRING_LEN(str))
     {
-      char target[2];
-      sprintf(target, "%c", default_codepoints[i]);
-      float w;
-      int bcount;
-      int letter = GetCodepoint(target, &bcount);
-      GlyphInfo info = GetGlyphInfo(wrapper->font, letter);
-      
-      if (info.advanceX > 0)
-      {
-        w = (1.0 * info.advanceX);
-      }
-      else
-      {
-        w = 1.0 * (info.image.width + info.offsetX);
-      }
-
-      float base_size = 1.0 * wrapper->size;
-      mrb_value arr = mrb_ary_new(mrb);
-      mrb_ary_set(mrb, arr, 0, mrb_float_value(mrb, base_size));
-      mrb_ary_set(mrb, arr, 1, mrb_float_value(mrb, w));
-
-      mrb_hash_set(mrb, map, mrb_str_new_cstr(mrb, target), arr);
+      mrb_free(mrb, boundaries);
+      mrb_raisef(mrb, E_ARGUMENT_ERROR, "Boundary %i is outside of the text", boundary);
     }
-    mrb_iv_set(mrb, self, mrb_intern_lit(mrb, "@measure_map"), map);
+
+    boundaries[i] = (int) boundary;
+  }
+
+  hp_wrap_result result;
+  int status = hp_wrap(wrapper, size, RSTRING_PTR(str), RSTRING_LEN(str), width, boundaries, (int) boundary_len, &result);
+  mrb_free(mrb, boundaries);
+
+  if (status == -1)
+  {
+    mrb_raise(mrb, E_STANDARD_ERROR, "Cannot allocate wrapped text");
+  }
+
+  mrb_value tokens = mrb_ary_new_capa(mrb, result.len * 6);
+  mrb_value widths = mrb_ary_new_capa(mrb, result.chars);
+  int ai = mrb_gc_arena_save(mrb);
+
+  for (int i=0; i<result.len; i++)
+  {
+    hp_wrap_token token = result.tokens[i];
+    mrb_ary_push(mrb, tokens, mrb_str_new(mrb, RSTRING_PTR(str) + token.byte_start, token.byte_length));
+    mrb_ary_push(mrb, tokens, mrb_int_value(mrb, token.start));
+    mrb_ary_push(mrb, tokens, mrb_int_value(mrb, token.length));
+    mrb_ary_push(mrb, tokens, mrb_float_value(mrb, token.x));
+    mrb_ary_push(mrb, tokens, mrb_float_value(mrb, token.width));
+    mrb_ary_push(mrb, tokens, mrb_int_value(mrb, token.line));
+    mrb_gc_arena_restore(mrb, ai);
+  }
+
+  for (int i=0; i<result.chars; i++)
+  {
+    mrb_ary_push(mrb, widths, mrb_float_value(mrb, result.widths[i]));
+    mrb_gc_arena_restore(mrb, ai);
+  }
+
+  mrb_value out[3] = { tokens, widths, mrb_int_value(mrb, result.breaks) };
+  hp_wrap_result_free(&result);
+
+  return mrb_ary_new_from_values(mrb, 3, out);
+}
+
+mrb_value hp_font_glyph_count(mrb_state* mrb, mrb_value self)
+{
+  hp_font_wrapper* wrapper = hp_font_get(mrb, self);
+  return mrb_int_value(mrb, wrapper->font.glyphCount);
+}
+
+mrb_value hp_font_is_dynamic(mrb_state* mrb, mrb_value self)
+{
+  hp_font_wrapper* wrapper = hp_font_get(mrb, self);
+  return mrb_bool_value(wrapper->glyphs != NULL);
+}
+
+mrb_value hp_font_is_sdf(mrb_state* mrb, mrb_value self)
+{
+  return mrb_bool_value(hp_font_sdf(hp_font_get(mrb, self)));
+}
+
+mrb_value hp_font_measure_stats(mrb_state* mrb, mrb_value self)
+{
+  hp_font_wrapper* wrapper = hp_font_get(mrb, self);
+  hp_measure_cache* cache = wrapper->measures;
+  mrb_value stats = mrb_hash_new(mrb);
+
+  mrb_hash_set(mrb, stats, mrb_symbol_value(mrb_intern_lit(mrb, "hits")), mrb_int_value(mrb, cache ? (mrb_int) cache->hits : 0));
+  mrb_hash_set(mrb, stats, mrb_symbol_value(mrb_intern_lit(mrb, "misses")), mrb_int_value(mrb, cache ? (mrb_int) cache->misses : 0));
+  mrb_hash_set(mrb, stats, mrb_symbol_value(mrb_intern_lit(mrb, "evictions")), mrb_int_value(mrb, cache ? (mrb_int) cache->evictions : 0));
+  mrb_hash_set(mrb, stats, mrb_symbol_value(mrb_intern_lit(mrb, "entries")), mrb_int_value(mrb, cache ? cache->len : 0));
+  mrb_hash_set(mrb, stats, mrb_symbol_value(mrb_intern_lit(mrb, "capacity")), mrb_int_value(mrb, cache ? cache->capacity : 0));
+
+  return stats;
+}
+
+mrb_value hp_font_set_measure_capacity(mrb_state* mrb, mrb_value self)
+{
+  mrb_int capacity;
+  mrb_get_args(mrb, "i", &capacity);
+  hp_font_wrapper* wrapper = hp_font_get(mrb, self);
+
+  if (wrapper->measures) hp_measure_cache_free(wrapper->measures);
+  wrapper->measures = NULL;
+
+  // 0 turns the cache off
+  if (capacity > 0 && hp_measure_cache_init(&wrapper->measures, capacity) != 0)
+  {
+    mrb_raise(mrb, E_RUNTIME_ERROR, "Cannot allocate measure cache");
   }
-  
-  mrb_value arr =  mrb_hash_get(mrb, map, chr);
-  if (mrb_nil_p(arr)) return mrb_nil_value();
 
-  float base_size = mrb_float(mrb_ary_entry(arr, 0));
-  float w = mrb_float(mrb_ary_entry(arr, 1));
-  int s = mrb_integer(size);
-  return mrb_float_value(mrb,  ((1.0 * s) / base_size) * w + 1.0);
+  return mrb_int_value(mrb, capacity);
 }
 
 mrb_value hp_font_height(mrb_state* mrb, mrb_value self)
@@ -201,10 +582,20 @@ void mrb_define_hokusai_font_class(mrb_state* mrb)
   mrb_define_class_method(mrb, font_class, "default", hp_font_default, MRB_ARGS_NONE());
   mrb_define_class_method(mrb, font_class, "from", hp_font_from, MRB_ARGS_REQ(1));
   mrb_define_class_method(mrb, font_class, "from_ext", hp_font_from_ext, MRB_ARGS_ARG(2, 1));
+  mrb_define_class_method(mrb, font_class, "dynamic", hp_font_dynamic, MRB_ARGS_ARG(1, 2));
+  mrb_define_class_method(mrb, font_class, "sdf", hp_font_from_sdf, MRB_ARGS_ARG(1, 2));
 
   mrb_define_method(mrb, font_class, "measure_char", hp_font_measure_char, MRB_ARGS_REQ(2));
   mrb_define_method(mrb, font_class, "measure", hp_font_measure, MRB_ARGS_REQ(2));
+  mrb_define_method(mrb, font_class, "measure_run", hp_font_measure_run, MRB_ARGS_ARG(2, 1));
+  mrb_define_method(mrb, font_class, "wrap", hp_font_wrap_text, MRB_ARGS_ARG(3, 1));
+  mrb_define_method(mrb, font_class, "pack_glyphs", hp_font_pack_glyphs, MRB_ARGS_REQ(5));
   mrb_define_method(mrb, font_class, "height", hp_font_height, MRB_ARGS_NONE());
+  mrb_define_method(mrb, font_class, "glyph_count", hp_font_glyph_count, MRB_ARGS_NONE());
+  mrb_define_method(mrb, font_class, "dynamic?", hp_font_is_dynamic, MRB_ARGS_NONE());
+  mrb_define_method(mrb, font_class, "sdf?", hp_font_is_sdf, MRB_ARGS_NONE());
+  mrb_define_method(mrb, font_class, "measure_stats", hp_font_measure_stats, MRB_ARGS_NONE());
+  mrb_define_method(mrb, font_class, "measure_cache_capacity=", hp_font_set_measure_capacity, MRB_ARGS_REQ(1));
 }
 
 #endif
\ No newline at end of file
@@ -9,15 +9,81 @@
 #include <mruby/variable.h>
 #include <mruby/string.h>
 #include <raylib.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "glyph_atlas.h"
+#include "measure_cache.h"
+
+/**
+  Advance widths of every glyph a font loaded, at the font's size.
+  ASCII is indexed directly, everything else is a sorted table.
+*/
+typedef struct HpFontAdvances
+{
+  float ascii[128];
+  int* codepoints;
+  float* widths;
+  int len;
+} hp_font_advances;
 
 typedef struct HpFontWrapper
 {
   Font font;
   int size;
+  hp_font_advances advances;
+  // set for fonts from Font.dynamic, which rasterize glyphs on first use
+  hp_glyph_atlas* glyphs;
+  // Font#measure results, NULL when turned off
+  hp_measure_cache* measures;
+  // width of the glyph raylib draws for missing ones, at the font's size. -1 until needed
+  float missing;
 } hp_font_wrapper;
 
+/**
+  One placed glyph of a Commands::GlyphRun,
+  packed back to back in the command's glyph buffer
+*/
+typedef struct HpFontGlyph
+{
+  int codepoint;
+  float x;
+  float y;
+} hp_font_glyph;
+
+// the size distance fields are baked at, any size is drawn from it
+#define HP_FONT_SDF_SIZE 48
+
+// raylib's default spacing between the lines of a DrawTextEx
+#define HP_FONT_LINE_SPACING 2
+
 hp_font_wrapper* hp_font_get(mrb_state* mrb, mrb_value self);
 
+/**
+  Width of `codepoint` at `size`, measured the same way as Font#measure_char
+  A dynamic font rasterizes the glyph if it hasn't yet.
+  @return -1 when the font didn't load the glyph
+*/
+float hp_font_advance(hp_font_wrapper* wrapper, int codepoint, int size);
+
+/**
+  Width `codepoint` takes when drawn at `size`: its advance,
+  or the fallback glyph's when the font didn't load it.
+  Measuring, packing and wrapping all go through this so they agree.
+*/
+float hp_font_draw_width(hp_font_wrapper* wrapper, int codepoint, int size);
+
+/**
+  Whether the font's atlas holds distance fields,
+  which are drawn through the backend's SDF shader
+*/
+bool hp_font_sdf(hp_font_wrapper* wrapper);
+
+/**
+  Rasterizes every glyph of `text` a dynamic font hasn't yet,
+  before it goes to raylib's text functions
+*/
+void hp_font_prepare(hp_font_wrapper* wrapper, const char* text, size_t bytes);
+
 /**
   defines Hokusai::Font and related methods
   @param mrb the mrb vm
@@ -0,0 +1,203 @@
+#ifndef HOKUSAI_POCKET_GLYPH_ATLAS
+#define HOKUSAI_POCKET_GLYPH_ATLAS
+
+#include "glyph_atlas.h"
+
+static Image hp_glyph_atlas_image(hp_glyph_atlas* atlas)
+{
+  return (Image){ atlas->pixels, HP_GLYPH_ATLAS_WIDTH, atlas->height, 1, PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA };
+}
+
+static void hp_glyph_atlas_upload(hp_glyph_atlas* atlas, Font* font)
+{
+  font->texture = LoadTextureFromImage(hp_glyph_atlas_image(atlas));
+  // distance fields are meant to be sampled between texels
+  SetTextureFilter(font->texture, atlas->type == FONT_SDF ? TEXTURE_FILTER_BILINEAR : TEXTURE_FILTER_POINT);
+}
+
+static int hp_glyph_atlas_grow(hp_glyph_atlas* atlas)
+{
+  if (atlas->height >= HP_GLYPH_ATLAS_MAX_HEIGHT) return -1;
+
+  int height = atlas->height * 2;
+  size_t row = HP_GLYPH_ATLAS_WIDTH * 2;
+  unsigned char* pixels = realloc(atlas->pixels, row * height);
+  if (pixels == NULL) return -1;
+
+  // the page keeps its width, so the new rows just go underneath
+  memset(pixels + row * atlas->height, 0, row * (height - atlas->height));
+  atlas->pixels = pixels;
+  atlas->height = height;
+  atlas->packer->height = height;
+
+  return 0;
+}
+
+/* packs glyph `index` and copies its pixels into the page, returns 1 if the page grew */
+static int hp_glyph_atlas_place(hp_glyph_atlas* atlas, Font* font, int index)
+{
+  GlyphInfo* glyph = &font->glyphs[index];
+  ImageFormat(&glyph->image, PIXELFORMAT_UNCOMPRESSED_GRAYSCALE);
+
+  int w = glyph->image.width;
+  int h = glyph->image.height;
+  int x;
+  int y;
+  int grew = 0;
+
+  while (hoku_atlas_pack(atlas->packer, w, h, &x, &y) != 0)
+  {
+    if (hp_glyph_atlas_grow(atlas) != 0) return -1;
+    grew = 1;
+  }
+
+  // white, with the glyph's coverage as alpha (as GenImageFontAtlas does)
+  unsigned char* src = (unsigned char*) glyph->image.data;
+  for (int gy=0; gy<h; gy++)
+  {
+    unsigned char* dest = atlas->pixels + ((y + gy) * HP_GLYPH_ATLAS_WIDTH + x) * 2;
+    for (int gx=0; gx<w; gx++)
+    {
+      dest[gx * 2] = 255;
+      dest[gx * 2 + 1] = src[gy * w + gx];
+    }
+  }
+
+  font->recs[index] = (Rectangle){ (float)x, (float)y, (float)w, (float)h };
+  return grew;
+}
+
+int hp_glyph_atlas_load(hp_glyph_atlas** atlas, Font* font, const char* path, int size, int* codepoints, int count, int type)
+{
+  hp_glyph_atlas* init = malloc(sizeof(hp_glyph_atlas));
+  if (init == NULL) return -1;
+
+  init->size = size;
+  init->type = type;
+  init->rasterized = 0;
+  init->full = 0;
+  init->height = HP_GLYPH_ATLAS_MIN_HEIGHT;
+  init->data = LoadFileData(path, &init->data_size);
+  init->pixels = calloc(HP_GLYPH_ATLAS_WIDTH * init->height, 2);
+  init->packer = NULL;
+
+  if (init->data == NULL || init->pixels == NULL || hoku_atlas_init(&init->packer, HP_GLYPH_ATLAS_WIDTH, init->height, HP_GLYPH_ATLAS_PADDING) != 0)
+  {
+    hp_glyph_atlas_free(init);
+    return -1;
+  }
+
+  Font loaded = { 0 };
+  loaded.baseSize = size;
+  loaded.glyphPadding = HP_GLYPH_ATLAS_PADDING;
+  // LoadFontData loads its 95 default glyphs for a count of 0, this font starts empty instead
+  loaded.glyphs = count > 0 ? LoadFontData(init->data, init->data_size, size, codepoints, count, type) : MemAlloc(sizeof(GlyphInfo));
+  loaded.recs = MemAlloc(sizeof(Rectangle) * (count > 0 ? count : 1));
+
+  if (loaded.glyphs == NULL || loaded.recs == NULL)
+  {
+    if (loaded.glyphs) UnloadFontData(loaded.glyphs, count);
+    MemFree(loaded.recs);
+    hp_glyph_atlas_free(init);
+    return -1;
+  }
+
+  init->glyph_cap = count;
+
+  for (int i=0; i<count; i++)
+  {
+    if (hp_glyph_atlas_place(init, &loaded, i) == -1)
+    {
+      init->full = 1;
+      // the page is full, the rest can't be drawn
+      for (int j=i; j<count; j++) UnloadImage(loaded.glyphs[j].image);
+      break;
+    }
+
+    loaded.glyphCount++;
+  }
+
+  hp_glyph_atlas_upload(init, &loaded);
+
+  *font = loaded;
+  *atlas = init;
+  return 0;
+}
+
+int hp_glyph_atlas_add(hp_glyph_atlas* atlas, Font* font, int codepoint)
+{
+  if (atlas->full) return -1;
+
+  GlyphInfo* loaded = LoadFontData(atlas->data, atlas->data_size, atlas->size, &codepoint, 1, atlas->type);
+  if (loaded == NULL) return -1;
+
+  if (font->glyphCount == atlas->glyph_cap)
+  {
+    int cap = atlas->glyph_cap < 16 ? 32 : atlas->glyph_cap * 2;
+    GlyphInfo* glyphs = MemRealloc(font->glyphs, sizeof(GlyphInfo) * cap);
+    if (glyphs != NULL) font->glyphs = glyphs;
+    Rectangle* recs = glyphs == NULL ? NULL : MemRealloc(font->recs, sizeof(Rectangle) * cap);
+    if (recs != NULL) font->recs = recs;
+
+    if (glyphs == NULL || recs == NULL)
+    {
+      UnloadFontData(loaded, 1);
+      return -1;
+    }
+
+    atlas->glyph_cap = cap;
+  }
+
+  int index = font->glyphCount;
+  font->glyphs[index] = loaded[0];
+  // the glyph's image moves into the font
+  MemFree(loaded);
+
+  int grew = hp_glyph_atlas_place(atlas, font, index);
+  if (grew == -1)
+  {
+    atlas->full = 1;
+    UnloadImage(font->glyphs[index].image);
+    return -1;
+  }
+
+  font->glyphCount++;
+  atlas->rasterized++;
+
+  if (grew)
+  {
+    // quads already batched this frame sample the old texture with coordinates for its height
+    rlDrawRenderBatchActive();
+    UnloadTexture(font->texture);
+    hp_glyph_atlas_upload(atlas, font);
+    return index;
+  }
+
+  Rectangle rec = font->recs[index];
+  int w = (int) rec.width;
+  int h = (int) rec.height;
+  if (w == 0 || h == 0) return index;
+
+  // only the glyph's own rectangle goes up to the gpu
+  unsigned char* region = malloc(w * h * 2);
+  if (region == NULL) return index;
+
+  for (int gy=0; gy<h; gy++)
+  {
+    memcpy(region + gy * w * 2, atlas->pixels + (((int) rec.y + gy) * HP_GLYPH_ATLAS_WIDTH + (int) rec.x) * 2, w * 2);
+  }
+  UpdateTextureRec(font->texture, rec, region);
+  free(region);
+
+  return index;
+}
+
+void hp_glyph_atlas_free(hp_glyph_atlas* atlas)
+{
+  if (atlas->data) UnloadFileData(atlas->data);
+  if (atlas->packer) hoku_atlas_free(atlas->packer);
+  free(atlas->pixels);
+  free(atlas);
+}
+
+#endif
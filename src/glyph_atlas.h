@@ -0,0 +1,64 @@
+#ifndef HOKUSAI_POCKET_GLYPH_ATLAS_H
+#define HOKUSAI_POCKET_GLYPH_ATLAS_H
+
+#include <raylib.h>
+#include <rlgl.h>
+#include <stdlib.h>
+#include <string.h>
+#include "core-atlas.h"
+
+#define HP_GLYPH_ATLAS_WIDTH 1024
+#define HP_GLYPH_ATLAS_MIN_HEIGHT 128
+#define HP_GLYPH_ATLAS_MAX_HEIGHT 4096
+// raylib's FONT_TTF_DEFAULT_CHARS_PADDING, DrawTextCodepoint samples this far around a glyph
+#define HP_GLYPH_ATLAS_PADDING 4
+
+/**
+  The glyph page of a font that rasterizes on demand.
+
+  The TTF stays in memory, and glyphs are baked into the font's
+  atlas the first time they are asked for.  The page is as wide as
+  HP_GLYPH_ATLAS_WIDTH and doubles in height when it fills up,
+  so it only ever holds the glyphs that were used.
+
+  The raylib Font it backs stays a regular Font
+  (one texture, glyphs and recs in step) for DrawTextEx and friends.
+*/
+typedef struct HpGlyphAtlas
+{
+  unsigned char* data;
+  int data_size;
+  int size;
+  // FONT_DEFAULT, or FONT_SDF for glyphs stored as distance fields
+  int type;
+  // a GRAY_ALPHA copy of the page, to grow the texture from
+  unsigned char* pixels;
+  int height;
+  hoku_atlas* packer;
+  int glyph_cap;
+  int rasterized;
+  // the page is as tall as it gets and a glyph didn't fit
+  int full;
+} hp_glyph_atlas;
+
+/**
+  Loads the font at `path`, baking `codepoints` up front
+  @param atlas out param for the atlas
+  @param font out param for the raylib Font it backs
+  @param type FONT_DEFAULT or FONT_SDF
+  @return 0 on success, -1 on failure
+*/
+int hp_glyph_atlas_load(hp_glyph_atlas** atlas, Font* font, const char* path, int size, int* codepoints, int count, int type);
+
+/**
+  Rasterizes `codepoint` into the page, growing it when full
+  @return the codepoint's glyph index in `font`, -1 when it can't be added
+*/
+int hp_glyph_atlas_add(hp_glyph_atlas* atlas, Font* font, int codepoint);
+
+/**
+  Frees the TTF and the page copy, the Font itself is released with UnloadFont
+*/
+void hp_glyph_atlas_free(hp_glyph_atlas* atlas);
+
+#endif
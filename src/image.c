@@ -3,6 +3,7 @@
 
 #include "image.h"
 #include "texture.h"
+#include "loader.h"
 Color image_raylib_color(mrb_state* mrb, mrb_value color)
 {
   int red = mrb_int(mrb, mrb_funcall_argv(mrb, color, mrb_intern_lit(mrb, "red"), 0, NULL));
@@ -120,6 +121,12 @@ mrb_value hp_image_height(mrb_state* mrb, mrb_value self)
   return mrb_int_value(mrb, wrap->image.height);
 }
 
+mrb_value hp_image_generation(mrb_state* mrb, mrb_value self)
+{
+  hp_image_wrapper* wrap = hp_image_get(mrb, self);
+  return mrb_int_value(mrb, (mrb_int) wrap->generation);
+}
+
 mrb_value hp_image_resize(mrb_state* mrb, mrb_value self)
 {
   mrb_value rwidth;
@@ -131,6 +138,7 @@ mrb_value hp_image_resize(mrb_state* mrb, mrb_value self)
   int height = mrb_int(mrb, rheight);
   
   ImageResize(&(wrapper->image), width, height);
+  wrapper->generation++;
   return mrb_nil_value();
 }
 
@@ -138,6 +146,7 @@ mrb_value hp_image_flip_vertical(mrb_state* mrb, mrb_value self)
 {
   hp_image_wrapper* wrapper = hp_image_get(mrb, self);  
   ImageFlipVertical((&wrapper->image));
+  wrapper->generation++;
   return mrb_nil_value();
 }
 
@@ -145,6 +154,7 @@ mrb_value hp_image_flip_horizontal(mrb_state* mrb, mrb_value self)
 {
   hp_image_wrapper* wrapper = hp_image_get(mrb, self);  
   ImageFlipHorizontal((&wrapper->image));
+  wrapper->generation++;
   return mrb_nil_value();
 }
 
@@ -156,6 +166,7 @@ mrb_value hp_image_rotate(mrb_state* mrb, mrb_value self)
   hp_image_wrapper* wrapper = hp_image_get(mrb, self);  
 
   ImageRotate(&(wrapper->image), deg);
+  wrapper->generation++;
   return mrb_nil_value();
 }
 
@@ -171,6 +182,7 @@ mrb_value hp_image_contrast(mrb_state* mrb, mrb_value self)
   }
 
   ImageColorContrast(&(wrapper->image), contrast);
+  wrapper->generation++;
 
   return mrb_nil_value();
 }
@@ -187,6 +199,7 @@ mrb_value hp_image_brightness(mrb_state* mrb, mrb_value self)
   }
 
   ImageColorBrightness(&(wrapper->image), bright);
+  wrapper->generation++;
   return mrb_nil_value();
 }
 
@@ -201,6 +214,7 @@ mrb_value hp_image_replace_color(mrb_state* mrb, mrb_value self)
   hp_image_wrapper* wrapper = hp_image_get(mrb, self);
 
   ImageColorReplace(&(wrapper->image), color, replace);
+  wrapper->generation++;
 
   return mrb_nil_value();
 }
@@ -230,6 +244,28 @@ mrb_value hp_image_export(mrb_state* mrb, mrb_value self)
   return mrb_bool_value(res);
 }
 
+// whether the backend has a texture of this image uploaded,
+// at a given size or at any size
+mrb_value hp_image_is_ready(mrb_state* mrb, mrb_value self)
+{
+  mrb_int width = -1;
+  mrb_int height = -1;
+  mrb_get_args(mrb, "|ii", &width, &height);
+
+  hp_image_loader* loader = hp_image_loader_get();
+  if (loader == NULL) return mrb_false_value();
+
+  mrb_value object_id = mrb_funcall(mrb, self, "object_id", 0, NULL);
+  const char* oid = mrb_str_to_cstr(mrb, mrb_funcall(mrb, object_id, "to_s", 0, NULL));
+  if (width < 0 || height < 0) return mrb_bool_value(hp_image_loader_ready(loader, oid, NULL));
+
+  // same key on_draw_image uses for unsliced images
+  int len = strlen(oid) + 100;
+  char key[len];
+  sprintf(key, "%s-%d-%d", oid, (int)width, (int)height);
+  return mrb_bool_value(hp_image_loader_ready(loader, oid, key));
+}
+
 void mrb_define_hokusai_image_class(mrb_state* mrb)
 {
   struct RClass* module = mrb_module_get(mrb, "Hokusai");
@@ -241,6 +277,7 @@ void mrb_define_hokusai_image_class(mrb_state* mrb)
   mrb_define_class_method(mrb, klass, "from_texture", hp_image_from_texture, MRB_ARGS_REQ(1));
   mrb_define_method(mrb, klass, "width", hp_image_width, MRB_ARGS_NONE());
   mrb_define_method(mrb, klass, "height", hp_image_height, MRB_ARGS_NONE());
+  mrb_define_method(mrb, klass, "generation", hp_image_generation, MRB_ARGS_NONE());
   mrb_define_method(mrb, klass, "copy", hp_image_copy, MRB_ARGS_NONE());
   mrb_define_method(mrb, klass, "resize", hp_image_resize, MRB_ARGS_REQ(2));
   mrb_define_method(mrb, klass, "flip_horizontal", hp_image_flip_horizontal, MRB_ARGS_NONE());
@@ -251,6 +288,7 @@ void mrb_define_hokusai_image_class(mrb_state* mrb)
   mrb_define_method(mrb, klass, "color_replace", hp_image_replace_color, MRB_ARGS_REQ(2));
   mrb_define_method(mrb, klass, "color_at", hp_image_color_at, MRB_ARGS_REQ(2));
   mrb_define_method(mrb, klass, "export", hp_image_export, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, klass, "ready?", hp_image_is_ready, MRB_ARGS_OPT(2));
 }
 
 #endif
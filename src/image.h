@@ -9,10 +9,16 @@
 #include <mruby/variable.h>
 #include <mruby/string.h>
 #include <raylib.h>
+#include <stdio.h>
+#include <stdint.h>
 
+/**
+  `generation` changes whenever the pixels do, so layers know their cache is stale.
+*/
 typedef struct HpImageWrapper
 {
   Image image;
+  uint64_t generation;
 } hp_image_wrapper;
 
 hp_image_wrapper* hp_image_get(mrb_state* mrb, mrb_value self);
@@ -0,0 +1,662 @@
+#ifndef HOKUSAI_POCKET_JSON
+#define HOKUSAI_POCKET_JSON
+
+#include "json.h"
+
+#if defined(__SSE2__)
+  #include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+  #include <arm_neon.h>
+#endif
+
+#define HP_JSON_MAX_DEPTH 512
+
+typedef struct HpJsonParser
+{
+  mrb_state* mrb;
+  const char* start;
+  const char* cur;
+  const char* end;
+  int depth;
+} hp_json_parser;
+
+typedef struct HpJsonGenerator
+{
+  mrb_value buffer;
+  int depth;
+  int first;
+} hp_json_generator;
+
+static void hp_json_generate_value(mrb_state* mrb, hp_json_generator* gen, mrb_value value);
+
+static void hp_json_raise(hp_json_parser* parser, const char* message)
+{
+  struct RClass* hokusai_class = mrb_module_get(parser->mrb, "Hokusai");
+  struct RClass* exp = mrb_class_get_under(parser->mrb, hokusai_class, "Error");
+  mrb_raisef(parser->mrb, exp, "JSON parse error at offset %d: %s", (int)(parser->cur - parser->start), message);
+}
+
+/**
+  Returns a pointer to the first byte in [p, end) that
+  terminates a raw string run: a quote, a backslash or a control character.
+
+  This is where nearly all of the time goes on large documents,
+  so scan 16 bytes at a time where the target allows it.
+*/
+static const char* hp_json_scan_string(const char* p, const char* end)
+{
+#if defined(__SSE2__)
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i slash = _mm_set1_epi8('\\');
+  const __m128i ctrl = _mm_set1_epi8(0x1f);
+
+  while (end - p >= 16)
+  {
+    __m128i chunk = _mm_loadu_si128((const __m128i*)p);
+    __m128i hits = _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, slash));
+    // unsigned chunk <= 0x1f
+    hits = _mm_or_si128(hits, _mm_cmpeq_epi8(_mm_min_epu8(chunk, ctrl), chunk));
+
+    int mask = _mm_movemask_epi8(hits);
+    if (mask) return p + __builtin_ctz(mask);
+
+    p += 16;
+  }
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+  const uint8x16_t quote = vdupq_n_u8('"');
+  const uint8x16_t slash = vdupq_n_u8('\\');
+  const uint8x16_t ctrl = vdupq_n_u8(0x20);
+
+  while (end - p >= 16)
+  {
+    uint8x16_t chunk = vld1q_u8((const uint8_t*)p);
+    uint8x16_t hits = vorrq_u8(vceqq_u8(chunk, quote), vceqq_u8(chunk, slash));
+    hits = vorrq_u8(hits, vcltq_u8(chunk, ctrl));
+
+    if (vmaxvq_u8(hits)) break;
+
+    p += 16;
+  }
+#endif
+
+  while (p < end)
+  {
+    unsigned char c = (unsigned char)*p;
+    if (c == '"' || c == '\\' || c < 0x20) return p;
+    p++;
+  }
+
+  return end;
+}
+
+static void hp_json_skip_whitespace(hp_json_parser* parser)
+{
+  const char* p = parser->cur;
+
+  while (p < parser->end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) p++;
+
+  parser->cur = p;
+}
+
+static int hp_json_hex(const char* p)
+{
+  int value = 0;
+
+  for (int i=0; i<4; i++)
+  {
+    char c = p[i];
+    value <<= 4;
+
+    if (c >= '0' && c <= '9') value |= c - '0';
+    else if (c >= 'a' && c <= 'f') value |= c - 'a' + 10;
+    else if (c >= 'A' && c <= 'F') value |= c - 'A' + 10;
+    else return -1;
+  }
+
+  return value;
+}
+
+static int hp_json_encode_utf8(char* out, unsigned int codepoint)
+{
+  if (codepoint < 0x80)
+  {
+    out[0] = (char)codepoint;
+    return 1;
+  }
+  else if (codepoint < 0x800)
+  {
+    out[0] = (char)(0xc0 | (codepoint >> 6));
+    out[1] = (char)(0x80 | (codepoint & 0x3f));
+    return 2;
+  }
+  else if (codepoint < 0x10000)
+  {
+    out[0] = (char)(0xe0 | (codepoint >> 12));
+    out[1] = (char)(0x80 | ((codepoint >> 6) & 0x3f));
+    out[2] = (char)(0x80 | (codepoint & 0x3f));
+    return 3;
+  }
+
+  out[0] = (char)(0xf0 | (codepoint >> 18));
+  out[1] = (char)(0x80 | ((codepoint >> 12) & 0x3f));
+  out[2] = (char)(0x80 | ((codepoint >> 6) & 0x3f));
+  out[3] = (char)(0x80 | (codepoint & 0x3f));
+  return 4;
+}
+
+/* expects parser->cur to be just past the opening quote */
+static mrb_value hp_json_parse_string(hp_json_parser* parser)
+{
+  mrb_state* mrb = parser->mrb;
+  const char* run = parser->cur;
+  const char* stop = hp_json_scan_string(run, parser->end);
+
+  // fast path: no escapes
+  if (stop < parser->end && *stop == '"')
+  {
+    parser->cur = stop + 1;
+    return mrb_str_new(mrb, run, stop - run);
+  }
+
+  mrb_value str = mrb_str_new(mrb, run, stop - run);
+
+  while (1)
+  {
+    parser->cur = stop;
+    if (stop >= parser->end) hp_json_raise(parser, "unterminated string");
+
+    if (*stop == '"') break;
+    if ((unsigned char)*stop < 0x20) hp_json_raise(parser, "control character in string");
+
+    // escape sequence
+    stop++;
+    if (stop >= parser->end) hp_json_raise(parser, "unterminated string");
+
+    char escaped;
+    switch (*stop)
+    {
+      case '"': escaped = '"'; break;
+      case '\\': escaped = '\\'; break;
+      case '/': escaped = '/'; break;
+      case 'b': escaped = '\b'; break;
+      case 'f': escaped = '\f'; break;
+      case 'n': escaped = '\n'; break;
+      case 'r': escaped = '\r'; break;
+      case 't': escaped = '\t'; break;
+      case 'u':
+      {
+        if (parser->end - stop < 5) hp_json_raise(parser, "truncated unicode escape");
+
+        int codepoint = hp_json_hex(stop + 1);
+        if (codepoint < 0) hp_json_raise(parser, "invalid unicode escape");
+        stop += 5;
+
+        // surrogate pair
+        if (codepoint >= 0xd800 && codepoint <= 0xdbff)
+        {
+          int low = -1;
+          if (parser->end - stop >= 6 && stop[0] == '\\' && stop[1] == 'u') low = hp_json_hex(stop + 2);
+          if (low < 0xdc00 || low > 0xdfff) hp_json_raise(parser, "invalid surrogate pair");
+
+          codepoint = 0x10000 + ((codepoint - 0xd800) << 10) + (low - 0xdc00);
+          stop += 6;
+        }
+        // a low surrogate only means something after a high one
+        else if (codepoint >= 0xdc00 && codepoint <= 0xdfff)
+        {
+          hp_json_raise(parser, "invalid surrogate pair");
+        }
+
+        char utf8[4];
+        int len = hp_json_encode_utf8(utf8, (unsigned int)codepoint);
+        mrb_str_cat(mrb, str, utf8, len);
+
+        run = stop;
+        stop = hp_json_scan_string(run, parser->end);
+        mrb_str_cat(mrb, str, run, stop - run);
+        continue;
+      }
+      default:
+        hp_json_raise(parser, "invalid escape");
+    }
+
+    mrb_str_cat(mrb, str, &escaped, 1);
+
+    run = stop + 1;
+    stop = hp_json_scan_string(run, parser->end);
+    mrb_str_cat(mrb, str, run, stop - run);
+  }
+
+  parser->cur = stop + 1;
+  return str;
+}
+
+static mrb_value hp_json_parse_number(hp_json_parser* parser)
+{
+  const char* start = parser->cur;
+  const char* p = start;
+  const char* end = parser->end;
+  int is_float = 0;
+  int negative = 0;
+
+  if (*p == '-')
+  {
+    negative = 1;
+    p++;
+  }
+
+  if (p >= end || *p < '0' || *p > '9') hp_json_raise(parser, "invalid number");
+
+  if (*p == '0') p++;
+  else while (p < end && *p >= '0' && *p <= '9') p++;
+
+  if (p < end && *p == '.')
+  {
+    is_float = 1;
+    p++;
+    if (p >= end || *p < '0' || *p > '9') hp_json_raise(parser, "invalid number");
+    while (p < end && *p >= '0' && *p <= '9') p++;
+  }
+
+  if (p < end && (*p == 'e' || *p == 'E'))
+  {
+    is_float = 1;
+    p++;
+    if (p < end && (*p == '+' || *p == '-')) p++;
+    if (p >= end || *p < '0' || *p > '9') hp_json_raise(parser, "invalid number");
+    while (p < end && *p >= '0' && *p <= '9') p++;
+  }
+
+  parser->cur = p;
+
+  if (!is_float)
+  {
+    const char* digit = start + negative;
+    uint64_t limit = negative ? (uint64_t)MRB_INT_MAX + 1 : (uint64_t)MRB_INT_MAX;
+    uint64_t value = 0;
+    int overflow = 0;
+
+    while (digit < p)
+    {
+      uint64_t d = (uint64_t)(*digit - '0');
+      if (value > (limit - d) / 10)
+      {
+        overflow = 1;
+        break;
+      }
+
+      value = value * 10 + d;
+      digit++;
+    }
+
+    if (!overflow)
+    {
+      mrb_int result = negative ? (mrb_int)(0 - value) : (mrb_int)value;
+      return mrb_int_value(parser->mrb, result);
+    }
+  }
+
+  // strtod needs a terminated copy
+  size_t len = p - start;
+  char stack[64];
+  char* copy = stack;
+  if (len >= sizeof(stack))
+  {
+    copy = RSTRING_PTR(mrb_str_new(parser->mrb, start, len));
+  }
+  else
+  {
+    memcpy(stack, start, len);
+    stack[len] = '\0';
+  }
+
+  return mrb_float_value(parser->mrb, strtod(copy, NULL));
+}
+
+static void hp_json_expect_literal(hp_json_parser* parser, const char* literal, size_t len)
+{
+  if ((size_t)(parser->end - parser->cur) < len || memcmp(parser->cur, literal, len) != 0)
+  {
+    hp_json_raise(parser, "unexpected token");
+  }
+
+  parser->cur += len;
+}
+
+static mrb_value hp_json_parse_value(hp_json_parser* parser);
+
+static mrb_value hp_json_parse_array(hp_json_parser* parser)
+{
+  mrb_state* mrb = parser->mrb;
+  if (++parser->depth > HP_JSON_MAX_DEPTH) hp_json_raise(parser, "nesting too deep");
+
+  mrb_value ary = mrb_ary_new(mrb);
+  parser->cur++;
+  hp_json_skip_whitespace(parser);
+
+  if (parser->cur < parser->end && *parser->cur == ']')
+  {
+    parser->cur++;
+    parser->depth--;
+    return ary;
+  }
+
+  while (1)
+  {
+    int ai = mrb_gc_arena_save(mrb);
+    mrb_ary_push(mrb, ary, hp_json_parse_value(parser));
+    mrb_gc_arena_restore(mrb, ai);
+
+    hp_json_skip_whitespace(parser);
+    if (parser->cur >= parser->end) hp_json_raise(parser, "unterminated array");
+
+    if (*parser->cur == ',')
+    {
+      parser->cur++;
+      continue;
+    }
+
+    if (*parser->cur == ']')
+    {
+      parser->cur++;
+      break;
+    }
+
+    hp_json_raise(parser, "expected ',' or ']'");
+  }
+
+  parser->depth--;
+  return ary;
+}
+
+static mrb_value hp_json_parse_object(hp_json_parser* parser)
+{
+  mrb_state* mrb = parser->mrb;
+  if (++parser->depth > HP_JSON_MAX_DEPTH) hp_json_raise(parser, "nesting too deep");
+
+  mrb_value hash = mrb_hash_new(mrb);
+  parser->cur++;
+  hp_json_skip_whitespace(parser);
+
+  if (parser->cur < parser->end && *parser->cur == '}')
+  {
+    parser->cur++;
+    parser->depth--;
+    return hash;
+  }
+
+  while (1)
+  {
+    int ai = mrb_gc_arena_save(mrb);
+
+    hp_json_skip_whitespace(parser);
+    if (parser->cur >= parser->end || *parser->cur != '"') hp_json_raise(parser, "expected object key");
+    parser->cur++;
+    mrb_value key = hp_json_parse_string(parser);
+
+    hp_json_skip_whitespace(parser);
+    if (parser->cur >= parser->end || *parser->cur != ':') hp_json_raise(parser, "expected ':'");
+    parser->cur++;
+
+    mrb_value value = hp_json_parse_value(parser);
+    mrb_hash_set(mrb, hash, key, value);
+    mrb_gc_arena_restore(mrb, ai);
+
+    hp_json_skip_whitespace(parser);
+    if (parser->cur >= parser->end) hp_json_raise(parser, "unterminated object");
+
+    if (*parser->cur == ',')
+    {
+      parser->cur++;
+      continue;
+    }
+
+    if (*parser->cur == '}')
+    {
+      parser->cur++;
+      break;
+    }
+
+    hp_json_raise(parser, "expected ',' or '}'");
+  }
+
+  parser->depth--;
+  return hash;
+}
+
+static mrb_value hp_json_parse_value(hp_json_parser* parser)
+{
+  hp_json_skip_whitespace(parser);
+  if (parser->cur >= parser->end) hp_json_raise(parser, "unexpected end of input");
+
+  switch (*parser->cur)
+  {
+    case '{':
+      return hp_json_parse_object(parser);
+    case '[':
+      return hp_json_parse_array(parser);
+    case '"':
+      parser->cur++;
+      return hp_json_parse_string(parser);
+    case 't':
+      hp_json_expect_literal(parser, "true", 4);
+      return mrb_true_value();
+    case 'f':
+      hp_json_expect_literal(parser, "false", 5);
+      return mrb_false_value();
+    case 'n':
+      hp_json_expect_literal(parser, "null", 4);
+      return mrb_nil_value();
+    case '-':
+    case '0': case '1': case '2': case '3': case '4':
+    case '5': case '6': case '7': case '8': case '9':
+      return hp_json_parse_number(parser);
+    default:
+      hp_json_raise(parser, "unexpected character");
+  }
+
+  return mrb_nil_value();
+}
+
+static void hp_json_generate_string(mrb_state* mrb, hp_json_generator* gen, const char* str, mrb_int len)
+{
+  const char* p = str;
+  const char* end = str + len;
+
+  mrb_str_cat(mrb, gen->buffer, "\"", 1);
+
+  while (p < end)
+  {
+    const char* stop = hp_json_scan_string(p, end);
+    mrb_str_cat(mrb, gen->buffer, p, stop - p);
+    if (stop >= end) break;
+
+    char escape[7];
+    switch (*stop)
+    {
+      case '"': mrb_str_cat(mrb, gen->buffer, "\\\"", 2); break;
+      case '\\': mrb_str_cat(mrb, gen->buffer, "\\\\", 2); break;
+      case '\b': mrb_str_cat(mrb, gen->buffer, "\\b", 2); break;
+      case '\f': mrb_str_cat(mrb, gen->buffer, "\\f", 2); break;
+      case '\n': mrb_str_cat(mrb, gen->buffer, "\\n", 2); break;
+      case '\r': mrb_str_cat(mrb, gen->buffer, "\\r", 2); break;
+      case '\t': mrb_str_cat(mrb, gen->buffer, "\\t", 2); break;
+      default:
+        snprintf(escape, sizeof(escape), "\\u%04x", (unsigned char)*stop);
+        mrb_str_cat(mrb, gen->buffer, escape, 6);
+    }
+
+    p = stop + 1;
+  }
+
+  mrb_str_cat(mrb, gen->buffer, "\"", 1);
+}
+
+static void hp_json_generate_float(mrb_state* mrb, hp_json_generator* gen, mrb_float value)
+{
+  if (isnan(value) || isinf(value))
+  {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "NaN and Infinity are not valid JSON");
+  }
+
+  // shortest representation that round trips
+  char out[32];
+  snprintf(out, sizeof(out), "%.15g", (double)value);
+  if (strtod(out, NULL) != (double)value) snprintf(out, sizeof(out), "%.17g", (double)value);
+
+  mrb_str_cat_cstr(mrb, gen->buffer, out);
+  if (strpbrk(out, ".e") == NULL) mrb_str_cat(mrb, gen->buffer, ".0", 2);
+}
+
+static int hp_json_generate_pair(mrb_state* mrb, mrb_value key, mrb_value value, void* data)
+{
+  hp_json_generator* gen = (hp_json_generator*) data;
+
+  if (!gen->first) mrb_str_cat(mrb, gen->buffer, ",", 1);
+  gen->first = 0;
+
+  if (mrb_symbol_p(key))
+  {
+    mrb_int len;
+    const char* name = mrb_sym_name_len(mrb, mrb_symbol(key), &len);
+    hp_json_generate_string(mrb, gen, name, len);
+  }
+  else
+  {
+    if (!mrb_string_p(key)) key = mrb_obj_as_string(mrb, key);
+    hp_json_generate_string(mrb, gen, RSTRING_PTR(key), RSTRING_LEN(key));
+  }
+
+  mrb_str_cat(mrb, gen->buffer, ":", 1);
+
+  int first = gen->first;
+  hp_json_generate_value(mrb, gen, value);
+  gen->first = first;
+
+  return 0;
+}
+
+static void hp_json_generate_value(mrb_state* mrb, hp_json_generator* gen, mrb_value value)
+{
+  switch (mrb_type(value))
+  {
+    case MRB_TT_FALSE:
+    {
+      if (mrb_nil_p(value)) mrb_str_cat(mrb, gen->buffer, "null", 4);
+      else mrb_str_cat(mrb, gen->buffer, "false", 5);
+      break;
+    }
+    case MRB_TT_TRUE:
+    {
+      mrb_str_cat(mrb, gen->buffer, "true", 4);
+      break;
+    }
+    case MRB_TT_INTEGER:
+    {
+      char out[32];
+      snprintf(out, sizeof(out), "%lld", (long long)mrb_integer(value));
+      mrb_str_cat_cstr(mrb, gen->buffer, out);
+      break;
+    }
+    case MRB_TT_FLOAT:
+    {
+      hp_json_generate_float(mrb, gen, mrb_float(value));
+      break;
+    }
+    case MRB_TT_STRING:
+    {
+      hp_json_generate_string(mrb, gen, RSTRING_PTR(value), RSTRING_LEN(value));
+      break;
+    }
+    case MRB_TT_SYMBOL:
+    {
+      mrb_int len;
+      const char* name = mrb_sym_name_len(mrb, mrb_symbol(value), &len);
+      hp_json_generate_string(mrb, gen, name, len);
+      break;
+    }
+    case MRB_TT_ARRAY:
+    {
+      if (++gen->depth > HP_JSON_MAX_DEPTH) mrb_raise(mrb, E_ARGUMENT_ERROR, "JSON nesting too deep");
+
+      mrb_str_cat(mrb, gen->buffer, "[", 1);
+      for (mrb_int i=0; i<RARRAY_LEN(value); i++)
+      {
+        if (i > 0) mrb_str_cat(mrb, gen->buffer, ",", 1);
+        hp_json_generate_value(mrb, gen, mrb_ary_entry(value, i));
+      }
+      mrb_str_cat(mrb, gen->buffer, "]", 1);
+
+      gen->depth--;
+      break;
+    }
+    case MRB_TT_HASH:
+    {
+      if (++gen->depth > HP_JSON_MAX_DEPTH) mrb_raise(mrb, E_ARGUMENT_ERROR, "JSON nesting too deep");
+
+      mrb_str_cat(mrb, gen->buffer, "{", 1);
+      gen->first = 1;
+      mrb_hash_foreach(mrb, RHASH(value), hp_json_generate_pair, gen);
+      mrb_str_cat(mrb, gen->buffer, "}", 1);
+
+      gen->depth--;
+      break;
+    }
+    default:
+    {
+      mrb_value str = mrb_obj_as_string(mrb, value);
+      hp_json_generate_string(mrb, gen, RSTRING_PTR(str), RSTRING_LEN(str));
+    }
+  }
+}
+
+/**
+  Hokusai::JSON.parse(string)
+*/
+mrb_value hp_json_parse(mrb_state* mrb, mrb_value self)
+{
+  mrb_value str;
+  mrb_get_args(mrb, "S", &str);
+
+  hp_json_parser parser;
+  parser.mrb = mrb;
+  parser.start = RSTRING_PTR(str);
+  parser.cur = parser.start;
+  parser.end = parser.start + RSTRING_LEN(str);
+  parser.depth = 0;
+
+  mrb_value value = hp_json_parse_value(&parser);
+
+  hp_json_skip_whitespace(&parser);
+  if (parser.cur < parser.end) hp_json_raise(&parser, "unexpected trailing characters");
+
+  return value;
+}
+
+/**
+  Hokusai::JSON.generate(object)
+*/
+mrb_value hp_json_generate(mrb_state* mrb, mrb_value self)
+{
+  mrb_value value;
+  mrb_get_args(mrb, "o", &value);
+
+  hp_json_generator gen;
+  gen.buffer = mrb_str_buf_new(mrb, 256);
+  gen.depth = 0;
+  gen.first = 1;
+
+  hp_json_generate_value(mrb, &gen, value);
+  return gen.buffer;
+}
+
+void mrb_define_hokusai_json_class(mrb_state* mrb)
+{
+  struct RClass* module = mrb_module_get(mrb, "Hokusai");
+  struct RClass* json = mrb_define_module_under(mrb, module, "JSON");
+
+  mrb_define_class_method(mrb, json, "parse", hp_json_parse, MRB_ARGS_REQ(1));
+  mrb_define_class_method(mrb, json, "generate", hp_json_generate, MRB_ARGS_REQ(1));
+}
+
+#endif
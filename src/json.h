@@ -0,0 +1,24 @@
+#ifndef HOKUSAI_POCKET_JSON_H
+#define HOKUSAI_POCKET_JSON_H
+
+#include <mruby.h>
+#include <mruby/class.h>
+#include <mruby/string.h>
+#include <mruby/array.h>
+#include <mruby/hash.h>
+#include <mruby/variable.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+/**
+  defines Hokusai::JSON (parse / generate)
+
+  Values are built directly as mruby objects,
+  so it is safe to call from a worker vm (Hokusai::Work#execute)
+  @param mrb the mrb vm
+*/
+void mrb_define_hokusai_json_class(mrb_state* mrb);
+
+#endif
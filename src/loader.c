@@ -0,0 +1,200 @@
+#ifndef HOKUSAI_POCKET_LOADER
+#define HOKUSAI_POCKET_LOADER
+
+#include "loader.h"
+
+typedef struct HpLoaderItem
+{
+  char* key;
+  char* value;
+} hp_loader_item;
+
+static int hp_loader_item_compare(const void* a, const void* b, void* udata)
+{
+  const hp_loader_item* item_a = (hp_loader_item*) a;
+  const hp_loader_item* item_b = (hp_loader_item*) b;
+  return strcmp(item_a->key, item_b->key);
+}
+
+static uint64_t hp_loader_item_hash(const void* item, uint64_t seed0, uint64_t seed1)
+{
+  const hp_loader_item* loader_item = (hp_loader_item*) item;
+  return hashmap_sip(loader_item->key, strlen(loader_item->key), seed0, seed1);
+}
+
+static void hp_loader_item_free(void* item)
+{
+  hp_loader_item* loader_item = (hp_loader_item*) item;
+  free(loader_item->key);
+  free(loader_item->value);
+}
+
+static hp_image_loader* hp_image_loader_current = NULL;
+
+int hp_image_loader_init(hp_image_loader** loader, hp_texture_cache* cache)
+{
+  hp_image_loader* init = malloc(sizeof(hp_image_loader));
+  if (init == NULL) return -1;
+
+  init->pending = hashmap_new(sizeof(hp_loader_item), 0, 0, 0, hp_loader_item_hash, hp_loader_item_compare, hp_loader_item_free, NULL);
+  init->latest = hashmap_new(sizeof(hp_loader_item), 0, 0, 0, hp_loader_item_hash, hp_loader_item_compare, hp_loader_item_free, NULL);
+  if (init->pending == NULL || init->latest == NULL)
+  {
+    if (init->pending) hashmap_free(init->pending);
+    if (init->latest) hashmap_free(init->latest);
+    free(init);
+    return -1;
+  }
+
+  init->cache = cache;
+  init->inflight = 0;
+  init->closing = false;
+  *loader = init;
+  hp_image_loader_current = init;
+
+  return 0;
+}
+
+hp_image_loader* hp_image_loader_get(void)
+{
+  return hp_image_loader_current;
+}
+
+static void hp_image_job_free(hp_image_job* job)
+{
+  UnloadImage(job->image);
+  free(job->key);
+  free(job->alias);
+  free(job);
+}
+
+static void hp_loader_delete(struct hashmap* map, const char* key)
+{
+  const hp_loader_item* item = hashmap_delete(map, &(hp_loader_item){ .key=(char*)key });
+  if (item) hp_loader_item_free((void*)item);
+}
+
+/* render thread, from the upload queue */
+static void hp_image_job_upload(void* data)
+{
+  hp_image_job* job = (hp_image_job*) data;
+  hp_image_loader* loader = job->loader;
+
+  if (hp_texture_cache_put(loader->cache, job->key, &job->image, job->atlas) != NULL)
+  {
+    hp_loader_delete(loader->latest, job->alias);
+    hashmap_set(loader->latest, &(hp_loader_item){ .key=strdup(job->alias), .value=strdup(job->key) });
+  }
+
+  hp_loader_delete(loader->pending, job->key);
+  hp_image_job_free(job);
+}
+
+static void hp_image_job_release(void* data)
+{
+  hp_image_job_free((hp_image_job*) data);
+}
+
+bool hp_image_loader_pending(hp_image_loader* loader, const char* key)
+{
+  if (hashmap_count(loader->pending) == 0) return false;
+
+  return hashmap_get(loader->pending, &(hp_loader_item){ .key=(char*)key }) != NULL;
+}
+
+/* uv worker thread: no raylib GPU calls and no mruby here */
+static void hp_image_loader_execute(uv_work_t* req)
+{
+  hp_image_job* job = (hp_image_job*) req->data;
+  if (job->resize) ImageResize(&job->image, job->width, job->height);
+}
+
+/* loop thread (the render thread, via hp_image_loader_poll) */
+static void hp_image_loader_finished(uv_work_t* req, int status)
+{
+  hp_image_job* job = (hp_image_job*) req->data;
+  hp_image_loader* loader = job->loader;
+  loader->inflight--;
+
+  if (status != 0 || loader->closing)
+  {
+    hp_loader_delete(loader->pending, job->key);
+    hp_image_job_free(job);
+    return;
+  }
+
+  hp_upload_queue* queue = hp_upload_queue_get();
+  size_t bytes = (size_t)GetPixelDataSize(job->image.width, job->image.height, job->image.format);
+
+  if (queue == NULL || hp_upload_queue_push(queue, hp_image_job_upload, hp_image_job_release, job, bytes) == NULL)
+  {
+    hp_image_job_upload(job);
+  }
+}
+
+int hp_image_loader_queue(hp_image_loader* loader, const char* key, const char* alias, Image image, int width, int height, bool resize)
+{
+  hp_image_job* job = malloc(sizeof(hp_image_job));
+  if (job == NULL) return -1;
+
+  job->req.data = (void*)job;
+  job->loader = loader;
+  job->key = strdup(key);
+  job->alias = strdup(alias);
+  job->image = image;
+  job->width = width;
+  job->height = height;
+  job->resize = resize;
+  job->atlas = resize;
+
+  if (job->key == NULL || job->alias == NULL || uv_queue_work(uv_default_loop(), &job->req, hp_image_loader_execute, hp_image_loader_finished) != 0)
+  {
+    free(job->key);
+    free(job->alias);
+    free(job);
+    return -1;
+  }
+
+  loader->inflight++;
+  hashmap_set(loader->pending, &(hp_loader_item){ .key=strdup(key), .value=NULL });
+
+  return 0;
+}
+
+void hp_image_loader_poll(hp_image_loader* loader)
+{
+  if (loader == NULL || loader->inflight == 0) return;
+
+  uv_run(uv_default_loop(), UV_RUN_NOWAIT);
+}
+
+hp_texture_cache_entry* hp_image_loader_fallback(hp_image_loader* loader, const char* alias)
+{
+  const hp_loader_item* item = hashmap_get(loader->latest, &(hp_loader_item){ .key=(char*)alias });
+  if (item == NULL) return NULL;
+
+  return hp_texture_cache_peek(loader->cache, item->value);
+}
+
+bool hp_image_loader_ready(hp_image_loader* loader, const char* alias, const char* key)
+{
+  if (key) return hp_texture_cache_has(loader->cache, key);
+
+  const hp_loader_item* item = hashmap_get(loader->latest, &(hp_loader_item){ .key=(char*)alias });
+  return item != NULL && hp_texture_cache_has(loader->cache, item->value);
+}
+
+void hp_image_loader_free(hp_image_loader* loader)
+{
+  // free the upload queue first, it releases the jobs waiting on it.
+  // jobs still on the thread pool point at the loader, so they finish (uploading nothing) before it goes
+  loader->closing = true;
+  while (loader->inflight > 0) uv_run(uv_default_loop(), UV_RUN_ONCE);
+
+  if (hp_image_loader_current == loader) hp_image_loader_current = NULL;
+  hashmap_free(loader->pending);
+  hashmap_free(loader->latest);
+  free(loader);
+}
+
+#endif
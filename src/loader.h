@@ -0,0 +1,90 @@
+#ifndef HOKUSAI_POCKET_LOADER_H
+#define HOKUSAI_POCKET_LOADER_H
+
+#include <uv.h>
+#include <raylib.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hashmap.h"
+#include "cache.h"
+#include "upload.h"
+
+/**
+  A cache miss being prepared off the render thread.
+  `image` is an owned copy, resized on a uv worker thread.
+*/
+typedef struct HpImageJob
+{
+  uv_work_t req;
+  struct HpImageLoader* loader;
+  char* key;
+  char* alias;
+  Image image;
+  int width;
+  int height;
+  bool resize;
+  bool atlas;
+} hp_image_job;
+
+/**
+  Resizes images for the texture cache on the uv thread pool
+  and hands the results to the upload queue.
+*/
+typedef struct HpImageLoader
+{
+  hp_texture_cache* cache;
+  struct hashmap* pending;
+  struct hashmap* latest;
+  int inflight;
+  bool closing;
+} hp_image_loader;
+
+/**
+  Creates the loader for the render thread's texture cache.
+  hp_image_loader_get returns it until it is freed.
+*/
+int hp_image_loader_init(hp_image_loader** loader, hp_texture_cache* cache);
+hp_image_loader* hp_image_loader_get(void);
+
+/**
+  Runs the completions of finished resizes, handing their images to the upload queue.
+  Called by the render thread once per frame, before the upload queue runs
+*/
+void hp_image_loader_poll(hp_image_loader* loader);
+
+/**
+  Whether a job for this cache key is queued or waiting for upload
+*/
+bool hp_image_loader_pending(hp_image_loader* loader, const char* key);
+
+/**
+  Queues a resize for `key`
+  @param loader the loader
+  @param key the texture cache key
+  @param alias groups every size of the same source image (used for fallbacks)
+  @param image a copy the loader takes ownership of
+  @param width the target width
+  @param height the target height
+  @param resize false to upload the image as is
+  @return 0 on success, -1 when the job couldn't be queued (the image is not consumed)
+*/
+int hp_image_loader_queue(hp_image_loader* loader, const char* key, const char* alias, Image image, int width, int height, bool resize);
+
+/**
+  Whether a texture for `key` is resident in the cache.
+  With a NULL key, whether any size of `alias` is.
+*/
+bool hp_image_loader_ready(hp_image_loader* loader, const char* alias, const char* key);
+
+/**
+  The most recently uploaded texture for an alias, if it is still cached.
+  Used to draw the previous size of an image until the new one is ready.
+*/
+hp_texture_cache_entry* hp_image_loader_fallback(hp_image_loader* loader, const char* alias);
+/**
+  Waits for the jobs still on the thread pool, dropping their images, then frees the loader
+*/
+void hp_image_loader_free(hp_image_loader* loader);
+
+#endif
@@ -0,0 +1,146 @@
+#ifndef HOKUSAI_POCKET_MEASURE_CACHE
+#define HOKUSAI_POCKET_MEASURE_CACHE
+
+#include "measure_cache.h"
+
+typedef struct HpMeasureCacheItem
+{
+  uint64_t hash;
+  size_t bytes;
+  int size;
+  hp_measure_cache_entry* entry;
+} hp_measure_cache_item;
+
+static int hp_measure_cache_compare(const void* a, const void* b, void* udata)
+{
+  const hp_measure_cache_item* item_a = (hp_measure_cache_item*) a;
+  const hp_measure_cache_item* item_b = (hp_measure_cache_item*) b;
+
+  if (item_a->hash != item_b->hash) return item_a->hash < item_b->hash ? -1 : 1;
+  if (item_a->bytes != item_b->bytes) return item_a->bytes < item_b->bytes ? -1 : 1;
+  return item_a->size - item_b->size;
+}
+
+static uint64_t hp_measure_cache_item_hash(const void* item, uint64_t seed0, uint64_t seed1)
+{
+  const hp_measure_cache_item* cache_item = (hp_measure_cache_item*) item;
+  // the string is hashed already, mix in the size
+  return cache_item->hash ^ ((uint64_t) cache_item->size * 0x9E3779B97F4A7C15ULL);
+}
+
+int hp_measure_cache_init(hp_measure_cache** cache, int capacity)
+{
+  hp_measure_cache* init = malloc(sizeof(hp_measure_cache));
+  if (init == NULL) return -1;
+
+  if (capacity < 1) capacity = 1;
+  init->entries = malloc(sizeof(hp_measure_cache_entry) * capacity);
+  init->map = hashmap_new(sizeof(hp_measure_cache_item), capacity, 0, 0, hp_measure_cache_item_hash, hp_measure_cache_compare, NULL, NULL);
+
+  if (init->entries == NULL || init->map == NULL)
+  {
+    if (init->map) hashmap_free(init->map);
+    free(init->entries);
+    free(init);
+    return -1;
+  }
+
+  init->len = 0;
+  init->capacity = capacity;
+  init->head = NULL;
+  init->tail = NULL;
+  init->hits = 0;
+  init->misses = 0;
+  init->evictions = 0;
+  *cache = init;
+
+  return 0;
+}
+
+uint64_t hp_measure_cache_hash(const char* text, size_t bytes)
+{
+  return hashmap_sip(text, bytes, 0, 0);
+}
+
+static void hp_measure_cache_unlink(hp_measure_cache* cache, hp_measure_cache_entry* entry)
+{
+  if (entry->prev) entry->prev->next = entry->next;
+  else cache->head = entry->next;
+
+  if (entry->next) entry->next->prev = entry->prev;
+  else cache->tail = entry->prev;
+
+  entry->prev = NULL;
+  entry->next = NULL;
+}
+
+static void hp_measure_cache_push_front(hp_measure_cache* cache, hp_measure_cache_entry* entry)
+{
+  entry->prev = NULL;
+  entry->next = cache->head;
+  if (cache->head) cache->head->prev = entry;
+  cache->head = entry;
+  if (cache->tail == NULL) cache->tail = entry;
+}
+
+bool hp_measure_cache_get(hp_measure_cache* cache, uint64_t hash, size_t bytes, int size, Vector2* measured)
+{
+  const hp_measure_cache_item* item = hashmap_get(cache->map, &(hp_measure_cache_item){ .hash=hash, .bytes=bytes, .size=size });
+  if (item == NULL)
+  {
+    cache->misses++;
+    return false;
+  }
+
+  cache->hits++;
+  if (cache->head != item->entry)
+  {
+    hp_measure_cache_unlink(cache, item->entry);
+    hp_measure_cache_push_front(cache, item->entry);
+  }
+
+  *measured = item->entry->measured;
+  return true;
+}
+
+void hp_measure_cache_put(hp_measure_cache* cache, uint64_t hash, size_t bytes, int size, Vector2 measured)
+{
+  hp_measure_cache_item key = { .hash=hash, .bytes=bytes, .size=size };
+  const hp_measure_cache_item* found = hashmap_get(cache->map, &key);
+  if (found != NULL)
+  {
+    found->entry->measured = measured;
+    return;
+  }
+
+  hp_measure_cache_entry* entry;
+  if (cache->len < cache->capacity)
+  {
+    entry = &cache->entries[cache->len++];
+  }
+  else
+  {
+    entry = cache->tail;
+    hp_measure_cache_unlink(cache, entry);
+    hashmap_delete(cache->map, &(hp_measure_cache_item){ .hash=entry->hash, .bytes=entry->bytes, .size=entry->size });
+    cache->evictions++;
+  }
+
+  entry->hash = hash;
+  entry->bytes = bytes;
+  entry->size = size;
+  entry->measured = measured;
+  hp_measure_cache_push_front(cache, entry);
+
+  key.entry = entry;
+  hashmap_set(cache->map, &key);
+}
+
+void hp_measure_cache_free(hp_measure_cache* cache)
+{
+  hashmap_free(cache->map);
+  free(cache->entries);
+  free(cache);
+}
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef HOKUSAI_POCKET_MEASURE_CACHE_H
+#define HOKUSAI_POCKET_MEASURE_CACHE_H
+
+#include <raylib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "hashmap.h"
+
+#define HP_MEASURE_CACHE_DEFAULT_CAPACITY 256
+
+/**
+  A measured string, linked most to least recently used.
+  Strings are only kept as their hash and byte length.
+*/
+typedef struct HpMeasureCacheEntry
+{
+  uint64_t hash;
+  size_t bytes;
+  int size;
+  Vector2 measured;
+  struct HpMeasureCacheEntry* prev;
+  struct HpMeasureCacheEntry* next;
+} hp_measure_cache_entry;
+
+/**
+  A bounded LRU of Font#measure results, keyed by (string hash, size).
+  Every entry is allocated up front, a full cache reuses its least recently used one.
+*/
+typedef struct HpMeasureCache
+{
+  struct hashmap* map;
+  hp_measure_cache_entry* entries;
+  int len;
+  int capacity;
+  hp_measure_cache_entry* head;
+  hp_measure_cache_entry* tail;
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t evictions;
+} hp_measure_cache;
+
+int hp_measure_cache_init(hp_measure_cache** cache, int capacity);
+
+/**
+  The hash `text` is looked up and stored under
+*/
+uint64_t hp_measure_cache_hash(const char* text, size_t bytes);
+
+/**
+  Looks up a measurement, counting the hit or miss
+  @param measured out param for the cached measurement
+  @return whether it was cached
+*/
+bool hp_measure_cache_get(hp_measure_cache* cache, uint64_t hash, size_t bytes, int size, Vector2* measured);
+
+/**
+  Stores a measurement, replacing the least recently used one when full
+*/
+void hp_measure_cache_put(hp_measure_cache* cache, uint64_t hash, size_t bytes, int size, Vector2 measured);
+void hp_measure_cache_free(hp_measure_cache* cache);
+
+#endif
@@ -9,6 +9,7 @@
 #include "migrate.c"
 #include <ast.h>
 #include <style.h>
+#include <json.h>
 #include <pocket.h>
 
 /**
@@ -212,6 +213,9 @@ static void mrb_uv_loop_queue_execute(uv_work_t* req)
 
   if (context->mrb->exc) mrb_print_error(context->mrb);
 
+  // this work's vm is done parsing, drop the pool thread's parser along with it
+  hoku_parser_release();
+
   if (!mrb_nil_p(execution_result))
   {
     /**
@@ -278,6 +282,7 @@ mrb_value mrb_uv_loop_queue(mrb_state* mrb, mrb_value self)
   struct RClass* mod = mrb_define_module(mrb2, "Hokusai");
   mrb_define_hokusai_ast_class(mrb2);
   mrb_define_hokusai_style_class(mrb2);
+  mrb_define_hokusai_json_class(mrb2);
   load_pocket(mrb2);
   migrate_all_symbols(mrb, mrb2);
 
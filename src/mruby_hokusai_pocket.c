@@ -47,10 +47,13 @@ void mrb_mruby_hokusai_pocket_gem_init(mrb_state* mrb)
   
   mrb_define_hokusai_style_class(mrb);
   mrb_define_hokusai_ast_class(mrb);
+  mrb_define_hokusai_template_cache(mrb);
   mrb_define_hokusai_font_class(mrb);
   mrb_define_hokusai_texture_class(mrb);
   mrb_define_hokusai_image_class(mrb);
   mrb_define_hokusai_music_class(mrb);
+  mrb_define_hokusai_json_class(mrb);
+  mrb_define_hokusai_piece_table_class(mrb);
 
 #if defined(HP_HTTP)
   mrb_define_http_req_class(mrb);
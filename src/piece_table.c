@@ -0,0 +1,210 @@
+#ifndef HOKUSAI_POCKET_PIECE_TABLE
+#define HOKUSAI_POCKET_PIECE_TABLE
+
+#include "piece_table.h"
+
+static void hp_piece_table_type_free(mrb_state* mrb, void* payload)
+{
+  hoku_rope_free((hoku_rope*) payload);
+}
+
+static struct mrb_data_type hp_piece_table_type = { "PieceTable", hp_piece_table_type_free };
+
+static struct RClass* hp_piece_table_error(mrb_state* mrb)
+{
+  struct RClass* hokusai_class = mrb_module_get(mrb, "Hokusai");
+  return mrb_class_get_under(mrb, hokusai_class, "Error");
+}
+
+static hoku_rope* hp_piece_table_get(mrb_state* mrb, mrb_value self)
+{
+  hoku_rope* rope = DATA_GET_PTR(mrb, self, &hp_piece_table_type, hoku_rope);
+  if (!rope) mrb_raise(mrb, E_ARGUMENT_ERROR, "uninitialized piece table");
+
+  return rope;
+}
+
+static void hp_piece_table_check(mrb_state* mrb, int status, mrb_int offset)
+{
+  if (status == -1) mrb_raisef(mrb, hp_piece_table_error(mrb), "Piece table offset is greater than the buffer! %i", offset);
+  if (status == -2) mrb_raise(mrb, E_RUNTIME_ERROR, "Cannot allocate piece table");
+}
+
+static size_t hp_piece_table_offset(mrb_state* mrb, mrb_int offset)
+{
+  if (offset < 0) mrb_raise(mrb, hp_piece_table_error(mrb), "Piece table offset is negative");
+
+  return (size_t) offset;
+}
+
+static mrb_value hp_piece_table_initialize(mrb_state* mrb, mrb_value self)
+{
+  mrb_value buffer = mrb_nil_value();
+  mrb_get_args(mrb, "|S", &buffer);
+
+  hoku_rope* rope = (hoku_rope*) DATA_PTR(self);
+  if (rope) hoku_rope_free(rope);
+  mrb_data_init(self, NULL, &hp_piece_table_type);
+
+  const char* text = mrb_nil_p(buffer) ? "" : RSTRING_PTR(buffer);
+  size_t bytes = mrb_nil_p(buffer) ? 0 : RSTRING_LEN(buffer);
+  if (hoku_rope_init(&rope, text, bytes) == -1) mrb_raise(mrb, E_RUNTIME_ERROR, "Cannot allocate piece table");
+
+  mrb_data_init(self, rope, &hp_piece_table_type);
+  return self;
+}
+
+static mrb_value hp_piece_table_insert(mrb_state* mrb, mrb_value self)
+{
+  mrb_value text;
+  mrb_int offset;
+  hoku_rope* rope = hp_piece_table_get(mrb, self);
+  mrb_int argc = mrb_get_args(mrb, "S|i", &text, &offset);
+
+  if (RSTRING_LEN(text) == 0) return mrb_nil_value();
+  // before the last character of the original buffer, as it always was
+  if (argc == 1) offset = (mrb_int) rope->original_chars - 1;
+
+  hp_piece_table_check(mrb, hoku_rope_insert(rope, hp_piece_table_offset(mrb, offset), RSTRING_PTR(text), RSTRING_LEN(text)), offset);
+  return mrb_nil_value();
+}
+
+static mrb_value hp_piece_table_delete(mrb_state* mrb, mrb_value self)
+{
+  mrb_int offset;
+  mrb_int count;
+  mrb_get_args(mrb, "ii", &offset, &count);
+  hoku_rope* rope = hp_piece_table_get(mrb, self);
+
+  if (count < 0) mrb_raise(mrb, hp_piece_table_error(mrb), "Piece table count is negative");
+  hp_piece_table_check(mrb, hoku_rope_delete(rope, hp_piece_table_offset(mrb, offset), count), offset + count);
+  return mrb_nil_value();
+}
+
+typedef struct HpPieceTableCopy
+{
+  mrb_state* mrb;
+  mrb_value str;
+} hp_piece_table_copy;
+
+static void hp_piece_table_append(const char* text, size_t bytes, void* data)
+{
+  hp_piece_table_copy* copy = (hp_piece_table_copy*) data;
+  mrb_str_cat(copy->mrb, copy->str, text, bytes);
+}
+
+static mrb_value hp_piece_table_slice_range(mrb_state* mrb, hoku_rope* rope, size_t offset, size_t count)
+{
+  hp_piece_table_copy copy = { mrb, mrb_str_new_capa(mrb, count) };
+  hp_piece_table_check(mrb, hoku_rope_each(rope, offset, count, hp_piece_table_append, &copy), offset + count);
+
+  return copy.str;
+}
+
+static mrb_value hp_piece_table_to_s(mrb_state* mrb, mrb_value self)
+{
+  hoku_rope* rope = hp_piece_table_get(mrb, self);
+  hp_piece_table_copy copy = { mrb, mrb_str_new_capa(mrb, hoku_rope_bytes(rope)) };
+  hoku_rope_each(rope, 0, hoku_rope_chars(rope), hp_piece_table_append, &copy);
+
+  return copy.str;
+}
+
+static mrb_value hp_piece_table_slice(mrb_state* mrb, mrb_value self)
+{
+  mrb_int offset;
+  mrb_int count;
+  mrb_get_args(mrb, "ii", &offset, &count);
+  hoku_rope* rope = hp_piece_table_get(mrb, self);
+
+  if (count < 0) mrb_raise(mrb, hp_piece_table_error(mrb), "Piece table count is negative");
+  return hp_piece_table_slice_range(mrb, rope, hp_piece_table_offset(mrb, offset), count);
+}
+
+static mrb_value hp_piece_table_size(mrb_state* mrb, mrb_value self)
+{
+  return mrb_int_value(mrb, hoku_rope_chars(hp_piece_table_get(mrb, self)));
+}
+
+static mrb_value hp_piece_table_line_count(mrb_state* mrb, mrb_value self)
+{
+  return mrb_int_value(mrb, hoku_rope_lines(hp_piece_table_get(mrb, self)));
+}
+
+static mrb_value hp_piece_table_line_at(mrb_state* mrb, mrb_value self)
+{
+  mrb_int offset;
+  mrb_get_args(mrb, "i", &offset);
+  hoku_rope* rope = hp_piece_table_get(mrb, self);
+
+  size_t at = hp_piece_table_offset(mrb, offset);
+  if (at > hoku_rope_chars(rope)) hp_piece_table_check(mrb, -1, offset);
+
+  return mrb_int_value(mrb, hoku_rope_line_at(rope, at));
+}
+
+static mrb_value hp_piece_table_line_offset(mrb_state* mrb, mrb_value self)
+{
+  mrb_int line;
+  mrb_get_args(mrb, "i", &line);
+  hoku_rope* rope = hp_piece_table_get(mrb, self);
+
+  if (line < 0) return mrb_nil_value();
+  long offset = hoku_rope_line_offset(rope, line);
+
+  return offset < 0 ? mrb_nil_value() : mrb_int_value(mrb, offset);
+}
+
+static void hp_piece_table_push_piece(hoku_rope_node* node, void* data)
+{
+  hp_piece_table_copy* copy = (hp_piece_table_copy*) data;
+  mrb_state* mrb = copy->mrb;
+  mrb_value which = mrb_symbol_value(node->source == HOKU_ROPE_ORIGINAL ? mrb_intern_lit(mrb, "original") : mrb_intern_lit(mrb, "add"));
+  mrb_value piece[3] = { which, mrb_int_value(mrb, node->char_start), mrb_int_value(mrb, node->chars) };
+
+  mrb_ary_push(mrb, copy->str, mrb_ary_new_from_values(mrb, 3, piece));
+}
+
+static mrb_value hp_piece_table_pieces(mrb_state* mrb, mrb_value self)
+{
+  hoku_rope* rope = hp_piece_table_get(mrb, self);
+  hp_piece_table_copy copy = { mrb, mrb_ary_new(mrb) };
+  hoku_rope_each_piece(rope, hp_piece_table_push_piece, &copy);
+
+  return copy.str;
+}
+
+static mrb_value hp_piece_table_buffer(mrb_state* mrb, mrb_value self)
+{
+  hoku_rope* rope = hp_piece_table_get(mrb, self);
+  return mrb_str_new(mrb, rope->original, rope->original_bytes);
+}
+
+static mrb_value hp_piece_table_buffer_add(mrb_state* mrb, mrb_value self)
+{
+  hoku_rope* rope = hp_piece_table_get(mrb, self);
+  return mrb_str_new(mrb, rope->add, rope->add_bytes);
+}
+
+void mrb_define_hokusai_piece_table_class(mrb_state* mrb)
+{
+  struct RClass* module = mrb_module_get(mrb, "Hokusai");
+  struct RClass* util = mrb_define_module_under(mrb, module, "Util");
+  struct RClass* piece_table = mrb_define_class_under(mrb, util, "PieceTable", mrb->object_class);
+  MRB_SET_INSTANCE_TT(piece_table, MRB_TT_DATA);
+
+  mrb_define_method(mrb, piece_table, "initialize", hp_piece_table_initialize, MRB_ARGS_OPT(1));
+  mrb_define_method(mrb, piece_table, "insert", hp_piece_table_insert, MRB_ARGS_ARG(1, 1));
+  mrb_define_method(mrb, piece_table, "delete", hp_piece_table_delete, MRB_ARGS_REQ(2));
+  mrb_define_method(mrb, piece_table, "to_s", hp_piece_table_to_s, MRB_ARGS_NONE());
+  mrb_define_method(mrb, piece_table, "slice", hp_piece_table_slice, MRB_ARGS_REQ(2));
+  mrb_define_method(mrb, piece_table, "size", hp_piece_table_size, MRB_ARGS_NONE());
+  mrb_define_method(mrb, piece_table, "line_count", hp_piece_table_line_count, MRB_ARGS_NONE());
+  mrb_define_method(mrb, piece_table, "line_at", hp_piece_table_line_at, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, piece_table, "line_offset", hp_piece_table_line_offset, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, piece_table, "pieces", hp_piece_table_pieces, MRB_ARGS_NONE());
+  mrb_define_method(mrb, piece_table, "buffer", hp_piece_table_buffer, MRB_ARGS_NONE());
+  mrb_define_method(mrb, piece_table, "buffer_add", hp_piece_table_buffer_add, MRB_ARGS_NONE());
+}
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef HOKUSAI_POCKET_PIECE_TABLE_H
+#define HOKUSAI_POCKET_PIECE_TABLE_H
+
+#include <mruby.h>
+#include <mruby/data.h>
+#include <mruby/class.h>
+#include <mruby/string.h>
+#include <mruby/array.h>
+#include "core-rope.h"
+
+/**
+  defines Hokusai::Util::PieceTable, backed by a hoku_rope
+  @param mrb the mrb vm
+*/
+void mrb_define_hokusai_piece_table_class(mrb_state* mrb);
+
+#endif
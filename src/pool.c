@@ -0,0 +1,174 @@
+#ifndef HOKUSAI_POCKET_POOL
+#define HOKUSAI_POCKET_POOL
+
+#include "pool.h"
+
+static hp_render_pool* hp_render_pool_current = NULL;
+
+static int hp_render_pool_bucket_compare(const void* a, const void* b, void* udata)
+{
+  const hp_render_pool_bucket* bucket_a = (hp_render_pool_bucket*) a;
+  const hp_render_pool_bucket* bucket_b = (hp_render_pool_bucket*) b;
+  if (bucket_a->width != bucket_b->width) return bucket_a->width - bucket_b->width;
+
+  return bucket_a->height - bucket_b->height;
+}
+
+static uint64_t hp_render_pool_bucket_hash(const void* item, uint64_t seed0, uint64_t seed1)
+{
+  const hp_render_pool_bucket* bucket = (hp_render_pool_bucket*) item;
+  int size[2] = { bucket->width, bucket->height };
+  return hashmap_sip(size, sizeof(size), seed0, seed1);
+}
+
+static void hp_render_pool_bucket_free(void* item)
+{
+  hp_render_pool_bucket* bucket = (hp_render_pool_bucket*) item;
+  for (int i=0; i<bucket->len; i++) UnloadRenderTexture(bucket->items[i]);
+  free(bucket->items);
+}
+
+static size_t hp_render_pool_bytes(int width, int height)
+{
+  // color attachment plus the depth renderbuffer
+  return (size_t)width * height * 4 * 2;
+}
+
+int hp_render_pool_init(size_t budget)
+{
+  hp_render_pool* init = malloc(sizeof(hp_render_pool));
+  if (init == NULL) return -1;
+
+  init->buckets = hashmap_new(sizeof(hp_render_pool_bucket), 0, 0, 0, hp_render_pool_bucket_hash, hp_render_pool_bucket_compare, hp_render_pool_bucket_free, NULL);
+  if (init->buckets == NULL)
+  {
+    free(init);
+    return -1;
+  }
+
+  init->budget = budget > 0 ? budget : HP_RENDER_POOL_DEFAULT_BUDGET;
+  init->pooled_bytes = 0;
+  init->pooled = 0;
+  init->live = 0;
+  init->reused = 0;
+  init->allocated = 0;
+  init->scissor = false;
+  hp_render_pool_current = init;
+
+  return 0;
+}
+
+hp_render_pool* hp_render_pool_get(void)
+{
+  return hp_render_pool_current;
+}
+
+static hp_render_pool_bucket* hp_render_pool_bucket_get(hp_render_pool* pool, int width, int height)
+{
+  return (hp_render_pool_bucket*) hashmap_get(pool->buckets, &(hp_render_pool_bucket){ .width=width, .height=height });
+}
+
+bool hp_render_pool_has(hp_render_pool* pool, int width, int height)
+{
+  hp_render_pool_bucket* bucket = hp_render_pool_bucket_get(pool, width, height);
+  return bucket != NULL && bucket->len > 0;
+}
+
+RenderTexture2D hp_render_pool_acquire(hp_render_pool* pool, int width, int height)
+{
+  hp_render_pool_bucket* bucket = hp_render_pool_bucket_get(pool, width, height);
+  pool->live++;
+
+  if (bucket == NULL || bucket->len == 0)
+  {
+    pool->allocated++;
+    return LoadRenderTexture(width, height);
+  }
+
+  RenderTexture2D texture = bucket->items[--bucket->len];
+  pool->pooled--;
+  pool->pooled_bytes -= hp_render_pool_bytes(width, height);
+  pool->reused++;
+
+  // a fresh framebuffer is blank, so is a reused one.
+  // this can run mid-frame (a texture forced ready while drawing),
+  // so clear the framebuffer directly and rebind whatever was bound,
+  // rather than leaving the active texture mode and its matrices.
+  // glClear honours the scissor test, which would only clear part of it.
+  rlDrawRenderBatchActive();
+  unsigned int previous = rlGetActiveFramebuffer();
+  if (pool->scissor) rlDisableScissorTest();
+  rlEnableFramebuffer(texture.id);
+  rlClearColor(0, 0, 0, 0);
+  rlClearScreenBuffers();
+  if (previous) rlEnableFramebuffer(previous);
+  else rlDisableFramebuffer();
+  if (pool->scissor) rlEnableScissorTest();
+
+  return texture;
+}
+
+void hp_render_pool_release(hp_render_pool* pool, RenderTexture2D texture)
+{
+  int width = texture.texture.width;
+  int height = texture.texture.height;
+  size_t bytes = hp_render_pool_bytes(width, height);
+  pool->live--;
+
+  if (texture.id == 0 || pool->pooled_bytes + bytes > pool->budget)
+  {
+    UnloadRenderTexture(texture);
+    return;
+  }
+
+  hp_render_pool_bucket* bucket = hp_render_pool_bucket_get(pool, width, height);
+  if (bucket == NULL)
+  {
+    hashmap_set(pool->buckets, &(hp_render_pool_bucket){ .width=width, .height=height, .items=NULL, .len=0, .cap=0 });
+    if (hashmap_oom(pool->buckets))
+    {
+      UnloadRenderTexture(texture);
+      return;
+    }
+
+    bucket = hp_render_pool_bucket_get(pool, width, height);
+  }
+
+  if (bucket->len == HP_RENDER_POOL_MAX_PER_SIZE)
+  {
+    UnloadRenderTexture(texture);
+    return;
+  }
+
+  if (bucket->len == bucket->cap)
+  {
+    int cap = bucket->cap ? bucket->cap * 2 : 1;
+    if (cap > HP_RENDER_POOL_MAX_PER_SIZE) cap = HP_RENDER_POOL_MAX_PER_SIZE;
+
+    RenderTexture2D* items = realloc(bucket->items, sizeof(RenderTexture2D) * cap);
+    if (items == NULL)
+    {
+      UnloadRenderTexture(texture);
+      return;
+    }
+
+    bucket->items = items;
+    bucket->cap = cap;
+  }
+
+  bucket->items[bucket->len++] = texture;
+  pool->pooled++;
+  pool->pooled_bytes += bytes;
+}
+
+void hp_render_pool_free(void)
+{
+  hp_render_pool* pool = hp_render_pool_current;
+  if (pool == NULL) return;
+
+  hp_render_pool_current = NULL;
+  hashmap_free(pool->buckets);
+  free(pool);
+}
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef HOKUSAI_POCKET_POOL_H
+#define HOKUSAI_POCKET_POOL_H
+
+#include <raylib.h>
+#include <rlgl.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include "hashmap.h"
+
+#define HP_RENDER_POOL_DEFAULT_BUDGET (64 * 1024 * 1024)
+#define HP_RENDER_POOL_MAX_PER_SIZE 4
+
+/**
+  Released render textures of one size
+*/
+typedef struct HpRenderPoolBucket
+{
+  int width;
+  int height;
+  RenderTexture2D* items;
+  int len;
+  int cap;
+} hp_render_pool_bucket;
+
+/**
+  Keeps released render textures around, bucketed by exact size,
+  so the next texture created at that size reuses one
+  instead of allocating a new framebuffer.
+
+  At most `HP_RENDER_POOL_MAX_PER_SIZE` textures are kept per size
+  and `budget` bytes in total, anything past that is unloaded.
+*/
+typedef struct HpRenderPool
+{
+  struct hashmap* buckets;
+  size_t budget;
+  size_t pooled_bytes;
+  int pooled;
+  int live;
+  uint64_t reused;
+  uint64_t allocated;
+  // set by the backend while a scissor rect is active
+  bool scissor;
+} hp_render_pool;
+
+/**
+  Creates the render thread's pool.
+  hp_render_pool_get returns NULL before this and after hp_render_pool_free.
+*/
+int hp_render_pool_init(size_t budget);
+hp_render_pool* hp_render_pool_get(void);
+
+/**
+  Whether a released texture of this size is available
+*/
+bool hp_render_pool_has(hp_render_pool* pool, int width, int height);
+
+/**
+  A cleared render texture of this size, pooled or new.
+  Safe to call mid-frame, the bound framebuffer is left as it was.
+*/
+RenderTexture2D hp_render_pool_acquire(hp_render_pool* pool, int width, int height);
+
+/**
+  Returns a texture to the pool, unloading it if the pool is full.
+*/
+void hp_render_pool_release(hp_render_pool* pool, RenderTexture2D texture);
+void hp_render_pool_free(void);
+
+#endif
@@ -0,0 +1,221 @@
+#ifndef HOKUSAI_POCKET_PRIMITIVES
+#define HOKUSAI_POCKET_PRIMITIVES
+
+#include "primitives.h"
+
+/*
+  Quads are wound like raylib's (top left, bottom left, bottom right, top right),
+  anything else is culled.  Angles grow clockwise on screen, so fans and rings
+  are emitted from the far angle back to the near one.
+*/
+
+int hp_corner_segments(float radius)
+{
+  if (radius <= HP_PRIMITIVE_CURVE_ERROR) return 1;
+
+  float step = 2.0f * acosf(1.0f - HP_PRIMITIVE_CURVE_ERROR / radius);
+  int segments = (int)ceilf((PI / 2.0f) / step);
+
+  if (segments < 1) return 1;
+  if (segments > HP_PRIMITIVE_MAX_CORNER_SEGMENTS) return HP_PRIMITIVE_MAX_CORNER_SEGMENTS;
+  return segments;
+}
+
+static void hp_primitive_begin(int quads, Color color)
+{
+  rlCheckRenderBatchLimit(quads * 4);
+
+  Texture2D texture = GetShapesTexture();
+  Rectangle source = GetShapesTextureRectangle();
+
+  rlSetTexture(texture.id);
+  rlBegin(RL_QUADS);
+  rlColor4ub(color.r, color.g, color.b, color.a);
+  rlNormal3f(0.0f, 0.0f, 1.0f);
+  // solid fill, every vertex samples the middle of the shapes rectangle
+  rlTexCoord2f((source.x + source.width / 2.0f) / texture.width, (source.y + source.height / 2.0f) / texture.height);
+}
+
+static void hp_primitive_end(void)
+{
+  rlEnd();
+  rlSetTexture(0);
+}
+
+static inline void hp_primitive_quad(float x, float y, float width, float height)
+{
+  if (width <= 0.0f || height <= 0.0f) return;
+
+  rlVertex2f(x, y);
+  rlVertex2f(x, y + height);
+  rlVertex2f(x + width, y + height);
+  rlVertex2f(x + width, y);
+}
+
+// a quarter circle fan, `angle` in degrees where it starts
+static void hp_primitive_fan(float cx, float cy, float radius, float angle, int segments)
+{
+  float step = 90.0f / segments;
+
+  for (int i = 0; i + 1 < segments; i += 2)
+  {
+    float a = angle + step * i;
+    rlVertex2f(cx, cy);
+    rlVertex2f(cx + cosf(DEG2RAD * (a + step * 2.0f)) * radius, cy + sinf(DEG2RAD * (a + step * 2.0f)) * radius);
+    rlVertex2f(cx + cosf(DEG2RAD * (a + step)) * radius, cy + sinf(DEG2RAD * (a + step)) * radius);
+    rlVertex2f(cx + cosf(DEG2RAD * a) * radius, cy + sinf(DEG2RAD * a) * radius);
+  }
+
+  if (segments % 2)
+  {
+    float a = angle + step * (segments - 1);
+    rlVertex2f(cx, cy);
+    rlVertex2f(cx + cosf(DEG2RAD * (a + step)) * radius, cy + sinf(DEG2RAD * (a + step)) * radius);
+    rlVertex2f(cx + cosf(DEG2RAD * a) * radius, cy + sinf(DEG2RAD * a) * radius);
+    rlVertex2f(cx, cy);
+  }
+}
+
+// a quarter ring between inner and outer
+static void hp_primitive_ring(float cx, float cy, float inner, float outer, float angle, int segments)
+{
+  float step = 90.0f / segments;
+
+  for (int i = 0; i < segments; i++)
+  {
+    float a0 = DEG2RAD * (angle + step * i);
+    float a1 = DEG2RAD * (angle + step * (i + 1));
+
+    rlVertex2f(cx + cosf(a1) * inner, cy + sinf(a1) * inner);
+    rlVertex2f(cx + cosf(a1) * outer, cy + sinf(a1) * outer);
+    rlVertex2f(cx + cosf(a0) * outer, cy + sinf(a0) * outer);
+    rlVertex2f(cx + cosf(a0) * inner, cy + sinf(a0) * inner);
+  }
+}
+
+static float hp_primitive_radius(Rectangle rect, float roundness)
+{
+  if (roundness > 1.0f) roundness = 1.0f;
+  float shortest = rect.width > rect.height ? rect.height : rect.width;
+
+  return roundness * shortest / 2.0f;
+}
+
+void hp_draw_rect(Rectangle rect, Color color)
+{
+  hp_primitive_begin(1, color);
+  hp_primitive_quad(rect.x, rect.y, rect.width, rect.height);
+  hp_primitive_end();
+}
+
+void hp_draw_rect_rounded(Rectangle rect, float roundness, Color color)
+{
+  float radius = hp_primitive_radius(rect, roundness);
+  if (radius <= 0.0f || rect.width < 1.0f || rect.height < 1.0f)
+  {
+    hp_draw_rect(rect, color);
+    return;
+  }
+
+  int segments = hp_corner_segments(radius);
+  float x = rect.x;
+  float y = rect.y;
+  float w = rect.width;
+  float h = rect.height;
+
+  hp_primitive_begin(4 * ((segments + 1) / 2) + 3, color);
+    // bottom right, bottom left, top left, top right
+    hp_primitive_fan(x + w - radius, y + h - radius, radius, 0.0f, segments);
+    hp_primitive_fan(x + radius, y + h - radius, radius, 90.0f, segments);
+    hp_primitive_fan(x + radius, y + radius, radius, 180.0f, segments);
+    hp_primitive_fan(x + w - radius, y + radius, radius, 270.0f, segments);
+
+    // the middle column, then the sides between the corners
+    hp_primitive_quad(x + radius, y, w - radius * 2.0f, h);
+    hp_primitive_quad(x, y + radius, radius, h - radius * 2.0f);
+    hp_primitive_quad(x + w - radius, y + radius, radius, h - radius * 2.0f);
+  hp_primitive_end();
+}
+
+void hp_draw_rect_rounded_outline(Rectangle rect, float roundness, float thickness, Color color)
+{
+  if (thickness <= 0.0f) return;
+
+  float radius = hp_primitive_radius(rect, roundness);
+  float x = rect.x;
+  float y = rect.y;
+  float w = rect.width;
+  float h = rect.height;
+
+  if (radius <= 0.0f)
+  {
+    // square corners, grown outwards like the rounded outline
+    hp_draw_rect_outline((Rectangle){ x - thickness, y - thickness, w + thickness * 2.0f, h + thickness * 2.0f }, thickness, color);
+    return;
+  }
+
+  int segments = hp_corner_segments(radius + thickness);
+  float outer = radius + thickness;
+
+  hp_primitive_begin(4 * segments + 4, color);
+    hp_primitive_ring(x + w - radius, y + h - radius, radius, outer, 0.0f, segments);
+    hp_primitive_ring(x + radius, y + h - radius, radius, outer, 90.0f, segments);
+    hp_primitive_ring(x + radius, y + radius, radius, outer, 180.0f, segments);
+    hp_primitive_ring(x + w - radius, y + radius, radius, outer, 270.0f, segments);
+
+    // top, bottom, left, right
+    hp_primitive_quad(x + radius, y - thickness, w - radius * 2.0f, thickness);
+    hp_primitive_quad(x + radius, y + h, w - radius * 2.0f, thickness);
+    hp_primitive_quad(x - thickness, y + radius, thickness, h - radius * 2.0f);
+    hp_primitive_quad(x + w, y + radius, thickness, h - radius * 2.0f);
+  hp_primitive_end();
+}
+
+void hp_draw_rect_outline(Rectangle rect, float thickness, Color color)
+{
+  if (thickness <= 0.0f) return;
+
+  if (thickness * 2.0f >= rect.width || thickness * 2.0f >= rect.height)
+  {
+    hp_draw_rect(rect, color);
+    return;
+  }
+
+  hp_primitive_begin(4, color);
+    hp_primitive_quad(rect.x, rect.y, rect.width, thickness);
+    hp_primitive_quad(rect.x, rect.y + rect.height - thickness, rect.width, thickness);
+    hp_primitive_quad(rect.x, rect.y + thickness, thickness, rect.height - thickness * 2.0f);
+    hp_primitive_quad(rect.x + rect.width - thickness, rect.y + thickness, thickness, rect.height - thickness * 2.0f);
+  hp_primitive_end();
+}
+
+void hp_draw_rect_sides(Rectangle rect, float top, float right, float bottom, float left, Color color)
+{
+  float x = rect.x;
+  float y = rect.y;
+  float w = rect.width;
+  float h = rect.height;
+
+  hp_primitive_begin(4, color);
+    if (top > 0.0f) hp_primitive_quad(x, y - top / 2.0f, w, top);
+    if (left > 0.0f) hp_primitive_quad(x - left / 2.0f, y, left, h);
+    if (right > 0.0f) hp_primitive_quad(x + w - right / 2.0f, y, right, h);
+    if (bottom > 0.0f) hp_primitive_quad(x, y + h - bottom / 2.0f, w, bottom);
+  hp_primitive_end();
+}
+
+void hp_draw_circle(Vector2 center, float radius, Color color)
+{
+  if (radius <= 0.0f) return;
+
+  int segments = hp_corner_segments(radius);
+
+  hp_primitive_begin(4 * ((segments + 1) / 2), color);
+    for (int i = 0; i < 4; i++)
+    {
+      hp_primitive_fan(center.x, center.y, radius, 90.0f * i, segments);
+    }
+  hp_primitive_end();
+}
+
+#endif
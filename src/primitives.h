@@ -0,0 +1,53 @@
+#ifndef HOKUSAI_POCKET_PRIMITIVES_H
+#define HOKUSAI_POCKET_PRIMITIVES_H
+
+#include <raylib.h>
+#include <rlgl.h>
+#include <math.h>
+
+// the most a rounded corner or circle edge may stray from the true curve, in pixels
+#define HP_PRIMITIVE_CURVE_ERROR 0.5f
+#define HP_PRIMITIVE_MAX_CORNER_SEGMENTS 24
+
+/**
+  Solid 2D primitives written straight into rlgl's active batch.
+
+  Every primitive goes out as quads on the shapes texture,
+  the same state raylib's own shape functions use,
+  so runs of rects, outlines and circles share one draw call
+  and the batch only flushes on texture, shader, blend or scissor changes.
+  Curves get as many segments as their radius needs, not a fixed count.
+*/
+
+/**
+  Segments for a quarter circle of `radius`,
+  so no point on the curve is further than HP_PRIMITIVE_CURVE_ERROR from it
+*/
+int hp_corner_segments(float radius);
+
+void hp_draw_rect(Rectangle rect, Color color);
+
+/**
+  Same geometry as DrawRectangleRounded
+  @param roundness 0.0 - 1.0 of the shorter side
+*/
+void hp_draw_rect_rounded(Rectangle rect, float roundness, Color color);
+
+/**
+  Same geometry as DrawRectangleRoundedLinesEx (the outline sits outside `rect`)
+*/
+void hp_draw_rect_rounded_outline(Rectangle rect, float roundness, float thickness, Color color);
+
+/**
+  Same geometry as DrawRectangleLinesEx (the outline sits inside `rect`)
+*/
+void hp_draw_rect_outline(Rectangle rect, float thickness, Color color);
+
+/**
+  Per side outline, each centered on its edge like DrawLineEx
+*/
+void hp_draw_rect_sides(Rectangle rect, float top, float right, float bottom, float left, Color color);
+
+void hp_draw_circle(Vector2 center, float radius, Color color);
+
+#endif
@@ -0,0 +1,163 @@
+#ifndef HOKUSAI_POCKET_SHADER
+#define HOKUSAI_POCKET_SHADER
+
+#include "shader.h"
+
+static int hp_shader_slot_compare(const void* a, const void* b, void* udata)
+{
+  const hp_shader_slot* slot_a = (hp_shader_slot*) a;
+  const hp_shader_slot* slot_b = (hp_shader_slot*) b;
+  return strcmp(slot_a->name, slot_b->name);
+}
+
+static uint64_t hp_shader_slot_hash(const void* item, uint64_t seed0, uint64_t seed1)
+{
+  const hp_shader_slot* slot = (hp_shader_slot*) item;
+  return hashmap_sip(slot->name, strlen(slot->name), seed0, seed1);
+}
+
+static void hp_shader_slot_free(void* item)
+{
+  hp_shader_slot* slot = (hp_shader_slot*) item;
+  free(slot->name);
+}
+
+int hp_shader_uniform_components(int type)
+{
+  switch (type)
+  {
+    case SHADER_UNIFORM_FLOAT:
+    case SHADER_UNIFORM_INT:
+      return 1;
+    case SHADER_UNIFORM_VEC2:
+    case SHADER_UNIFORM_IVEC2:
+      return 2;
+    case SHADER_UNIFORM_VEC3:
+    case SHADER_UNIFORM_IVEC3:
+      return 3;
+    case SHADER_UNIFORM_VEC4:
+    case SHADER_UNIFORM_IVEC4:
+      return 4;
+    default:
+      return 0;
+  }
+}
+
+hp_shader_program* hp_shader_program_init(Shader shader)
+{
+  hp_shader_program* program = malloc(sizeof(hp_shader_program));
+  if (program == NULL) return NULL;
+
+  program->slots = hashmap_new(sizeof(hp_shader_slot), 0, 0, 0, hp_shader_slot_hash, hp_shader_slot_compare, hp_shader_slot_free, NULL);
+  if (program->slots == NULL)
+  {
+    free(program);
+    return NULL;
+  }
+
+  program->shader = shader;
+  program->uniforms = NULL;
+  program->len = 0;
+  program->cap = 0;
+  program->uploads = 0;
+  program->skipped = 0;
+
+  return program;
+}
+
+static hp_shader_uniform* hp_shader_program_slot(hp_shader_program* program, const char* name)
+{
+  const hp_shader_slot* slot = hashmap_get(program->slots, &(hp_shader_slot){ .name=(char*)name });
+  if (slot != NULL) return &program->uniforms[slot->index];
+
+  if (program->len == program->cap)
+  {
+    int cap = program->cap == 0 ? 8 : program->cap * 2;
+    hp_shader_uniform* uniforms = realloc(program->uniforms, sizeof(hp_shader_uniform) * cap);
+    if (uniforms == NULL) return NULL;
+
+    program->uniforms = uniforms;
+    program->cap = cap;
+  }
+
+  char* copy = strdup(name);
+  if (copy == NULL) return NULL;
+
+  hp_shader_uniform* uniform = &program->uniforms[program->len];
+  memset(uniform, 0, sizeof(hp_shader_uniform));
+  uniform->location = GetShaderLocation(program->shader, name);
+  uniform->type = HP_SHADER_UNIFORM_SAMPLER;
+
+  hashmap_set(program->slots, &(hp_shader_slot){ .name=copy, .index=program->len });
+  if (hashmap_oom(program->slots))
+  {
+    free(copy);
+    return NULL;
+  }
+
+  program->len++;
+  return uniform;
+}
+
+int hp_shader_program_location(hp_shader_program* program, const char* name)
+{
+  hp_shader_uniform* uniform = hp_shader_program_slot(program, name);
+  if (uniform == NULL) return -1;
+
+  return uniform->location;
+}
+
+int hp_shader_program_set(hp_shader_program* program, const char* name, int type, const void* value)
+{
+  int components = hp_shader_uniform_components(type);
+  if (components == 0) return -1;
+
+  hp_shader_uniform* uniform = hp_shader_program_slot(program, name);
+  if (uniform == NULL) return -1;
+
+  // nothing to send to a uniform the compiler dropped
+  if (uniform->location < 0) return 0;
+
+  size_t size = components * 4;
+  if (uniform->uploaded && uniform->type == type && memcmp(&uniform->value, value, size) == 0)
+  {
+    program->skipped++;
+    return 0;
+  }
+
+  uniform->type = type;
+  memcpy(&uniform->value, value, size);
+  uniform->dirty = true;
+
+  return 0;
+}
+
+int hp_shader_program_upload(hp_shader_program* program)
+{
+  int sent = 0;
+
+  for (int i=0; i<program->len; i++)
+  {
+    hp_shader_uniform* uniform = &program->uniforms[i];
+    if (!uniform->dirty) continue;
+
+    SetShaderValue(program->shader, uniform->location, &uniform->value, uniform->type);
+    uniform->dirty = false;
+    uniform->uploaded = true;
+    sent++;
+  }
+
+  program->uploads += sent;
+  return sent;
+}
+
+void hp_shader_program_free(hp_shader_program* program)
+{
+  if (program == NULL) return;
+
+  hashmap_free(program->slots);
+  free(program->uniforms);
+  free(program);
+}
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef HOKUSAI_POCKET_SHADER_H
+#define HOKUSAI_POCKET_SHADER_H
+
+#include <raylib.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hashmap.h"
+
+// vec4 / ivec4 is the widest uniform ShaderBegin takes
+#define HP_SHADER_UNIFORM_MAX_COMPONENTS 4
+// marks a slot that only holds a sampler location
+#define HP_SHADER_UNIFORM_SAMPLER -1
+
+/**
+  One uniform of a program, with the value last sent to the GPU
+*/
+typedef struct HpShaderUniform
+{
+  int location;
+  int type;
+  union
+  {
+    float f[HP_SHADER_UNIFORM_MAX_COMPONENTS];
+    int i[HP_SHADER_UNIFORM_MAX_COMPONENTS];
+  } value;
+  bool uploaded;
+  bool dirty;
+} hp_shader_uniform;
+
+typedef struct HpShaderSlot
+{
+  char* name;
+  int index;
+} hp_shader_slot;
+
+/**
+  A compiled shader and its uniforms.
+
+  Locations are looked up by name once per program,
+  values live in one packed array with a dirty flag each,
+  and `hp_shader_program_upload` only sends the ones that changed.
+  A program keeps its uniform values between draws,
+  so an unchanged value never needs sending again.
+*/
+typedef struct HpShaderProgram
+{
+  Shader shader;
+  struct hashmap* slots;
+  hp_shader_uniform* uniforms;
+  int len;
+  int cap;
+  uint64_t uploads;
+  uint64_t skipped;
+} hp_shader_program;
+
+/**
+  Shader compile timings, for Hokusai.shader_stats
+*/
+typedef struct HpShaderStats
+{
+  uint64_t compiled;
+  double compile_ms;
+  int precompiled;
+  double precompile_ms;
+  int frame_compiled;
+  double frame_ms;
+  int last_compiled;
+  double last_ms;
+} hp_shader_stats;
+
+hp_shader_program* hp_shader_program_init(Shader shader);
+
+/**
+  The cached location of `name`, -1 when the program doesn't use it
+*/
+int hp_shader_program_location(hp_shader_program* program, const char* name);
+
+/**
+  Stages a value for `name`, marking it dirty if it differs from the last one sent.
+  @param type a raylib SHADER_UNIFORM_* float or int type
+  @return -1 for types that aren't supported
+*/
+int hp_shader_program_set(hp_shader_program* program, const char* name, int type, const void* value);
+
+/**
+  Sends every dirty uniform to the GPU
+  @return how many were sent
+*/
+int hp_shader_program_upload(hp_shader_program* program);
+
+/**
+  Frees the tables, the shader itself belongs to the caller
+*/
+void hp_shader_program_free(hp_shader_program* program);
+
+/**
+  Components in a SHADER_UNIFORM_* float or int type, 0 for anything else
+*/
+int hp_shader_uniform_components(int type);
+
+#endif
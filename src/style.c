@@ -99,7 +99,7 @@ mrb_value style_parse(mrb_state* mrb, mrb_value self)
   hoku_style* style;
   mrb_get_args(mrb, "S", &templateval);
   char* template = mrb_str_to_cstr(mrb, templateval);
-  if (hoku_style_from_template(&style, template) != 0)
+  if (hp_template_cache_style(&style, template) != 0)
   {
     mrb_raisef(mrb, E_STANDARD_ERROR, "Failed to parse style!\n");
   }
@@ -8,6 +8,7 @@
 #include <mruby/variable.h>
 #include <mruby/string.h>
 #include "core-hml.h"
+#include "template_cache.h"
 
 void mrb_define_hokusai_style_class(mrb_state* mrb);
 
@@ -0,0 +1,392 @@
+#ifndef HOKUSAI_POCKET_TEMPLATE_CACHE
+#define HOKUSAI_POCKET_TEMPLATE_CACHE
+
+#include "template_cache.h"
+#include <errno.h>
+#include <sys/stat.h>
+#include <uv.h>
+
+#if defined(_WIN32)
+  #include <direct.h>
+  #include <process.h>
+  #define hp_template_cache_mkdir(dir) _mkdir(dir)
+  #define hp_template_cache_pid() _getpid()
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <unistd.h>
+  #define hp_template_cache_mkdir(dir) mkdir(dir, 0755)
+  #define hp_template_cache_pid() getpid()
+#endif
+
+typedef struct HpTemplateCacheBlob
+{
+  uint64_t key;
+  uint8_t kind;
+  const char* data;
+  size_t size;
+} hp_template_cache_blob;
+
+/* a blob body found in the embedded pack or a cache file */
+typedef struct HpTemplateCacheView
+{
+  const char* body;
+  uint32_t body_bytes;
+  void* mapping;
+  size_t mapping_size;
+} hp_template_cache_view;
+
+static struct hashmap* embedded = NULL;
+// templates are parsed on worker threads too, the directory is shared and locked
+static uv_once_t cache_dir_once = UV_ONCE_INIT;
+static uv_mutex_t cache_dir_lock;
+static char* cache_dir = NULL;
+// counted per thread like the parser's own stats
+static _Thread_local hp_template_cache_stats stats = {0};
+// its address tells the temporary files of different threads apart
+static _Thread_local char hp_template_cache_thread;
+
+static int hp_template_cache_blob_compare(const void* a, const void* b, void* udata)
+{
+  const hp_template_cache_blob* blob_a = (hp_template_cache_blob*) a;
+  const hp_template_cache_blob* blob_b = (hp_template_cache_blob*) b;
+  if (blob_a->kind != blob_b->kind) return blob_a->kind - blob_b->kind;
+  if (blob_a->key == blob_b->key) return 0;
+
+  return blob_a->key < blob_b->key ? -1 : 1;
+}
+
+static uint64_t hp_template_cache_blob_hash(const void* item, uint64_t seed0, uint64_t seed1)
+{
+  const hp_template_cache_blob* blob = (hp_template_cache_blob*) item;
+  // keys are hashes already
+  return blob->key ^ blob->kind;
+}
+
+int hp_template_cache_embed(const unsigned char* pack, size_t size)
+{
+  if (embedded == NULL)
+  {
+    embedded = hashmap_new(sizeof(hp_template_cache_blob), 0, 0, 0, hp_template_cache_blob_hash, hp_template_cache_blob_compare, NULL, NULL);
+    if (embedded == NULL) return -1;
+  }
+
+  const char* at = (const char*) pack;
+  const char* end = at + size;
+  int count = 0;
+
+  while (at < end)
+  {
+    hoku_blob_header header;
+    if (hoku_blob_header_read(at, end - at, &header) == -1) return -1;
+
+    size_t blob_size = sizeof(hoku_blob_header) + header.body_bytes;
+    hp_template_cache_blob blob = { .key = header.key, .kind = header.kind, .data = at, .size = blob_size };
+    hashmap_set(embedded, &blob);
+    if (hashmap_oom(embedded)) return -1;
+
+    at += blob_size;
+    count++;
+  }
+
+  return count;
+}
+
+/* call with the lock held */
+static int hp_template_cache_use_dir(const char* dir)
+{
+  free(cache_dir);
+  cache_dir = NULL;
+
+  if (dir == NULL || dir[0] == '\0') return 0;
+
+  char* copy = strdup(dir);
+  if (copy == NULL) return -1;
+
+  if (hp_template_cache_mkdir(copy) != 0 && errno != EEXIST)
+  {
+    free(copy);
+    return -1;
+  }
+
+  cache_dir = copy;
+  return 0;
+}
+
+static void hp_template_cache_dir_init(void)
+{
+  uv_mutex_init(&cache_dir_lock);
+  hp_template_cache_use_dir(getenv(HP_TEMPLATE_CACHE_ENV));
+}
+
+int hp_template_cache_set_dir(const char* dir)
+{
+  uv_once(&cache_dir_once, hp_template_cache_dir_init);
+  uv_mutex_lock(&cache_dir_lock);
+  int status = hp_template_cache_use_dir(dir);
+  uv_mutex_unlock(&cache_dir_lock);
+
+  return status;
+}
+
+char* hp_template_cache_dir(void)
+{
+  uv_once(&cache_dir_once, hp_template_cache_dir_init);
+  uv_mutex_lock(&cache_dir_lock);
+  char* dir = cache_dir ? strdup(cache_dir) : NULL;
+  uv_mutex_unlock(&cache_dir_lock);
+
+  return dir;
+}
+
+static bool hp_template_cache_has_dir(void)
+{
+  uv_once(&cache_dir_once, hp_template_cache_dir_init);
+  uv_mutex_lock(&cache_dir_lock);
+  bool has = cache_dir != NULL;
+  uv_mutex_unlock(&cache_dir_lock);
+
+  return has;
+}
+
+/* false when the disk cache is off */
+static bool hp_template_cache_path(char* path, size_t size, enum HOKU_BLOB_KIND kind, uint64_t key)
+{
+  uv_once(&cache_dir_once, hp_template_cache_dir_init);
+  uv_mutex_lock(&cache_dir_lock);
+  bool has = cache_dir != NULL;
+  if (has) snprintf(path, size, "%s/%c-%016llx.hkt", cache_dir, kind == HOKU_BLOB_AST ? 'a' : 's', (unsigned long long) key);
+  uv_mutex_unlock(&cache_dir_lock);
+
+  return has;
+}
+
+static void hp_template_cache_release(hp_template_cache_view* view)
+{
+  if (view->mapping == NULL) return;
+
+#if defined(_WIN32)
+  free(view->mapping);
+#else
+  munmap(view->mapping, view->mapping_size);
+#endif
+  view->mapping = NULL;
+}
+
+/* maps the whole file, the tree is decoded out of it and it's released right after */
+static void* hp_template_cache_map(const char* path, size_t* size)
+{
+#if defined(_WIN32)
+  FILE* file = fopen(path, "rb");
+  if (file == NULL) return NULL;
+
+  char* data = NULL;
+  if (fseek(file, 0, SEEK_END) == 0)
+  {
+    long len = ftell(file);
+    if (len > 0 && fseek(file, 0, SEEK_SET) == 0 && (data = malloc(len)) != NULL)
+    {
+      if (fread(data, 1, len, file) != (size_t) len)
+      {
+        free(data);
+        data = NULL;
+      }
+      *size = (size_t) len;
+    }
+  }
+
+  fclose(file);
+  return data;
+#else
+  int fd = open(path, O_RDONLY);
+  if (fd == -1) return NULL;
+
+  struct stat info;
+  void* data = NULL;
+  if (fstat(fd, &info) == 0 && info.st_size > 0)
+  {
+    data = mmap(NULL, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) data = NULL;
+    *size = (size_t) info.st_size;
+  }
+
+  close(fd);
+  return data;
+#endif
+}
+
+static bool hp_template_cache_find(enum HOKU_BLOB_KIND kind, uint64_t key, uint32_t template_bytes, hp_template_cache_view* view)
+{
+  hoku_blob_header header;
+  view->mapping = NULL;
+
+  if (embedded != NULL)
+  {
+    const hp_template_cache_blob* blob = hashmap_get(embedded, &(hp_template_cache_blob){ .key = key, .kind = kind });
+    if (blob != NULL && (view->body = hoku_blob_check(blob->data, blob->size, kind, key, template_bytes, &header)) != NULL)
+    {
+      view->body_bytes = header.body_bytes;
+      stats.embedded_hits++;
+      return true;
+    }
+  }
+
+  char path[1024];
+  if (!hp_template_cache_path(path, sizeof(path), kind, key)) return false;
+
+  view->mapping = hp_template_cache_map(path, &view->mapping_size);
+  if (view->mapping == NULL) return false;
+
+  view->body = hoku_blob_check(view->mapping, view->mapping_size, kind, key, template_bytes, &header);
+  if (view->body == NULL)
+  {
+    hp_template_cache_release(view);
+    return false;
+  }
+
+  view->body_bytes = header.body_bytes;
+  stats.disk_hits++;
+  return true;
+}
+
+/* written to a temporary name first, so a concurrent run or thread never maps half a blob */
+static void hp_template_cache_store(enum HOKU_BLOB_KIND kind, uint64_t key, char* data, size_t size)
+{
+  char path[1024];
+  char temp[1064];
+  if (!hp_template_cache_path(path, sizeof(path), kind, key)) return;
+  snprintf(temp, sizeof(temp), "%s.%d.%llx.tmp", path, (int) hp_template_cache_pid(), (unsigned long long) (uintptr_t) &hp_template_cache_thread);
+
+  FILE* file = fopen(temp, "wb");
+  if (file == NULL) return;
+
+  bool written = fwrite(data, 1, size, file) == size;
+  if (fclose(file) != 0) written = false;
+
+#if defined(_WIN32)
+  // rename doesn't replace an existing file on windows
+  if (written) remove(path);
+#endif
+
+  if (written && rename(temp, path) == 0)
+  {
+    stats.writes++;
+    return;
+  }
+
+  remove(temp);
+}
+
+int hp_template_cache_ast(hoku_ast** out, char* type, char* template)
+{
+  size_t template_bytes = strlen(template);
+  if (template_bytes > UINT32_MAX) return hoku_ast_from_template(out, type, template);
+
+  uint64_t key = hoku_blob_key(type, template, template_bytes);
+  hp_template_cache_view view;
+  if (hp_template_cache_find(HOKU_BLOB_AST, key, (uint32_t) template_bytes, &view))
+  {
+    int status = hoku_blob_read_ast(view.body, view.body_bytes, out);
+    hp_template_cache_release(&view);
+    if (status == 0) return 0;
+  }
+
+  stats.misses++;
+  if (hoku_ast_from_template(out, type, template) != 0) return -1;
+
+  // errored trees raise, there's nothing to keep
+  if (!hp_template_cache_has_dir() || hoku_errored_ast(*out) != NULL) return 0;
+
+  char* data;
+  size_t size;
+  if (hoku_blob_write_ast(*out, key, (uint32_t) template_bytes, &data, &size) == 0)
+  {
+    hp_template_cache_store(HOKU_BLOB_AST, key, data, size);
+    free(data);
+  }
+
+  return 0;
+}
+
+int hp_template_cache_style(hoku_style** out, char* template)
+{
+  size_t template_bytes = strlen(template);
+  if (template_bytes > UINT32_MAX) return hoku_style_from_template(out, template);
+
+  uint64_t key = hoku_blob_key("style", template, template_bytes);
+  hp_template_cache_view view;
+  if (hp_template_cache_find(HOKU_BLOB_STYLE, key, (uint32_t) template_bytes, &view))
+  {
+    int status = hoku_blob_read_style(view.body, view.body_bytes, out);
+    hp_template_cache_release(&view);
+    if (status == 0) return 0;
+  }
+
+  stats.misses++;
+  if (hoku_style_from_template(out, template) != 0) return -1;
+  if (!hp_template_cache_has_dir() || *out == NULL) return 0;
+
+  char* data;
+  size_t size;
+  if (hoku_blob_write_style(*out, key, (uint32_t) template_bytes, &data, &size) == 0)
+  {
+    hp_template_cache_store(HOKU_BLOB_STYLE, key, data, size);
+    free(data);
+  }
+
+  return 0;
+}
+
+hp_template_cache_stats hp_template_cache_stats_get(void)
+{
+  return stats;
+}
+
+mrb_value hp_template_cache_get_dir(mrb_state* mrb, mrb_value self)
+{
+  char* dir = hp_template_cache_dir();
+  if (dir == NULL) return mrb_nil_value();
+
+  mrb_value rdir = mrb_str_new_cstr(mrb, dir);
+  free(dir);
+  return rdir;
+}
+
+mrb_value hp_template_cache_put_dir(mrb_state* mrb, mrb_value self)
+{
+  char* dir;
+  mrb_get_args(mrb, "z!", &dir);
+
+  if (hp_template_cache_set_dir(dir) == -1)
+  {
+    struct RClass* hokusai_class = mrb_module_get(mrb, "Hokusai");
+    struct RClass* exp = mrb_class_get_under(mrb, hokusai_class, "Error");
+    mrb_raisef(mrb, exp, "Cannot use template cache directory %s", dir);
+  }
+
+  return hp_template_cache_get_dir(mrb, self);
+}
+
+mrb_value hp_template_cache_get_stats(mrb_state* mrb, mrb_value self)
+{
+  mrb_value hash = mrb_hash_new(mrb);
+
+  mrb_hash_set(mrb, hash, mrb_symbol_value(mrb_intern_lit(mrb, "embedded_hits")), mrb_int_value(mrb, (mrb_int) stats.embedded_hits));
+  mrb_hash_set(mrb, hash, mrb_symbol_value(mrb_intern_lit(mrb, "disk_hits")), mrb_int_value(mrb, (mrb_int) stats.disk_hits));
+  mrb_hash_set(mrb, hash, mrb_symbol_value(mrb_intern_lit(mrb, "misses")), mrb_int_value(mrb, (mrb_int) stats.misses));
+  mrb_hash_set(mrb, hash, mrb_symbol_value(mrb_intern_lit(mrb, "writes")), mrb_int_value(mrb, (mrb_int) stats.writes));
+
+  return hash;
+}
+
+void mrb_define_hokusai_template_cache(mrb_state* mrb)
+{
+  struct RClass* module = mrb_module_get(mrb, "Hokusai");
+  struct RClass* ast_class = mrb_class_get_under(mrb, module, "Ast");
+
+  mrb_define_class_method(mrb, ast_class, "cache_dir", hp_template_cache_get_dir, MRB_ARGS_NONE());
+  mrb_define_class_method(mrb, ast_class, "cache_dir=", hp_template_cache_put_dir, MRB_ARGS_REQ(1));
+  mrb_define_class_method(mrb, ast_class, "cache_stats", hp_template_cache_get_stats, MRB_ARGS_NONE());
+}
+
+#endif
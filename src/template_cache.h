@@ -0,0 +1,70 @@
+#ifndef HOKUSAI_POCKET_TEMPLATE_CACHE_H
+#define HOKUSAI_POCKET_TEMPLATE_CACHE_H
+
+#include <mruby.h>
+#include <mruby/hash.h>
+#include <mruby/string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "core-blob.h"
+#include "core-hml.h"
+#include "hashmap.h"
+
+#define HP_TEMPLATE_CACHE_ENV "HOKUSAI_TEMPLATE_CACHE"
+
+/**
+  Parsed templates and styles, kept as core-blob encodings keyed by a hash of their source.
+
+  A template is looked up in the blobs embedded into the binary (see `build:template_cache=`),
+  then in the cache directory, and is only parsed when neither has it.
+  With a cache directory set, a fresh parse is written there for the next run.
+  The directory defaults to $HOKUSAI_TEMPLATE_CACHE and is unset otherwise.
+*/
+typedef struct HpTemplateCacheStats
+{
+  uint64_t embedded_hits;
+  uint64_t disk_hits;
+  uint64_t misses;
+  uint64_t writes;
+} hp_template_cache_stats;
+
+/**
+  Registers a pack of concatenated blobs, usually an array compiled into the binary.
+  The pack isn't copied and has to outlive the cache.
+  @return the number of blobs registered, or -1 if the pack is malformed
+*/
+int hp_template_cache_embed(const unsigned char* pack, size_t size);
+
+/**
+  Safe to call from any thread, the directory is shared by all of them.
+  @param dir where blobs are read and written, NULL turns the disk cache off
+  @return -1 if the directory can't be created, which also turns the disk cache off
+*/
+int hp_template_cache_set_dir(const char* dir);
+
+/**
+  @return a copy of the cache directory for the caller to free, or NULL when the disk cache is off
+*/
+char* hp_template_cache_dir(void);
+
+/**
+  Drop in replacements for hoku_ast_from_template and hoku_style_from_template
+*/
+int hp_template_cache_ast(hoku_ast** out, char* type, char* template);
+int hp_template_cache_style(hoku_style** out, char* template);
+
+/**
+  Counted per thread, like hoku_parse_stats
+*/
+hp_template_cache_stats hp_template_cache_stats_get(void);
+
+/**
+  defines Hokusai::Ast.cache_dir, Hokusai::Ast.cache_dir= and Hokusai::Ast.cache_stats
+  @param mrb the mrb vm
+*/
+void mrb_define_hokusai_template_cache(mrb_state* mrb);
+
+#endif
@@ -3,22 +3,86 @@
 
 #include "texture.h"
 
+static int hp_texture_mode_depth = 0;
+
+void hp_texture_mode_begin(RenderTexture2D target)
+{
+  BeginTextureMode(target);
+  hp_texture_mode_depth++;
+}
+
+void hp_texture_mode_end(void)
+{
+  EndTextureMode();
+  if (hp_texture_mode_depth > 0) hp_texture_mode_depth--;
+}
+
+bool hp_texture_mode_active(void)
+{
+  return hp_texture_mode_depth > 0;
+}
+
+static void hp_texture_unload(hp_texture_wrapper* wrapper)
+{
+  if (wrapper->task) hp_upload_queue_cancel(wrapper->task);
+  wrapper->task = NULL;
+  if (!wrapper->ready) return;
+
+  hp_render_pool* pool = hp_render_pool_get();
+  if (wrapper->pooled && pool) hp_render_pool_release(pool, wrapper->texture);
+  else UnloadRenderTexture(wrapper->texture);
+
+  wrapper->ready = false;
+  wrapper->generation++;
+}
+
 static void hp_texture_type_free(mrb_state* mrb, void* payload)
 {
-  hp_texture_wrapper* wrapper = (hp_texture_wrapper*) payload;
-  UnloadRenderTexture(wrapper->texture);
+  hp_texture_unload((hp_texture_wrapper*) payload);
   free(payload);
 }
 
 static struct mrb_data_type hp_texture_type = { "Texture", hp_texture_type_free };
 
-hp_texture_wrapper* hp_texture_get(mrb_state* mrb, mrb_value self)
+static void hp_texture_upload(void* data)
+{
+  hp_texture_wrapper* wrapper = (hp_texture_wrapper*) data;
+  hp_render_pool* pool = hp_render_pool_get();
+
+  wrapper->pooled = pool != NULL;
+  wrapper->texture = pool ? hp_render_pool_acquire(pool, wrapper->width, wrapper->height) : LoadRenderTexture(wrapper->width, wrapper->height);
+  wrapper->ready = true;
+  wrapper->generation++;
+  wrapper->task = NULL;
+}
+
+static void hp_texture_release(void* data)
+{
+  // the queue is gone, the wrapper is still owned by its ruby object
+  hp_texture_wrapper* wrapper = (hp_texture_wrapper*) data;
+  wrapper->task = NULL;
+}
+
+hp_texture_wrapper* hp_texture_peek(mrb_state* mrb, mrb_value self)
 {
   hp_texture_wrapper* wrapper = (hp_texture_wrapper*)DATA_PTR(self);
   if (!wrapper) {
     mrb_raise(mrb, E_ARGUMENT_ERROR , "uninitialized texture data") ;
   }
-  
+
+  return wrapper;
+}
+
+hp_texture_wrapper* hp_texture_get(mrb_state* mrb, mrb_value self)
+{
+  hp_texture_wrapper* wrapper = hp_texture_peek(mrb, self);
+
+  if (!wrapper->ready)
+  {
+    if (wrapper->task) hp_upload_queue_force(wrapper->task);
+    else hp_texture_upload(wrapper);
+  }
+
   return wrapper;
 }
 
@@ -30,34 +94,79 @@ mrb_value hp_texture_from_dimensions(mrb_state* mrb, mrb_value self)
   int width = mrb_int(mrb, rwidth);
   int height = mrb_int(mrb, rheight);
 
-  RenderTexture2D tex = LoadRenderTexture(width, height);  
   mrb_value obj = mrb_funcall(mrb, self, "new", 0, NULL);
 
   hp_texture_wrapper* wrapper = malloc(sizeof(hp_texture_wrapper));
-  *wrapper = (hp_texture_wrapper){tex};
+  *wrapper = (hp_texture_wrapper){ .width=width, .height=height, .ready=false, .pooled=false, .generation=0, .task=NULL };
   mrb_data_init(obj, wrapper, &hp_texture_type);
 
+  // allocated by the upload queue within its frame budget,
+  // or as soon as something draws to / from it.
+  // a pooled texture only needs a clear, so it doesn't count against the budget
+  hp_upload_queue* queue = hp_upload_queue_get();
+  hp_render_pool* pool = hp_render_pool_get();
+  size_t bytes = pool && hp_render_pool_has(pool, width, height) ? 0 : (size_t)width * height * 4;
+  if (queue) wrapper->task = hp_upload_queue_push(queue, hp_texture_upload, hp_texture_release, wrapper, bytes);
+  if (wrapper->task == NULL) hp_texture_upload(wrapper);
+
   return obj;
 }
 
 mrb_value hp_texture_width(mrb_state* mrb, mrb_value self)
 {
-  hp_texture_wrapper* wrap = hp_texture_get(mrb, self);
-  return mrb_int_value(mrb, wrap->texture.texture.width);
+  hp_texture_wrapper* wrap = hp_texture_peek(mrb, self);
+  return mrb_int_value(mrb, wrap->width);
 }
 
 mrb_value hp_texture_height(mrb_state* mrb, mrb_value self)
 {
-  hp_texture_wrapper* wrap = hp_texture_get(mrb, self);
-  return mrb_int_value(mrb, wrap->texture.texture.height);
+  hp_texture_wrapper* wrap = hp_texture_peek(mrb, self);
+  return mrb_int_value(mrb, wrap->height);
+}
+
+mrb_value hp_texture_generation(mrb_state* mrb, mrb_value self)
+{
+  hp_texture_wrapper* wrap = hp_texture_peek(mrb, self);
+  return mrb_int_value(mrb, (mrb_int) wrap->generation);
+}
+
+mrb_value hp_texture_is_ready(mrb_state* mrb, mrb_value self)
+{
+  hp_texture_wrapper* wrap = hp_texture_peek(mrb, self);
+  return mrb_bool_value(wrap->ready);
+}
+
+// hands the render texture back to the pool,
+// using the texture afterwards allocates a new one
+mrb_value hp_texture_release_mrb(mrb_state* mrb, mrb_value self)
+{
+  hp_texture_wrapper* wrap = hp_texture_peek(mrb, self);
+  hp_texture_unload(wrap);
+  return mrb_nil_value();
+}
+
+mrb_value hp_texture_pool_stats(mrb_state* mrb, mrb_value self)
+{
+  mrb_value stats = mrb_hash_new(mrb);
+  hp_render_pool* pool = hp_render_pool_get();
+  if (pool == NULL) return stats;
+
+  mrb_hash_set(mrb, stats, mrb_symbol_value(mrb_intern_lit(mrb, "live")), mrb_int_value(mrb, pool->live));
+  mrb_hash_set(mrb, stats, mrb_symbol_value(mrb_intern_lit(mrb, "pooled")), mrb_int_value(mrb, pool->pooled));
+  mrb_hash_set(mrb, stats, mrb_symbol_value(mrb_intern_lit(mrb, "pooled_bytes")), mrb_int_value(mrb, (mrb_int)pool->pooled_bytes));
+  mrb_hash_set(mrb, stats, mrb_symbol_value(mrb_intern_lit(mrb, "budget")), mrb_int_value(mrb, (mrb_int)pool->budget));
+  mrb_hash_set(mrb, stats, mrb_symbol_value(mrb_intern_lit(mrb, "reused")), mrb_int_value(mrb, (mrb_int)pool->reused));
+  mrb_hash_set(mrb, stats, mrb_symbol_value(mrb_intern_lit(mrb, "allocated")), mrb_int_value(mrb, (mrb_int)pool->allocated));
+  return stats;
 }
 
 mrb_value hp_texture_clear(mrb_state* mrb, mrb_value self)
 {
   hp_texture_wrapper* wrap = hp_texture_get(mrb, self);
-  BeginTextureMode(wrap->texture);
+  hp_texture_mode_begin(wrap->texture);
   ClearBackground((Color){0, 0, 0, 0});
-  EndTextureMode();
+  hp_texture_mode_end();
+  wrap->generation++;
   return mrb_nil_value();
 }
 
@@ -86,7 +195,7 @@ mrb_value hp_texture_apply(mrb_state* mrb, mrb_value self)
   mrb_value command_array;
   mrb_get_args(mrb, "o", &command_array);
   hp_texture_wrapper* wrap = hp_texture_get(mrb, self);
-  BeginTextureMode(wrap->texture);
+  hp_texture_mode_begin(wrap->texture);
 
   mrb_int len = RARRAY_LEN(command_array);
   mrb_value command;
@@ -97,7 +206,8 @@ mrb_value hp_texture_apply(mrb_state* mrb, mrb_value self)
     mrb_funcall(mrb, command, "draw", 0, NULL);
   }
 
-  EndTextureMode();
+  hp_texture_mode_end();
+  wrap->generation++;
   return mrb_nil_value();
 }
 
@@ -107,6 +217,7 @@ mrb_value hp_texture_update(mrb_state* mrb, mrb_value self)
     mrb_get_args(mrb, "S", &str);
     hp_texture_wrapper* wrap = hp_texture_get(mrb, self);
     UpdateTexture(wrap->texture.texture, RSTRING_PTR(str));
+    wrap->generation++;
     return mrb_nil_value();
 }
 
@@ -117,12 +228,16 @@ void mrb_define_hokusai_texture_class(mrb_state* mrb)
   MRB_SET_INSTANCE_TT(klass, MRB_TT_DATA);
 
   mrb_define_class_method(mrb, klass, "init", hp_texture_from_dimensions, MRB_ARGS_REQ(2));
+  mrb_define_class_method(mrb, klass, "pool_stats", hp_texture_pool_stats, MRB_ARGS_NONE());
   mrb_define_method(mrb, klass, "width", hp_texture_width, MRB_ARGS_NONE());
   mrb_define_method(mrb, klass, "height", hp_texture_height, MRB_ARGS_NONE());
+  mrb_define_method(mrb, klass, "ready?", hp_texture_is_ready, MRB_ARGS_NONE());
+  mrb_define_method(mrb, klass, "generation", hp_texture_generation, MRB_ARGS_NONE());
   mrb_define_method(mrb, klass, "apply", hp_texture_apply, MRB_ARGS_REQ(1));
   mrb_define_method(mrb, klass, "clear", hp_texture_clear, MRB_ARGS_NONE());
   mrb_define_method(mrb, klass, "dup", hp_texture_dup, MRB_ARGS_NONE());
   mrb_define_method(mrb, klass, "update", hp_texture_update, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, klass, "release", hp_texture_release_mrb, MRB_ARGS_NONE());
 }
 
 #endif
@@ -8,16 +8,51 @@
 #include <mruby/array.h>
 #include <mruby/variable.h>
 #include <mruby/string.h>
+#include <mruby/hash.h>
 #include <raylib.h>
 #include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "upload.h"
+#include "pool.h"
 
+/**
+  A render texture.
+  Allocation goes through the upload queue,
+  until then `ready` is false and `task` is the queued upload.
+  `pooled` textures go back to the render pool when released.
+  `generation` changes whenever the contents may have, so layers know their cache is stale.
+*/
 typedef struct HpTextureWrapper
 {
   RenderTexture2D texture;
+  int width;
+  int height;
+  bool ready;
+  bool pooled;
+  uint64_t generation;
+  hp_upload_task* task;
 } hp_texture_wrapper;
 
+/**
+  BeginTextureMode / EndTextureMode, counting how deep they nest.
+  raylib keeps no stack of targets, so work that switches targets itself (layer recording)
+  checks hp_texture_mode_active first.
+*/
+void hp_texture_mode_begin(RenderTexture2D target);
+void hp_texture_mode_end(void);
+bool hp_texture_mode_active(void);
+
+/**
+  Gets the texture, allocating it now if it is still queued.
+*/
 hp_texture_wrapper* hp_texture_get(mrb_state* mrb, mrb_value self);
 
+/**
+  Gets the texture as is, `ready` may be false.
+*/
+hp_texture_wrapper* hp_texture_peek(mrb_state* mrb, mrb_value self);
+
 void mrb_define_hokusai_texture_class(mrb_state* mrb);
 
 #endif
@@ -0,0 +1,128 @@
+#ifndef HOKUSAI_POCKET_UPLOAD
+#define HOKUSAI_POCKET_UPLOAD
+
+#include "upload.h"
+
+static hp_upload_queue* hp_upload_queue_current = NULL;
+
+int hp_upload_queue_init(double budget_ms, size_t budget_bytes)
+{
+  hp_upload_queue* init = malloc(sizeof(hp_upload_queue));
+  if (init == NULL) return -1;
+
+  init->head = NULL;
+  init->tail = NULL;
+  init->budget_ms = budget_ms > 0 ? budget_ms : HP_UPLOAD_DEFAULT_BUDGET_MS;
+  init->budget_bytes = budget_bytes > 0 ? budget_bytes : HP_UPLOAD_DEFAULT_BUDGET_BYTES;
+  init->len = 0;
+  init->last_uploads = 0;
+  init->last_bytes = 0;
+  init->last_ms = 0.0;
+  hp_upload_queue_current = init;
+
+  return 0;
+}
+
+hp_upload_queue* hp_upload_queue_get(void)
+{
+  return hp_upload_queue_current;
+}
+
+hp_upload_task* hp_upload_queue_push(hp_upload_queue* queue, hp_upload_fn upload, hp_upload_fn release, void* data, size_t bytes)
+{
+  hp_upload_task* task = malloc(sizeof(hp_upload_task));
+  if (task == NULL) return NULL;
+
+  task->upload = upload;
+  task->release = release;
+  task->data = data;
+  task->bytes = bytes;
+  task->next = NULL;
+
+  if (queue->tail) queue->tail->next = task;
+  else queue->head = task;
+  queue->tail = task;
+  queue->len++;
+
+  return task;
+}
+
+void hp_upload_queue_force(hp_upload_task* task)
+{
+  hp_upload_fn upload = task->upload;
+  void* data = task->data;
+  hp_upload_queue_cancel(task);
+
+  if (upload) upload(data);
+}
+
+void hp_upload_queue_cancel(hp_upload_task* task)
+{
+  // the queue still owns the task, it is unlinked on the next run
+  task->upload = NULL;
+  task->release = NULL;
+  task->data = NULL;
+  task->bytes = 0;
+}
+
+static hp_upload_task* hp_upload_queue_shift(hp_upload_queue* queue)
+{
+  hp_upload_task* task = queue->head;
+  queue->head = task->next;
+  if (queue->head == NULL) queue->tail = NULL;
+  queue->len--;
+
+  return task;
+}
+
+void hp_upload_queue_run(hp_upload_queue* queue)
+{
+  double start = monotonic_seconds();
+  size_t bytes = 0;
+  int uploads = 0;
+
+  while (queue->head)
+  {
+    hp_upload_task* task = queue->head;
+
+    if (task->upload && uploads > 0)
+    {
+      if (bytes + task->bytes > queue->budget_bytes) break;
+      if ((monotonic_seconds() - start) * 1000.0 >= queue->budget_ms) break;
+    }
+
+    hp_upload_queue_shift(queue);
+
+    if (task->upload)
+    {
+      task->upload(task->data);
+      bytes += task->bytes;
+      uploads++;
+    }
+
+    free(task);
+  }
+
+  queue->last_uploads = uploads;
+  queue->last_bytes = bytes;
+  queue->last_ms = (monotonic_seconds() - start) * 1000.0;
+}
+
+void hp_upload_queue_free(void)
+{
+  hp_upload_queue* queue = hp_upload_queue_current;
+  if (queue == NULL) return;
+
+  hp_upload_queue_current = NULL;
+
+  while (queue->head)
+  {
+    hp_upload_task* task = hp_upload_queue_shift(queue);
+    if (task->release) task->release(task->data);
+    free(task);
+  }
+
+  free(queue);
+}
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef HOKUSAI_POCKET_UPLOAD_H
+#define HOKUSAI_POCKET_UPLOAD_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include "monotonic_timer.h"
+
+#define HP_UPLOAD_DEFAULT_BUDGET_MS 4.0
+#define HP_UPLOAD_DEFAULT_BUDGET_BYTES (16 * 1024 * 1024)
+
+typedef void (*hp_upload_fn)(void* data);
+
+/**
+  A deferred GPU upload.
+  `upload` runs on the render thread when the queue gets to it,
+  `release` runs instead when the queue is freed first.
+  A cancelled task has both set to NULL and is skipped.
+*/
+typedef struct HpUploadTask
+{
+  hp_upload_fn upload;
+  hp_upload_fn release;
+  void* data;
+  size_t bytes;
+  struct HpUploadTask* next;
+} hp_upload_task;
+
+/**
+  Spreads texture and render texture uploads across frames.
+
+  Each frame the queue runs tasks in order until either
+  `budget_bytes` or `budget_ms` (measured with monotonic_seconds) is spent.
+  At least one task runs per frame so large uploads still make progress.
+*/
+typedef struct HpUploadQueue
+{
+  hp_upload_task* head;
+  hp_upload_task* tail;
+  double budget_ms;
+  size_t budget_bytes;
+  int len;
+  int last_uploads;
+  size_t last_bytes;
+  double last_ms;
+} hp_upload_queue;
+
+/**
+  Creates the render thread's queue.
+  Until then (and after hp_upload_queue_free) hp_upload_queue_get returns NULL,
+  and callers should upload synchronously.
+*/
+int hp_upload_queue_init(double budget_ms, size_t budget_bytes);
+hp_upload_queue* hp_upload_queue_get(void);
+
+/**
+  Queues an upload
+  @param queue the queue
+  @param upload runs the upload (render thread)
+  @param release frees `data` if the upload never runs (may be NULL)
+  @param data passed to upload/release
+  @param bytes the approximate size of the upload, counted against the budget
+  @return the task, valid until it runs or is cancelled, or NULL
+*/
+hp_upload_task* hp_upload_queue_push(hp_upload_queue* queue, hp_upload_fn upload, hp_upload_fn release, void* data, size_t bytes);
+
+/**
+  Runs a queued task now, for callers that can't wait for it.
+*/
+void hp_upload_queue_force(hp_upload_task* task);
+
+/**
+  Drops a queued task without running upload or release.
+*/
+void hp_upload_queue_cancel(hp_upload_task* task);
+
+/**
+  Runs queued uploads within the per frame budget.
+  Call once per frame from the render thread, before drawing.
+*/
+void hp_upload_queue_run(hp_upload_queue* queue);
+void hp_upload_queue_free(void);
+
+#endif
@@ -0,0 +1,165 @@
+#ifndef HOKUSAI_POCKET_WRAP
+#define HOKUSAI_POCKET_WRAP
+
+#include "wrap.h"
+
+static int hp_wrap_push(hp_wrap_result* out, hp_wrap_token token)
+{
+  if (out->len == out->cap)
+  {
+    int cap = out->cap == 0 ? 16 : out->cap * 2;
+    hp_wrap_token* tokens = realloc(out->tokens, sizeof(hp_wrap_token) * cap);
+    if (tokens == NULL) return -1;
+
+    out->tokens = tokens;
+    out->cap = cap;
+  }
+
+  out->tokens[out->len++] = token;
+  return 0;
+}
+
+// emits chars [first, last] as one line, split at the boundaries inside it
+static int hp_wrap_line(hp_wrap_result* out, const int* offsets, int first, int last, const int* boundaries, int boundary_len, int* boundary)
+{
+  float x = 0.0;
+
+  while (first <= last)
+  {
+    while (*boundary < boundary_len && boundaries[*boundary] <= first) (*boundary)++;
+
+    int end = last;
+    if (*boundary < boundary_len && boundaries[*boundary] <= last) end = boundaries[*boundary] - 1;
+
+    float w = 0.0;
+    for (int i=first; i<=end; i++) w += out->widths[i];
+
+    hp_wrap_token token = {
+      .start = first,
+      .length = end - first + 1,
+      .byte_start = offsets[first],
+      .byte_length = offsets[end + 1] - offsets[first],
+      .x = x,
+      .width = w,
+      .line = out->breaks
+    };
+    if (hp_wrap_push(out, token) == -1) return -1;
+
+    x += w;
+    first = end + 1;
+  }
+
+  return 0;
+}
+
+int hp_wrap(hp_font_wrapper* font, int size, const char* text, size_t bytes, float width, const int* boundaries, int boundary_len, hp_wrap_result* out)
+{
+  out->tokens = NULL;
+  out->len = 0;
+  out->cap = 0;
+  out->chars = 0;
+  out->breaks = 0;
+
+  // at most one char per byte
+  out->widths = malloc(sizeof(float) * (bytes + 1));
+  int* codepoints = malloc(sizeof(int) * (bytes + 1));
+  int* offsets = malloc(sizeof(int) * (bytes + 1));
+  if (out->widths == NULL || codepoints == NULL || offsets == NULL)
+  {
+    free(codepoints);
+    free(offsets);
+    hp_wrap_result_free(out);
+    return -1;
+  }
+
+  int n = 0;
+  for (size_t i=0; i<bytes;)
+  {
+    int step;
+    int codepoint = GetCodepointNext(text + i, &step);
+    if (step <= 0) step = 1;
+
+    float w = codepoint == '\n' ? 0.0 : hp_font_draw_width(font, codepoint, size);
+
+    codepoints[n] = codepoint;
+    offsets[n] = i;
+    out->widths[n] = w;
+    n++;
+    i += step;
+  }
+  offsets[n] = bytes;
+  out->chars = n;
+
+  int boundary = 0;
+  int line_start = 0;
+  int last_space = -1;
+  float current = 0.0;
+  int status = 0;
+
+  for (int i=0; i<n && status == 0; i++)
+  {
+    if (codepoints[i] == '\n')
+    {
+      status = hp_wrap_line(out, offsets, line_start, i, boundaries, boundary_len, &boundary);
+      out->breaks++;
+      line_start = i + 1;
+      last_space = -1;
+      current = 0.0;
+      continue;
+    }
+
+    float w = out->widths[i];
+
+    if (w + current >= width && i > line_start)
+    {
+      if (last_space >= line_start)
+      {
+        // keep the space on this line, carry the rest
+        status = hp_wrap_line(out, offsets, line_start, last_space, boundaries, boundary_len, &boundary);
+        line_start = last_space + 1;
+        current = 0.0;
+        for (int j=line_start; j<i; j++) current += out->widths[j];
+      }
+      else
+      {
+        status = hp_wrap_line(out, offsets, line_start, i - 1, boundaries, boundary_len, &boundary);
+        line_start = i;
+        current = 0.0;
+      }
+
+      last_space = -1;
+      out->breaks++;
+    }
+
+    current += w;
+    if (codepoints[i] == ' ') last_space = i;
+  }
+
+  if (status == 0 && line_start < n)
+  {
+    status = hp_wrap_line(out, offsets, line_start, n - 1, boundaries, boundary_len, &boundary);
+  }
+
+  free(codepoints);
+  free(offsets);
+
+  if (status == -1)
+  {
+    hp_wrap_result_free(out);
+    return -1;
+  }
+
+  return 0;
+}
+
+void hp_wrap_result_free(hp_wrap_result* result)
+{
+  free(result->tokens);
+  free(result->widths);
+  result->tokens = NULL;
+  result->widths = NULL;
+  result->len = 0;
+  result->cap = 0;
+}
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef HOKUSAI_POCKET_WRAP_H
+#define HOKUSAI_POCKET_WRAP_H
+
+#include <stdlib.h>
+#include <string.h>
+#include "font.h"
+
+/**
+  A run of characters on one wrapped line.
+  Offsets count characters (codepoints), x is relative to the line's start.
+*/
+typedef struct HpWrapToken
+{
+  int start;
+  int length;
+  int byte_start;
+  int byte_length;
+  float x;
+  float width;
+  int line;
+} hp_wrap_token;
+
+/**
+  Output of hp_wrap.
+  `widths` holds one entry per character (newlines are 0),
+  `breaks` is how many times the text moved down a line.
+*/
+typedef struct HpWrapResult
+{
+  hp_wrap_token* tokens;
+  int len;
+  int cap;
+  float* widths;
+  int chars;
+  int breaks;
+} hp_wrap_result;
+
+/**
+  Line breaking with the same rules as Hokusai::Util::WrapStream:
+
+  * a newline ends its line (and stays on it)
+  * when a character would reach `width`, the line breaks after its last space,
+    or before the character when the line has no space
+  * a line never starts empty, a character wider than `width` gets a line to itself
+
+  Widths come from the font's advance table.
+
+  @param boundaries sorted character offsets that start a new token
+    without breaking the line (eg. markdown style changes), may be NULL
+  @return 0 on success, -1 when out of memory
+*/
+int hp_wrap(hp_font_wrapper* font, int size, const char* text, size_t bytes, float width, const int* boundaries, int boundary_len, hp_wrap_result* out);
+void hp_wrap_result_free(hp_wrap_result* result);
+
+#endif
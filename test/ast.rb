@@ -30,6 +30,17 @@ class AstCommonTest < Hokusai::Test
 
     expect(funcs).to include(%w[one two three])
   end
+
+  test "#classes keeps template order" do
+    expect(ast.classes).to eql(%w[class1 class2])
+  end
+
+  test "a repeated prop name keeps the last value" do
+    ast = Hokusai::Ast.parse("[template]\n  first { size=\"small\" size=\"large\" }\n", "root").children.first
+
+    expect(ast.props.keys).to eql(["size"])
+    expect(ast.prop("size").value.method).to eql("large")
+  end
 end
 
 class AstPropTest < Hokusai::Test
@@ -87,4 +98,163 @@ class AstEventTest < Hokusai::Test
     expect(event.name).to eql("hover")
     expect(event.value.method).to eql("handle_hover")
   end
-end
\ No newline at end of file
+end
+class AstStatsTest < Hokusai::Test
+  # counts are only exact when nothing comes from the disk cache
+  def without_cache_dir
+    previous = Hokusai::Ast.cache_dir
+    Hokusai::Ast.cache_dir = nil
+    yield
+  ensure
+    Hokusai::Ast.cache_dir = previous
+  end
+
+  test ".stats counts every parse on this thread" do
+    without_cache_dir do
+      template = "[template]\n  first { prop=\"one\" }\n"
+      before = Hokusai::Ast.stats
+
+      3.times { Hokusai::Ast.parse(template, "root") }
+      after = Hokusai::Ast.stats
+
+      expect(after[:parses] - before[:parses]).to eql(3)
+      expect(after[:bytes] - before[:bytes]).to eql(template.bytesize * 3)
+    end
+  end
+
+  test "a template's tree is walked into a few arena chunks" do
+    without_cache_dir do
+      children = (1..200).map { |i| "  child#{i} { prop=\"value_#{i}\" @click=\"handle_#{i}\" }" }
+      template = "[template]\n#{children.join("\n")}\n"
+      before = Hokusai::Ast.stats
+
+      ast = Hokusai::Ast.parse(template, "root")
+      after = Hokusai::Ast.stats
+
+      expect(ast.children.size).to eql(200)
+      expect(ast.children.last.props["prop"].value.method).to eql("value_200")
+      expect(after[:arena_chunks] - before[:arena_chunks] <= 2).to eql(true)
+      expect(after[:arena_bytes] > before[:arena_bytes]).to eql(true)
+    end
+  end
+
+  test "a failed parse still parses the next template" do
+    begin
+      Hokusai::Ast.parse("[template]\n  first { prop=\n", "broken")
+    rescue Hokusai::Error
+    end
+
+    ast = Hokusai::Ast.parse("[template]\n  first\n", "root")
+    expect(ast.children.first.type).to eql("first")
+  end
+end
+
+class AstNativeTest < Hokusai::Test
+  let(:template) do
+    <<~EOF
+    [template]
+      list
+        [for="item in items"]
+          first { :content="item" }
+      wrap
+        [if="ready"]
+          second
+        [else]
+          third
+    EOF
+  end
+
+  test "parsed asts convert their fields once" do
+    ast = Hokusai::Ast.parse(template, "root")
+
+    expect(ast.native?).to be(true)
+    expect(ast.children.first.equal?(ast.children.first)).to be(true)
+
+    looped = ast.children.first.children.first
+    looped.loop.lastlen = 3
+    expect(looped.loop.lastlen).to eql(3)
+    expect(looped.loop.method).to eql("items")
+  end
+
+  test "else asts are wrapped from the same tree" do
+    cond = Hokusai::Ast.parse(template, "root").children.last.children.first
+
+    expect(cond.if.method).to eql("ready")
+    expect(cond.else_ast.type).to eql("third")
+    expect(cond.siblingindex).to eql(0)
+    expect(cond.else_active).to be(false)
+  end
+
+  test "a child keeps the tree alive after its root is collected" do
+    child = Hokusai::Ast.parse("[template]\n  first { prop=\"one\" }\n", "root").children.first
+    GC.start
+
+    expect(child.prop("prop").value.method).to eql("one")
+  end
+
+  test "built asts are not native" do
+    expect(Hokusai::Ast.new.native?).to be(false)
+    expect(Hokusai::Ast.new.id).to be(nil)
+  end
+end
+
+class AstCacheTest < Hokusai::Test
+  test "a template is parsed once and read back from the cache directory" do
+    previous = Hokusai::Ast.cache_dir
+    # a template no earlier run has cached
+    template = "[template]\n  first { prop=\"#{Hokusai.monotonic}\" }\n  second\n"
+    # a directory of its own, removed afterwards
+    dir = "/tmp/hokusai-template-cache-#{Hokusai.monotonic}"
+
+    begin
+      Hokusai::Ast.cache_dir = dir
+      before = Hokusai::Ast.stats
+      cache_before = Hokusai::Ast.cache_stats
+
+      first = Hokusai::Ast.parse(template, "root")
+      second = Hokusai::Ast.parse(template, "root")
+      after = Hokusai::Ast.stats
+      cache_after = Hokusai::Ast.cache_stats
+
+      expect(after[:parses] - before[:parses]).to eql(1)
+      expect(cache_after[:writes] - cache_before[:writes]).to eql(1)
+      expect(cache_after[:disk_hits] - cache_before[:disk_hits]).to eql(1)
+      expect(second.children.map(&:type)).to eql(first.children.map(&:type))
+      expect(second.children.first.prop("prop").value.method).to eql(first.children.first.prop("prop").value.method)
+    ensure
+      Hokusai::Ast.cache_dir = previous
+      Dir.glob("#{dir}/*").each { |file| File.delete(file) }
+      Dir.delete(dir) if Dir.exist?(dir)
+    end
+  end
+end
+
+class AstRetainTest < Hokusai::Test
+  test "retained templates are shared until they change, then parsed incrementally" do
+    template = "[template]\n  first { prop=\"one\" }\n"
+    edited = "[template]\n  second\n  first { prop=\"two\" }\n"
+    previous = Hokusai::Ast.cache_dir
+
+    begin
+      # counts are only exact when nothing comes from the disk cache
+      Hokusai::Ast.cache_dir = nil
+      Hokusai::Ast.retain = true
+      before = Hokusai::Ast.stats
+
+      Hokusai::Ast.parse(template, "retained")
+      again = Hokusai::Ast.parse(template, "retained")
+      changed = Hokusai::Ast.parse(edited, "retained")
+      after = Hokusai::Ast.stats
+
+      expect(after[:parses] - before[:parses]).to eql(2)
+      expect(after[:shared] - before[:shared]).to eql(1)
+      expect(after[:incremental] - before[:incremental]).to eql(1)
+      expect(again.children.first.prop("prop").value.method).to eql("one")
+      expect(changed.children.map(&:type)).to eql(["second", "first"])
+      expect(changed.children.last.prop("prop").value.method).to eql("two")
+    ensure
+      Hokusai::Ast.retain = false
+      Hokusai::Ast.cache_dir = previous
+    end
+  end
+end
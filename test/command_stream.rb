@@ -0,0 +1,138 @@
+class CommandStreamTest < Hokusai::Test
+  # every glyph is 10 wide, lines start back at x like the backend's font
+  class RunFont
+    def pack_glyphs(buffer, text, x, y, size)
+      buffer << text
+      text.split("\n").map { |line| x + line.size * 10.0 }.max || x
+    end
+
+    def measure(text, size)
+      [text.size * 10.0, size.to_f]
+    end
+  end
+
+  FONT = RunFont.new
+
+  def rect(x, y, w, h)
+    Hokusai::Commands::Rectangle.new(x, y, w, h)
+  end
+
+  def text(content, x, y)
+    command = Hokusai::Commands::Text.new(content, x, y)
+    command.font = FONT
+    command
+  end
+
+  test "drops empty state regions" do
+    commands = [
+      Hokusai::Commands::ScissorBegin.new(0, 0, 10, 10),
+      Hokusai::Commands::ScissorEnd.new,
+      rect(0, 0, 10, 10)
+    ]
+
+    expect(Hokusai::CommandStream.optimize(commands).map(&:class)).to eql([Hokusai::Commands::Rectangle])
+  end
+
+  test "merges adjacent identical scissors" do
+    first = rect(0, 0, 10, 10)
+    second = rect(0, 20, 10, 10)
+    commands = [
+      Hokusai::Commands::ScissorBegin.new(0, 0, 100, 100),
+      first,
+      Hokusai::Commands::ScissorEnd.new,
+      Hokusai::Commands::ScissorBegin.new(0, 0, 100, 100),
+      second,
+      Hokusai::Commands::ScissorEnd.new
+    ]
+
+    optimized = Hokusai::CommandStream.optimize(commands)
+    expect(optimized.map(&:class)).to eql([
+      Hokusai::Commands::ScissorBegin,
+      Hokusai::Commands::Rectangle,
+      Hokusai::Commands::Rectangle,
+      Hokusai::Commands::ScissorEnd
+    ])
+  end
+
+  test "keeps different scissors apart" do
+    commands = [
+      Hokusai::Commands::ScissorBegin.new(0, 0, 100, 100),
+      rect(0, 0, 10, 10),
+      Hokusai::Commands::ScissorEnd.new,
+      Hokusai::Commands::ScissorBegin.new(0, 100, 100, 100),
+      rect(0, 100, 10, 10),
+      Hokusai::Commands::ScissorEnd.new
+    ]
+
+    expect(Hokusai::CommandStream.optimize(commands).size).to eql(6)
+  end
+
+  test "groups non overlapping draws by texture" do
+    button_one = rect(0, 0, 100, 20)
+    label_one = text("one", 5, 2)
+    button_two = rect(0, 40, 100, 20)
+    label_two = text("two", 5, 42)
+
+    optimized = Hokusai::CommandStream.optimize([button_one, label_one, button_two, label_two])
+    expect(optimized).to eql([button_one, button_two, label_one, label_two])
+  end
+
+  test "keeps painter's order for overlapping draws" do
+    background = rect(0, 0, 100, 100)
+    label = text("over", 5, 5)
+    cover = rect(0, 0, 50, 50)
+
+    optimized = Hokusai::CommandStream.optimize([background, label, cover])
+    expect(optimized).to eql([background, label, cover])
+  end
+
+  test "can_render follows the scissor queued during the painter's walk" do
+    inside = Hokusai::Canvas.new(10, 10, 0, 20)
+    below = Hokusai::Canvas.new(10, 10, 0, 200)
+
+    begin
+      Hokusai.walking(true)
+      Hokusai.track_scissor([Hokusai::Commands::ScissorBegin.new(0, 0, 100, 100), rect(0, 0, 10, 10)])
+      expect(Hokusai.can_render(inside)).to be(true)
+      expect(Hokusai.can_render(below)).to be(false)
+
+      Hokusai.track_scissor([Hokusai::Commands::ScissorEnd.new])
+      expect(Hokusai.can_render(below)).to be(true)
+    ensure
+      Hokusai.walking(false)
+    end
+  end
+
+  test "glyph runs cover every line they place" do
+    run = Hokusai::Commands::GlyphRun.new(RunFont.new, 10)
+    run.add("", 500, 500)
+    run.add("hello", 5, 20)
+    run.add("hi", 0, 40)
+
+    expect([run.x, run.y, run.width, run.height]).to eql([0.0, 20.0, 55.0, 40.0])
+    expect(run.empty?).to eql(false)
+  end
+
+  test "glyph runs of newline terminated tokens keep their width" do
+    run = Hokusai::Commands::GlyphRun.new(RunFont.new, 10)
+    run.add("hello\n", 0, 0)
+    run.add("hi\n", 0, 20)
+
+    expect(run.width).to eql(50.0)
+  end
+
+  test "glyph runs batch with text in the same font" do
+    font = RunFont.new
+    top = Hokusai::Commands::GlyphRun.new(font, 10)
+    top.add("one", 5, 2)
+    bottom = Hokusai::Commands::GlyphRun.new(font, 10)
+    bottom.add("two", 5, 42)
+    label = text("three", 5, 82)
+    label.font = font
+    button_one = rect(0, 0, 100, 20)
+    button_two = rect(0, 40, 100, 20)
+
+    optimized = Hokusai::CommandStream.optimize([button_one, top, button_two, bottom, label])
+    expect(optimized).to eql([button_one, button_two, top, bottom, label])
+  end
+end
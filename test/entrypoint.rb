@@ -55,5 +55,9 @@ require_relative "./publisher"
 require_relative "./block"
 require_relative "./slots"
 require_relative "./util/piece_table"
+require_relative "./util/wrap_cache"
+require_relative "./json"
+require_relative "./command_stream"
+require_relative "./shaders"
 
 Hokusai::Hypothesis.run!
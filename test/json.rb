@@ -0,0 +1,53 @@
+class JSONTest < Hokusai::Test
+  test ".parse builds ruby values" do
+    value = Hokusai::JSON.parse('{"a": [1, 2.5, -3, true, false, null], "b": {"c": "d"}}')
+
+    expect(value["a"]).to eql([1, 2.5, -3, true, false, nil])
+    expect(value["b"]["c"]).to eql("d")
+  end
+
+  test ".parse decodes escapes and unicode" do
+    value = Hokusai::JSON.parse('"line\nquote\" é 😀"')
+
+    expect(value).to eql("line\nquote\" é \u{1F600}")
+  end
+
+  test ".parse promotes large integers to floats" do
+    expect(Hokusai::JSON.parse("9223372036854775807").class).to eql(Integer)
+    expect(Hokusai::JSON.parse("92233720368547758070").class).to eql(Float)
+  end
+
+  test ".parse raises with the offset on invalid json" do
+    raised = false
+    begin
+      Hokusai::JSON.parse('{"a" 1}')
+    rescue Hokusai::Error => ex
+      raised = true
+      expect(ex.message).to match(/JSON parse error at offset 5/)
+    end
+    expect(raised).to be(true)
+  end
+
+  test ".parse rejects lone surrogates" do
+    ['"\\ud83d"', '"\\udc00"', '"a\\udc00b"'].each do |source|
+      raised = false
+      begin
+        Hokusai::JSON.parse(source)
+      rescue Hokusai::Error => ex
+        raised = true
+        expect(ex.message).to match(/invalid surrogate pair/)
+      end
+      expect(raised).to be(true)
+    end
+  end
+
+  test ".generate round trips" do
+    source = '{"a":[1,2.5,-3,true,false,null],"b":{"c":"d\n\"e"}}'
+
+    expect(Hokusai::JSON.generate(Hokusai::JSON.parse(source))).to eql(source)
+  end
+
+  test ".generate converts symbol keys and values to strings" do
+    expect(Hokusai::JSON.generate({ key: :value, other: 1.0 })).to eql('{"key":"value","other":1.0}')
+  end
+end
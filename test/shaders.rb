@@ -0,0 +1,48 @@
+class ShaderRegistryTest < Hokusai::Test
+  let(:child_klass) do
+    Class.new(Hokusai::Block) do
+      template <<~EOF
+        [template]
+          virtual
+      EOF
+
+      shader fragment: "child fragment"
+    end
+  end
+
+  let(:parent_klass) do
+    child_block = child_klass
+
+    Class.new(Hokusai::Block) do
+      template <<~EOF
+        [template]
+          child
+          other
+      EOF
+
+      uses(child: child_block, other: child_block)
+
+      shader vertex: "parent vertex", fragment: "parent fragment"
+    end
+  end
+
+  test "warm compiles the shaders of a block and the blocks it uses" do
+    registry = Hokusai::ShaderRegistry.new
+    registry.warm(parent_klass)
+
+    expect(registry.compiled?("parent vertex", "parent fragment")).to be(true)
+    expect(registry.compiled?(nil, "child fragment")).to be(true)
+    expect(registry.compiled?(nil, "other fragment")).to be(false)
+  end
+
+  test "blocks without shaders declare none" do
+    expect(Class.new(Hokusai::Block).shaders).to eql([])
+  end
+
+  test "declaring the same shader again keeps one entry" do
+    klass = Class.new(Hokusai::Block)
+    2.times { klass.shader fragment: "reloaded fragment" }
+
+    expect(klass.shaders).to eql([[nil, "reloaded fragment"]])
+  end
+end
@@ -93,4 +93,32 @@ class PieceTableTest < Hokusai::Test
       end
     end
   end
-end
\ No newline at end of file
+
+  test "#slice reads across pieces" do
+    with_piece_table("hello world") do |table|
+      table.insert("big ", 6)
+      expect(table.slice(4, 6)).to eql("o big ")
+      expect(table.size).to eql(15)
+    end
+  end
+
+  test "typing at the end of an insert grows one piece" do
+    with_piece_table("hello world") do |table|
+      "there ".each_char.with_index { |char, i| table.insert(char, 6 + i) }
+      expect(table.to_s).to eql("hello there world")
+      expect(table.pieces.size).to eql(3)
+    end
+  end
+
+  test "line lookups" do
+    with_piece_table("one\ntwo\nthree") do |table|
+      table.insert("\nfour", 11)
+      expect(table.line_count).to eql(4)
+      expect(table.line_at(5)).to eql(1)
+      expect(table.line_offset(2)).to eql(8)
+      expect(table.line(2)).to eql("thr")
+      expect(table.line(3)).to eql("fouree")
+      expect(table.line(4)).to eql(nil)
+    end
+  end
+end
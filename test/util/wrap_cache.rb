@@ -0,0 +1,63 @@
+class WrapCacheTest < Hokusai::Test
+  # breaks on newlines only, every character is 10 wide
+  class LineFont
+    def wrap(text, size, width, boundaries)
+      packed = []
+      widths = []
+      start = 0
+      line = 0
+
+      text.size.times do |i|
+        widths << (text[i] == "\n" ? 0.0 : 10.0)
+
+        if text[i] == "\n" || i == text.size - 1
+          length = i - start + 1
+          packed.push(text[start, length], start, length, 0.0, widths[start, length].sum, line)
+          start = i + 1
+          line += 1 if text[i] == "\n"
+        end
+      end
+
+      [packed, widths, line]
+    end
+  end
+
+  def summary(cache)
+    cache.tokens.map { |token| [token.text, token.y, token.positions.first] }
+  end
+
+  def rewrapped(before, after)
+    font = LineFont.new
+    cache, _ = Hokusai::Util::WrapCache.wrap(font, before, 10, 100.0, 0.0, 5.0)
+    y = cache.rewrap(font, before, after, 10, 100.0)
+    fresh, fresh_y = Hokusai::Util::WrapCache.wrap(font, after, 10, 100.0, 0.0, 5.0)
+
+    expect(summary(cache)).to eql(summary(fresh))
+    expect(y).to eql(fresh_y)
+    cache
+  end
+
+  test "appending a line reuses every line before it" do
+    before = "one\ntwo\n"
+    font = LineFont.new
+    cache, _ = Hokusai::Util::WrapCache.wrap(font, before, 10, 100.0)
+    first = cache.tokens.first
+
+    cache.rewrap(font, before, "one\ntwo\nthree", 10, 100.0)
+
+    expect(cache.tokens.first.equal?(first)).to be(true)
+    expect(summary(cache).last).to eql(["three", 20.0, 8])
+  end
+
+  test "an edit in the middle moves the lines after it" do
+    rewrapped("one\ntwo\nthree", "one\ntwo\nnew\nthree")
+    rewrapped("one\ntwo\nthree", "one\nthree")
+    rewrapped("one\ntwo\nthree", "one\ntwoo\nthree")
+  end
+
+  test "joining and splitting paragraphs" do
+    rewrapped("one\ntwo\nthree", "onetwo\nthree")
+    rewrapped("one two three", "one\ntwo\nthree")
+    rewrapped("", "hello")
+  end
+end